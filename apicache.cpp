@@ -0,0 +1,88 @@
+#include "apicache.h"
+#include <QDateTime>          ///< Biblioteka do obsługi dat i czasu.
+#include <QUrl>               ///< Biblioteka do obsługi adresów URL.
+
+/**
+ * @file apicache.cpp
+ * @brief Implementacja klasy ApiCache, dyskowej pamięci podręcznej HTTP dla API GIOŚ.
+ */
+
+/**
+ * @brief Konstruktor klasy ApiCache.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+ApiCache::ApiCache(QObject *parent)
+    : QNetworkDiskCache(parent)
+{
+}
+
+/**
+ * @brief Dodaje regułę świeżości dla ścieżki.
+ * @param pathPrefix Fragment ścieżki endpointu, np. "station/findAll".
+ * @param seconds Czas świeżości odpowiedzi (sekundy).
+ */
+void ApiCache::setFreshness(const QString& pathPrefix, qint64 seconds)
+{
+    freshnessRules.append(qMakePair(pathPrefix, seconds));
+}
+
+/**
+ * @brief Zapisuje odpowiedź z datą ważności z reguł endpointu.
+ * @param metaData Metadane odpowiedzi.
+ * @return Urządzenie do zapisu treści lub nullptr, jeśli odpowiedź nie jest zapisywana.
+ */
+QIODevice* ApiCache::prepare(const QNetworkCacheMetaData& metaData)
+{
+    return QNetworkDiskCache::prepare(applyPolicy(metaData));
+}
+
+/**
+ * @brief Odnawia metadane wpisu (np. po odpowiedzi 304 Not Modified).
+ * @param metaData Nowe metadane.
+ */
+void ApiCache::updateMetaData(const QNetworkCacheMetaData& metaData)
+{
+    QNetworkDiskCache::updateMetaData(applyPolicy(metaData));
+}
+
+/**
+ * @brief Ustawia datę ważności z reguły endpointu i usuwa nagłówki sterujące cache serwera.
+ * ETag i Last-Modified zostają, więc po wygaśnięciu wpisu możliwe jest żądanie warunkowe.
+ * @param metaData Metadane odpowiedzi.
+ * @return Metadane z zastosowaną regułą (bez zmian, jeśli żadna reguła nie pasuje).
+ */
+QNetworkCacheMetaData ApiCache::applyPolicy(const QNetworkCacheMetaData& metaData) const
+{
+    const qint64 seconds = freshnessFor(metaData.url());
+    if (seconds < 0) {
+        return metaData;
+    }
+    QNetworkCacheMetaData result = metaData;
+    QNetworkCacheMetaData::RawHeaderList headers;
+    for (const QNetworkCacheMetaData::RawHeader& header : metaData.rawHeaders()) {
+        const QByteArray name = header.first.toLower();
+        if (name != "cache-control" && name != "expires" && name != "pragma" && name != "age") {
+            headers.append(header);
+        }
+    }
+    result.setRawHeaders(headers);
+    result.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(seconds));
+    result.setSaveToDisk(true);
+    return result;
+}
+
+/**
+ * @brief Zwraca czas świeżości dla adresu.
+ * @param url Adres żądania.
+ * @return Sekundy z pierwszej pasującej reguły lub -1.
+ */
+qint64 ApiCache::freshnessFor(const QUrl& url) const
+{
+    const QString path = url.path();
+    for (const QPair<QString, qint64>& rule : freshnessRules) {
+        if (path.contains(rule.first)) {
+            return rule.second;
+        }
+    }
+    return -1;
+}
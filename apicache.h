@@ -0,0 +1,48 @@
+#ifndef APICACHE_H
+#define APICACHE_H
+
+/**
+ * @file apicache.h
+ * @brief Plik nagłówkowy dla klasy ApiCache, dyskowej pamięci podręcznej HTTP dla API GIOŚ.
+ */
+
+#include <QNetworkDiskCache>
+#include <QVector>             ///< Do listy reguł świeżości.
+#include <QPair>               ///< Do par (prefiks ścieżki, czas świeżości).
+
+/**
+ * @class ApiCache
+ * @brief Trwała pamięć podręczna HTTP z czasem świeżości zależnym od endpointu.
+ *
+ * Nagłówki Cache-Control/Expires/Pragma z serwera są zastępowane datą ważności z reguły pasującej
+ * do ścieżki (np. dni dla listy stacji, minuty dla pomiarów). Świeży wpis jest zwracany bez ruchu
+ * sieciowego; po jego wygaśnięciu Qt wysyła żądanie warunkowe (If-None-Match / If-Modified-Since)
+ * z zapamiętanym ETag lub Last-Modified, a odpowiedź 304 odnawia wpis bez pobierania treści.
+ */
+class ApiCache : public QNetworkDiskCache
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Konstruktor, tworzy pustą pamięć podręczną (katalog ustawia setCacheDirectory()).
+    explicit ApiCache(QObject *parent = nullptr);
+
+    /// Dodaje regułę: odpowiedzi ze ścieżką zawierającą pathPrefix są świeże przez seconds sekund.
+    void setFreshness(const QString& pathPrefix, qint64 seconds);
+
+    /// Zapisuje odpowiedź z datą ważności wg reguł endpointu.
+    QIODevice* prepare(const QNetworkCacheMetaData& metaData) override;
+    /// Odnawia metadane (np. po odpowiedzi 304) z datą ważności wg reguł endpointu.
+    void updateMetaData(const QNetworkCacheMetaData& metaData) override;
+
+private:
+    /// Zwraca metadane z datą ważności z reguł i bez nagłówków sterujących cache serwera.
+    QNetworkCacheMetaData applyPolicy(const QNetworkCacheMetaData& metaData) const;
+    /// Zwraca czas świeżości dla adresu (sekundy) lub -1, jeśli brak reguły.
+    qint64 freshnessFor(const QUrl& url) const;
+
+    /// Reguły świeżości (prefiks ścieżki, sekundy).
+    QVector<QPair<QString, qint64>> freshnessRules;
+};
+
+#endif // APICACHE_H
@@ -0,0 +1,258 @@
+#include "apidispatcher.h"
+#include <QDebug>             ///< Biblioteka do logowania komunikatów debugowania.
+
+/**
+ * @file apidispatcher.cpp
+ * @brief Implementacja klasy ApiDispatcher, wspólnego punktu wysyłania żądań do API GIOŚ.
+ */
+
+/**
+ * @brief Konstruktor klasy ApiDispatcher.
+ * @param baseUrl Bazowy adres API.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+ApiDispatcher::ApiDispatcher(const QString& baseUrl, QObject *parent)
+    : QObject(parent), manager(new QNetworkAccessManager(this)), baseUrl(baseUrl), lastSerial(0)
+{
+}
+
+/**
+ * @brief Włącza trwałą pamięć podręczną HTTP.
+ * @param directory Katalog pamięci podręcznej.
+ * @param maxBytes Maksymalny rozmiar na dysku.
+ */
+void ApiDispatcher::enableDiskCache(const QString& directory, qint64 maxBytes)
+{
+    ApiCache* cache = new ApiCache(manager);
+    cache->setCacheDirectory(directory);
+    cache->setMaximumCacheSize(maxBytes);
+    cache->setFreshness(API_STATIONS_ENDPOINT, STATIONS_FRESHNESS_SECONDS);
+    cache->setFreshness(API_SENSORS_ENDPOINT, SENSORS_FRESHNESS_SECONDS);
+    cache->setFreshness(API_MEASUREMENTS_ENDPOINT, MEASUREMENTS_FRESHNESS_SECONDS);
+    cache->setFreshness(API_AIR_QUALITY_ENDPOINT, AIR_QUALITY_FRESHNESS_SECONDS);
+    manager->setCache(cache);
+    qDebug() << "Pamięć podręczna HTTP:" << directory;
+}
+
+/**
+ * @brief Wysyła żądanie lub dołącza do identycznego żądania w toku.
+ * @param endpoint Endpoint API.
+ * @param id ID stacji lub czujnika.
+ * @param receiver Odbiorca; odpowiedź nie jest dostarczana, jeśli został usunięty.
+ * @param callback Funkcja zwrotna wywoływana z odpowiedzią.
+ * @param supersede Czy anulować pozostałe żądania tego endpointu.
+ * @param onChunk Funkcja zwrotna dla kolejnych fragmentów treści (opcjonalna).
+ * @return Numer kolejny żądania.
+ */
+quint64 ApiDispatcher::get(ApiEndpoint endpoint, int id, QObject* receiver, const Callback& callback, bool supersede,
+                           const ChunkCallback& onChunk)
+{
+    if (supersede) {
+        cancel(endpoint, id);
+    }
+    Waiter waiter;
+    waiter.request.endpoint = endpoint;
+    waiter.request.id = id;
+    waiter.request.serial = ++lastSerial;
+    waiter.receiver = receiver;
+    waiter.callback = callback;
+    waiter.onChunk = onChunk;
+
+    const quint64 callKey = key(endpoint, id);
+    auto it = calls.find(callKey);
+    if (it != calls.end()) {
+        /// Odebranych bajtów strumienia nie ma już w pamięci, więc taki oczekujący czeka na ponowienie.
+        if (it->streamed && it->received > 0) {
+            qDebug() << "Żądanie zostanie ponowione po zakończeniu strumienia:" << url(endpoint, id).toString();
+            it->deferred.append(waiter);
+            return waiter.request.serial;
+        }
+        qDebug() << "Dołączono do żądania w toku:" << url(endpoint, id).toString();
+        it->streamed = it->streamed && onChunk;
+        it->waiters.append(waiter);
+        return waiter.request.serial;
+    }
+
+    /// Świeży wpis pamięci podręcznej nie wymaga sieci; wygasły jest odnawiany żądaniem warunkowym.
+    QNetworkRequest request(url(endpoint, id));
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
+    Call call;
+    call.reply = manager->get(request);
+    call.streamed = bool(onChunk);
+    call.waiters.append(waiter);
+    QNetworkReply* reply = call.reply;
+    calls.insert(callKey, call);
+    connect(reply, &QNetworkReply::readyRead, this, [this, callKey, reply]() {
+        onReadyRead(callKey, reply);
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, callKey, reply]() {
+        onFinished(callKey, reply);
+    });
+    return waiter.request.serial;
+}
+
+/**
+ * @brief Anuluje żądania endpointu (oczekujący nie dostaną odpowiedzi).
+ * @param endpoint Endpoint API.
+ * @param exceptId ID żądania, które ma zostać zachowane (-1, jeśli żadne).
+ */
+void ApiDispatcher::cancel(ApiEndpoint endpoint, int exceptId)
+{
+    for (auto it = calls.begin(); it != calls.end();) {
+        const ApiEndpoint callEndpoint = ApiEndpoint(it.key() >> 32);
+        const int callId = int(quint32(it.key()));
+        if (callEndpoint != endpoint || callId == exceptId) {
+            ++it;
+            continue;
+        }
+        QNetworkReply* reply = it->reply;
+        qDebug() << "Anulowano nieaktualne żądanie:" << reply->url().toString();
+        it = calls.erase(it);
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+}
+
+/**
+ * @brief Informuje, czy żądanie jest w toku.
+ * @param endpoint Endpoint API.
+ * @param id ID stacji lub czujnika.
+ * @return True, jeśli połączenie jest otwarte.
+ */
+bool ApiDispatcher::isInFlight(ApiEndpoint endpoint, int id) const
+{
+    return calls.contains(key(endpoint, id));
+}
+
+/**
+ * @brief Buduje adres URL żądania.
+ * @param endpoint Endpoint API.
+ * @param id ID stacji lub czujnika.
+ * @return Pełny adres URL.
+ */
+QUrl ApiDispatcher::url(ApiEndpoint endpoint, int id) const
+{
+    switch (endpoint) {
+    case ApiEndpoint::Stations:
+        return QUrl(baseUrl + API_STATIONS_ENDPOINT);
+    case ApiEndpoint::Sensors:
+        return QUrl(baseUrl + API_SENSORS_ENDPOINT + QString::number(id));
+    case ApiEndpoint::Measurements:
+        return QUrl(baseUrl + API_MEASUREMENTS_ENDPOINT + QString::number(id));
+    case ApiEndpoint::AirQualityIndex:
+        return QUrl(baseUrl + API_AIR_QUALITY_ENDPOINT + QString::number(id));
+    }
+    return QUrl();
+}
+
+/**
+ * @brief Zwraca klucz żądania (endpoint w starszych 32 bitach, ID w młodszych).
+ */
+quint64 ApiDispatcher::key(ApiEndpoint endpoint, int id)
+{
+    return (quint64(endpoint) << 32) | quint32(id);
+}
+
+/**
+ * @brief Przekazuje odebrane bajty dalej; bez strumieniowania dopisuje je też do treści żądania.
+ * @param callKey Klucz żądania.
+ * @param reply Odpowiedź, która ma nowe dane.
+ */
+void ApiDispatcher::onReadyRead(quint64 callKey, QNetworkReply* reply)
+{
+    auto it = calls.find(callKey);
+    if (it == calls.end() || it->reply != reply) {
+        return;
+    }
+    const QByteArray data = reply->readAll();
+    it->received += data.size();
+    if (!it->streamed) {
+        it->body += data;
+    }
+    deliverChunks(callKey, data);
+}
+
+/**
+ * @brief Przekazuje oczekującym z onChunk część treści, której jeszcze nie dostali.
+ * Przy strumieniowaniu wszyscy oczekujący dołączyli przed pierwszym bajtem, więc dostają tylko nowe bajty.
+ * Funkcje zwrotne są wywoływane po zaktualizowaniu stanu, bo mogą wywołać get() lub cancel().
+ * @param callKey Klucz żądania.
+ * @param data Bajty odebrane właśnie z sieci.
+ */
+void ApiDispatcher::deliverChunks(quint64 callKey, const QByteArray& data)
+{
+    auto it = calls.find(callKey);
+    if (it == calls.end()) {
+        return;
+    }
+    struct Delivery {
+        ApiRequest request;
+        QPointer<QObject> receiver;
+        ChunkCallback onChunk;
+        QByteArray chunk;
+    };
+    QVector<Delivery> deliveries;
+    for (Waiter& waiter : it->waiters) {
+        if (!waiter.onChunk || !waiter.receiver || waiter.delivered >= it->received) {
+            continue;
+        }
+        deliveries.append({waiter.request, waiter.receiver, waiter.onChunk,
+                           it->streamed ? data : it->body.mid(int(waiter.delivered))});
+        waiter.delivered = it->received;
+    }
+    for (const Delivery& delivery : deliveries) {
+        if (delivery.receiver) {
+            delivery.onChunk(delivery.request, delivery.chunk);
+        }
+    }
+}
+
+/**
+ * @brief Rozsyła zakończoną odpowiedź do wszystkich oczekujących.
+ * @param callKey Klucz żądania.
+ * @param reply Zakończona odpowiedź.
+ */
+void ApiDispatcher::onFinished(quint64 callKey, QNetworkReply* reply)
+{
+    auto it = calls.find(callKey);
+    if (it == calls.end() || it->reply != reply) {
+        reply->deleteLater();
+        return;
+    }
+    const QByteArray data = reply->readAll();
+    it->received += data.size();
+    if (!it->streamed) {
+        it->body += data;
+    }
+    if (reply->error() == QNetworkReply::NoError) {
+        deliverChunks(callKey, data);
+        it = calls.find(callKey);
+        if (it == calls.end() || it->reply != reply) {
+            return;
+        }
+    }
+    const QVector<Waiter> waiters = it->waiters;
+    const QVector<Waiter> deferred = it->deferred;
+    const QByteArray body = it->body;
+    calls.erase(it);
+
+    ApiReply result;
+    result.error = reply->error();
+    result.errorString = reply->errorString();
+    result.body = body;
+    result.fromCache = reply->attribute(QNetworkRequest::SourceIsFromCacheAttribute).toBool();
+    reply->deleteLater();
+    for (const Waiter& waiter : waiters) {
+        if (!waiter.receiver) {
+            continue;
+        }
+        result.request = waiter.request;
+        waiter.callback(result);
+    }
+    for (const Waiter& waiter : deferred) {
+        if (waiter.receiver) {
+            get(waiter.request.endpoint, waiter.request.id, waiter.receiver, waiter.callback, false, waiter.onChunk);
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef APIDISPATCHER_H
+#define APIDISPATCHER_H
+
+/**
+ * @file apidispatcher.h
+ * @brief Plik nagłówkowy dla klasy ApiDispatcher, wspólnego punktu wysyłania żądań do API GIOŚ.
+ */
+
+#include <QObject>
+#include <QNetworkAccessManager> ///< Do wysyłania żądań sieciowych.
+#include <QNetworkReply>        ///< Do obsługi odpowiedzi sieciowych.
+#include <QPointer>             ///< Do wykrywania usuniętych odbiorców.
+#include <QHash>                ///< Do żądań w toku według endpointu i ID.
+#include <QVector>              ///< Do listy oczekujących.
+#include <functional>           ///< Do funkcji zwrotnych.
+#include "apicache.h"           ///< Do dyskowej pamięci podręcznej HTTP.
+
+/// Endpoint API GIOŚ.
+enum class ApiEndpoint {
+    Stations,        ///< station/findAll
+    Sensors,         ///< station/sensors/{id stacji}
+    Measurements,    ///< data/getData/{id czujnika}
+    AirQualityIndex  ///< aqindex/getIndex/{id stacji}
+};
+
+/// Metadane żądania przekazywane razem z odpowiedzią.
+struct ApiRequest {
+    ApiEndpoint endpoint = ApiEndpoint::Stations; ///< Endpoint.
+    int id = 0;                                   ///< ID stacji lub czujnika (0 dla listy stacji).
+    quint64 serial = 0;                           ///< Numer kolejny żądania (rośnie z każdym wywołaniem get()).
+};
+
+/// Odpowiedź API z metadanymi żądania.
+struct ApiReply {
+    ApiRequest request;                                         ///< Żądanie, którego dotyczy odpowiedź.
+    QNetworkReply::NetworkError error = QNetworkReply::NoError; ///< Kod błędu sieci.
+    QString errorString;                                        ///< Opis błędu.
+    QByteArray body;                                            ///< Pełna treść (pusta, gdy była tylko przesyłana fragmentami).
+    bool fromCache = false;                                     ///< Czy treść pochodzi z pamięci podręcznej HTTP.
+    /// Informuje, czy odpowiedź nie zawiera błędu.
+    bool ok() const { return error == QNetworkReply::NoError; }
+};
+
+/**
+ * @class ApiDispatcher
+ * @brief Wysyła żądania GET do API, łącząc identyczne żądania w toku i pomijając nieaktualne.
+ *
+ * Żądanie jest identyfikowane przez endpoint i ID. Drugie wywołanie get() dla żądania w toku nie
+ * wysyła nic przez sieć, tylko dopisuje kolejnego oczekującego. Żądanie oznaczone jako zastępujące
+ * anuluje pozostałe żądania tego samego endpointu (np. czujniki poprzednio wybranej stacji):
+ * ich oczekujący nie dostaną odpowiedzi, a połączenie bez oczekujących jest przerywane.
+ * Po włączeniu pamięci podręcznej HTTP świeże odpowiedzi są zwracane z dysku, a wygasłe odnawiane
+ * żądaniem warunkowym. Oczekujący z funkcją onChunk dostają też kolejne fragmenty treści w miarę
+ * nadchodzenia (QNetworkReply::readyRead). Gdy wszyscy oczekujący mają onChunk, treść nie jest buforowana
+ * i ApiReply::body jest puste; oczekujący dołączający po pierwszych bajtach takiego żądania dostają
+ * odpowiedź z ponowionego żądania (zwykle z pamięci podręcznej HTTP). Przy buforowanej treści dołączający
+ * później dostają najpierw fragmenty już odebrane.
+ */
+class ApiDispatcher : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Funkcja zwrotna wywoływana z odpowiedzią.
+    using Callback = std::function<void(const ApiReply&)>;
+    /// Funkcja zwrotna wywoływana z kolejnym fragmentem treści odpowiedzi.
+    using ChunkCallback = std::function<void(const ApiRequest&, const QByteArray&)>;
+
+    /// Konstruktor, przyjmuje bazowy adres API.
+    explicit ApiDispatcher(const QString& baseUrl, QObject *parent = nullptr);
+
+    /// Włącza trwałą pamięć podręczną HTTP z czasem świeżości zależnym od endpointu.
+    void enableDiskCache(const QString& directory, qint64 maxBytes);
+    /// Wysyła (lub dołącza do trwającego) żądanie; zwraca jego numer kolejny.
+    quint64 get(ApiEndpoint endpoint, int id, QObject* receiver, const Callback& callback, bool supersede = false,
+                const ChunkCallback& onChunk = ChunkCallback());
+    /// Anuluje wszystkie żądania endpointu oprócz żądania dla exceptId.
+    void cancel(ApiEndpoint endpoint, int exceptId = -1);
+    /// Informuje, czy żądanie jest w toku.
+    bool isInFlight(ApiEndpoint endpoint, int id) const;
+    /// Zwraca liczbę połączeń sieciowych w toku.
+    int inFlightCount() const { return calls.size(); }
+    /// Zwraca adres URL żądania.
+    QUrl url(ApiEndpoint endpoint, int id) const;
+    /// Zwraca managera sieci.
+    QNetworkAccessManager* networkManager() const { return manager; }
+
+private:
+    /// Oczekujący na odpowiedź.
+    struct Waiter {
+        ApiRequest request;          ///< Metadane żądania tego oczekującego.
+        QPointer<QObject> receiver;  ///< Odbiorca (pomijany po usunięciu).
+        Callback callback;           ///< Funkcja zwrotna.
+        ChunkCallback onChunk;       ///< Funkcja zwrotna dla fragmentów (opcjonalna).
+        qint64 delivered = 0;        ///< Liczba bajtów treści przekazanych do onChunk.
+    };
+    /// Połączenie sieciowe w toku.
+    struct Call {
+        QNetworkReply* reply = nullptr; ///< Odpowiedź sieciowa.
+        QVector<Waiter> waiters;        ///< Oczekujący na tę odpowiedź.
+        QVector<Waiter> deferred;       ///< Oczekujący do ponowienia po zakończeniu (dołączyli do strumienia w toku).
+        QByteArray body;                ///< Odebrana dotąd treść (tylko przy buforowaniu).
+        qint64 received = 0;            ///< Liczba odebranych bajtów.
+        bool streamed = false;          ///< Czy treść jest tylko przekazywana do onChunk (bez bufora).
+    };
+
+    /// Zwraca klucz żądania.
+    static quint64 key(ApiEndpoint endpoint, int id);
+    /// Dopisuje odebrane bajty i przekazuje je oczekującym z onChunk.
+    void onReadyRead(quint64 callKey, QNetworkReply* reply);
+    /// Przekazuje nieprzekazaną część treści (lub nowe bajty strumienia) oczekującym z onChunk.
+    void deliverChunks(quint64 callKey, const QByteArray& data);
+    /// Rozsyła zakończoną odpowiedź do oczekujących.
+    void onFinished(quint64 callKey, QNetworkReply* reply);
+
+    /// Manager do żądań sieciowych.
+    QNetworkAccessManager* manager;
+    /// Bazowy adres API.
+    QString baseUrl;
+    /// Endpoint API dla listy stacji.
+    const QString API_STATIONS_ENDPOINT = "station/findAll";
+    /// Endpoint API dla czujników stacji.
+    const QString API_SENSORS_ENDPOINT = "station/sensors/";
+    /// Endpoint API dla pomiarów czujnika.
+    const QString API_MEASUREMENTS_ENDPOINT = "data/getData/";
+    /// Endpoint API dla indeksu jakości powietrza.
+    const QString API_AIR_QUALITY_ENDPOINT = "aqindex/getIndex/";
+    /// Czas świeżości listy stacji (sekundy): lista zmienia się rzadko.
+    const qint64 STATIONS_FRESHNESS_SECONDS = 7 * 24 * 3600;
+    /// Czas świeżości listy czujników stacji (sekundy).
+    const qint64 SENSORS_FRESHNESS_SECONDS = 3 * 24 * 3600;
+    /// Czas świeżości pomiarów (sekundy): dane są publikowane co godzinę.
+    const qint64 MEASUREMENTS_FRESHNESS_SECONDS = 20 * 60;
+    /// Czas świeżości indeksu jakości powietrza (sekundy).
+    const qint64 AIR_QUALITY_FRESHNESS_SECONDS = 20 * 60;
+    /// Połączenia w toku według klucza żądania.
+    QHash<quint64, Call> calls;
+    /// Ostatnio nadany numer żądania.
+    quint64 lastSerial;
+};
+
+#endif // APIDISPATCHER_H
@@ -0,0 +1,166 @@
+#include "chartseriesloader.h"
+#include <QXYSeries>          ///< Biblioteka do serii XY wykresów Qt Charts.
+#include <QDebug>             ///< Biblioteka do logowania komunikatów debugowania.
+#include <algorithm>          ///< Biblioteka do sortowania i wyszukiwania punktów.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+
+/**
+ * @file chartseriesloader.cpp
+ * @brief Implementacja klasy ChartSeriesLoader, przenoszącej szereg pomiarów na wykres.
+ */
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+QT_CHARTS_USE_NAMESPACE
+#endif
+
+/**
+ * @brief Zamienia szereg na punkty wykresu.
+ * API zwraca pomiary od najnowszego, więc punkty są sortowane rosnąco według czasu.
+ * @param series Szereg pomiarów.
+ * @return Punkty (ms od epoki, wartość) bez punktów pustych.
+ */
+QVector<QPointF> ChartSeriesLoader::points(const MeasurementSeries& series)
+{
+    QVector<QPointF> result;
+    result.reserve(series.validCount());
+    for (int i = 0; i < series.size(); ++i) {
+        if (!series.isNull(i)) {
+            result.append(QPointF(double(series.timestamp(i)), double(series.value(i))));
+        }
+    }
+    const auto byTime = [](const QPointF& a, const QPointF& b) { return a.x() < b.x(); };
+    if (!std::is_sorted(result.begin(), result.end(), byTime)) {
+        std::stable_sort(result.begin(), result.end(), byTime);
+    }
+    return result;
+}
+
+/**
+ * @brief Podmienia punkty serii wykresu jednym wywołaniem QXYSeries::replace().
+ * @param chartSeries Seria wykresu przekazana z QML (np. LineSeries).
+ * @param points Nowe punkty.
+ * @return True, jeśli obiekt jest serią XY.
+ */
+bool ChartSeriesLoader::replace(QObject* chartSeries, const QVector<QPointF>& points)
+{
+    QXYSeries* xySeries = qobject_cast<QXYSeries*>(chartSeries);
+    if (!xySeries) {
+        qDebug() << "Obiekt nie jest serią XY wykresu:" << chartSeries;
+        return false;
+    }
+    xySeries->replace(points);
+    return true;
+}
+
+/**
+ * @brief Wyznacza zakres danych do ustawienia osi wykresu.
+ * @param points Punkty posortowane rosnąco według czasu.
+ * @return Mapa {count, minValue, maxValue, mean, minTime, maxTime}; count = 0 dla pustej listy.
+ */
+QVariantMap ChartSeriesLoader::range(const QVector<QPointF>& points)
+{
+    QVariantMap result;
+    result["count"] = points.size();
+    if (points.isEmpty()) {
+        return result;
+    }
+    double minValue = points.first().y();
+    double maxValue = minValue;
+    double sum = 0.0;
+    for (const QPointF& point : points) {
+        minValue = std::min(minValue, point.y());
+        maxValue = std::max(maxValue, point.y());
+        sum += point.y();
+    }
+    result["minValue"] = minValue;
+    result["maxValue"] = maxValue;
+    result["mean"] = sum / points.size();
+    result["minTime"] = points.first().x();
+    result["maxTime"] = points.last().x();
+    return result;
+}
+
+/**
+ * @brief Zwraca punkty z przedziału czasu (np. widocznego po przybliżeniu).
+ * @param points Punkty posortowane rosnąco według czasu.
+ * @param fromTime Początek przedziału (ms od epoki).
+ * @param toTime Koniec przedziału (ms od epoki).
+ * @return Punkty z przedziału oraz najbliższy punkt przed nim i po nim.
+ */
+QVector<QPointF> ChartSeriesLoader::window(const QVector<QPointF>& points, double fromTime, double toTime)
+{
+    auto first = std::lower_bound(points.begin(), points.end(), fromTime,
+                                  [](const QPointF& point, double time) { return point.x() < time; });
+    auto last = std::upper_bound(points.begin(), points.end(), toTime,
+                                 [](double time, const QPointF& point) { return time < point.x(); });
+    if (first != points.begin()) {
+        --first;
+    }
+    if (last != points.end()) {
+        ++last;
+    }
+    if (first >= last) {
+        return QVector<QPointF>();
+    }
+    return QVector<QPointF>(first, last);
+}
+
+/**
+ * @brief Decymuje punkty algorytmem Largest-Triangle-Three-Buckets.
+ * Punkty między pierwszym a ostatnim są dzielone na threshold - 2 kubełki; z każdego wybierany jest
+ * punkt tworzący największy trójkąt z punktem wybranym wcześniej i średnią następnego kubełka,
+ * co zachowuje piki i kształt przebiegu.
+ * @param points Punkty posortowane rosnąco według czasu.
+ * @param threshold Docelowa liczba punktów (np. szerokość wykresu w pikselach).
+ * @return Punkty po decymacji (bez zmian, jeśli jest ich nie więcej niż threshold).
+ */
+QVector<QPointF> ChartSeriesLoader::downsample(const QVector<QPointF>& points, int threshold)
+{
+    const int count = points.size();
+    if (threshold < 3 || count <= threshold) {
+        return points;
+    }
+    QVector<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(points.first());
+
+    const double bucketSize = double(count - 2) / (threshold - 2);
+    int selected = 0;
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        /// Średnia następnego kubełka (dla ostatniego kubełka: ostatni punkt).
+        const int nextStart = int(std::floor((bucket + 1) * bucketSize)) + 1;
+        const int nextEnd = std::min(int(std::floor((bucket + 2) * bucketSize)) + 1, count);
+        double averageX = 0.0;
+        double averageY = 0.0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            averageX += points[i].x();
+            averageY += points[i].y();
+        }
+        const int nextCount = nextEnd - nextStart;
+        if (nextCount > 0) {
+            averageX /= nextCount;
+            averageY /= nextCount;
+        } else {
+            averageX = points.last().x();
+            averageY = points.last().y();
+        }
+
+        const int start = int(std::floor(bucket * bucketSize)) + 1;
+        const int end = std::min(int(std::floor((bucket + 1) * bucketSize)) + 1, count - 1);
+        const QPointF& previous = points[selected];
+        double maxArea = -1.0;
+        int best = start;
+        for (int i = start; i < end; ++i) {
+            const double area = std::abs((previous.x() - averageX) * (points[i].y() - previous.y())
+                                         - (previous.x() - points[i].x()) * (averageY - previous.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                best = i;
+            }
+        }
+        sampled.append(points[best]);
+        selected = best;
+    }
+    sampled.append(points.last());
+    return sampled;
+}
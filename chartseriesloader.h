@@ -0,0 +1,39 @@
+#ifndef CHARTSERIESLOADER_H
+#define CHARTSERIESLOADER_H
+
+/**
+ * @file chartseriesloader.h
+ * @brief Plik nagłówkowy dla klasy ChartSeriesLoader, przenoszącej szereg pomiarów na wykres.
+ */
+
+#include <QObject>
+#include <QVector>             ///< Do listy punktów wykresu.
+#include <QPointF>             ///< Do punktów (czas, wartość).
+#include <QVariantMap>         ///< Do przekazywania zakresu osi do QML.
+#include "measurementseries.h" ///< Do szeregu pomiarów.
+
+/**
+ * @class ChartSeriesLoader
+ * @brief Zamienia szereg kolumnowy na punkty wykresu i podmienia je w serii QtCharts jednym wywołaniem.
+ *
+ * Punkty (x = ms od epoki) są liczone w C++ i przekazywane do QXYSeries::replace(), co zastępuje
+ * dodawanie punktów po jednym z QML i parsowanie dat w JavaScript. Przed wysłaniem na wykres punkty
+ * są decymowane algorytmem LTTB (Largest-Triangle-Three-Buckets) do około jednego punktu na piksel,
+ * więc koszt rysowania zależy od szerokości wykresu, a nie od długości szeregu.
+ */
+class ChartSeriesLoader
+{
+public:
+    /// Zwraca punkty z wartością, posortowane rosnąco według czasu.
+    static QVector<QPointF> points(const MeasurementSeries& series);
+    /// Podmienia wszystkie punkty serii wykresu (QXYSeries z QML); false, jeśli obiekt nie jest serią XY.
+    static bool replace(QObject* chartSeries, const QVector<QPointF>& points);
+    /// Zwraca zakres danych dla osi: count, minValue, maxValue, mean, minTime, maxTime (ms).
+    static QVariantMap range(const QVector<QPointF>& points);
+    /// Zwraca punkty z przedziału czasu, z jednym sąsiednim punktem po obu stronach (ciągłość linii).
+    static QVector<QPointF> window(const QVector<QPointF>& points, double fromTime, double toTime);
+    /// Decymuje punkty algorytmem LTTB do co najwyżej threshold punktów (zachowuje pierwszy i ostatni).
+    static QVector<QPointF> downsample(const QVector<QPointF>& points, int threshold);
+};
+
+#endif // CHARTSERIESLOADER_H
@@ -0,0 +1,221 @@
+#include "deltahistorywriter.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QDateTime>           ///< Biblioteka do obsługi dat i czasu.
+#include <QCryptographicHash>  ///< Biblioteka do skrótu treści szeregu.
+#include <algorithm>           ///< Biblioteka do wyszukiwania binarnego kluczy dat.
+#include <cmath>               ///< Biblioteka do operacji matematycznych.
+#include <limits>              ///< Biblioteka do wartości granicznych typów.
+
+/**
+ * @file deltahistorywriter.cpp
+ * @brief Implementacja klasy DeltaHistoryWriter, zapisu do historii tylko nowych i zmienionych pomiarów.
+ */
+
+namespace {
+/// Format klucza daty rekordu historii.
+const QString DATE_KEY_FORMAT = "yyyyMMdd_HHmmss";
+
+/// Zwraca wartość punktu lub NaN dla braku.
+float pointValue(const MeasurementSeries& series, int i)
+{
+    return series.isNull(i) ? std::numeric_limits<float>::quiet_NaN() : series.value(i);
+}
+
+/// Porównuje wartości punktów (dwa braki są równe).
+bool sameValue(float a, float b)
+{
+    return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+/// Buduje szereg z punktów, od najnowszego (jak w odpowiedzi API).
+MeasurementSeries seriesFromPoints(const QString& key, const QMap<qint64, float>& points)
+{
+    MeasurementSeries series;
+    series.setKey(key);
+    series.reserve(points.size());
+    for (auto it = points.constEnd(); it != points.constBegin();) {
+        --it;
+        if (std::isnan(it.value())) {
+            series.appendNull(it.key());
+        } else {
+            series.append(it.key(), it.value());
+        }
+    }
+    return series;
+}
+}
+
+/**
+ * @brief Konstruktor klasy DeltaHistoryWriter.
+ * @param store Magazyn historii, do którego trafiają rekordy.
+ */
+DeltaHistoryWriter::DeltaHistoryWriter(HistoryStore* store)
+    : store(store)
+{
+}
+
+/**
+ * @brief Zapisuje nowe i zmienione punkty szeregu albo punkt kontrolny z pełnym szeregiem.
+ * @param sensorId ID czujnika.
+ * @param series Aktualne pomiary czujnika.
+ * @param sensorInfo Dane czujnika zapisywane w rekordzie (stacja, parametr).
+ * @param savedPoints Liczba zapisanych punktów (opcjonalnie).
+ * @return Unchanged, jeśli nie było nic nowego; Saved po zapisie; Failed przy błędzie magazynu.
+ */
+DeltaHistoryWriter::Outcome DeltaHistoryWriter::save(int sensorId, const MeasurementSeries& series,
+                                                     const QJsonObject& sensorInfo, int* savedPoints)
+{
+    if (savedPoints) {
+        *savedPoints = 0;
+    }
+    if (series.isEmpty()) {
+        return Unchanged;
+    }
+    const QByteArray hash = contentHash(series);
+    if (lastHash.value(sensorId) == hash) {
+        return Unchanged;
+    }
+    qint64 oldest = series.timestamp(0);
+    for (qint64 timestamp : series.timestamps()) {
+        oldest = qMin(oldest, timestamp);
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    auto known = storedPoints.find(sensorId);
+    const bool checkpoint = known == storedPoints.end() || deltasSinceCheckpoint.value(sensorId) >= CHECKPOINT_INTERVAL
+        || checkpointDay.value(sensorId) != now.date();
+    QMap<qint64, float> points;
+    for (int i = 0; i < series.size(); ++i) {
+        const float value = pointValue(series, i);
+        if (checkpoint) {
+            points.insert(series.timestamp(i), value);
+            continue;
+        }
+        auto it = known->constFind(series.timestamp(i));
+        if (it == known->constEnd() || !sameValue(it.value(), value)) {
+            points.insert(series.timestamp(i), value);
+        }
+    }
+    if (!points.isEmpty()) {
+        const QString dateKey = now.toString(DATE_KEY_FORMAT);
+        /// Drugi zapis w tej samej sekundzie nie może nadpisać punktów pierwszego.
+        QMap<qint64, float> recordPoints = points;
+        bool fullRecord = checkpoint;
+        if (store->contains(sensorId, dateKey)) {
+            MeasurementSeries previous;
+            QJsonObject metadata;
+            if (SeriesCodec::decodeRecordSeries(store->payload(sensorId, dateKey), &previous, &metadata)) {
+                fullRecord = fullRecord || !metadata["delta"].toBool();
+                for (int i = 0; i < previous.size(); ++i) {
+                    if (!recordPoints.contains(previous.timestamp(i))) {
+                        recordPoints.insert(previous.timestamp(i), pointValue(previous, i));
+                    }
+                }
+            }
+        }
+        QJsonObject data = seriesFromPoints(series.key(), recordPoints).toJson();
+        data["sensorInfo"] = sensorInfo;
+        data["saveDate"] = now.toString(Qt::ISODate);
+        if (!fullRecord) {
+            data["delta"] = true;
+        }
+        if (!store->put(sensorId, dateKey, data)) {
+            qDebug() << "Błąd zapisu nowych pomiarów czujnika ID:" << sensorId << ":" << store->errorString();
+            return Failed;
+        }
+        if (checkpoint) {
+            known = storedPoints.insert(sensorId, points);
+            deltasSinceCheckpoint.insert(sensorId, 0);
+            checkpointDay.insert(sensorId, now.date());
+        } else {
+            for (auto it = points.constBegin(); it != points.constEnd(); ++it) {
+                known->insert(it.key(), it.value());
+            }
+            ++deltasSinceCheckpoint[sensorId];
+        }
+        if (savedPoints) {
+            *savedPoints = points.size();
+        }
+    }
+    /// Punkty starsze od okna szeregu nie będą już porównywane.
+    while (!known->isEmpty() && known->firstKey() < oldest) {
+        known->erase(known->begin());
+    }
+    lastHash.insert(sensorId, hash);
+    return points.isEmpty() ? Unchanged : Saved;
+}
+
+/**
+ * @brief Zapomina zapisany stan czujników; zostanie odtworzony z magazynu przy następnym zapisie.
+ */
+void DeltaHistoryWriter::reset()
+{
+    lastHash.clear();
+    storedPoints.clear();
+    deltasSinceCheckpoint.clear();
+    checkpointDay.clear();
+}
+
+/**
+ * @brief Składa szereg czujnika z chwili untilDateKey.
+ * Rekordy są czytane wstecz od untilDateKey do najbliższego punktu kontrolnego (rekordu bez pola "delta"),
+ * najwyżej MAX_MERGED_RECORDS; późniejszy rekord wygrywa dla tego samego czasu. Pełny rekord (punkt
+ * kontrolny, stary autozapis, import) jest zwracany bez złączania.
+ * @param store Magazyn historii.
+ * @param sensorId ID czujnika.
+ * @param untilDateKey Ostatni uwzględniany klucz daty (pusty = najnowszy).
+ * @return Szereg; pusty, jeśli brak rekordów lub nie udało się ich zdekodować.
+ */
+MeasurementSeries DeltaHistoryWriter::mergedSeries(const HistoryStore* store, int sensorId, const QString& untilDateKey)
+{
+    const QStringList dateKeys = store->dateKeys(sensorId);
+    const int last = untilDateKey.isEmpty()
+        ? dateKeys.size() - 1
+        : int(std::upper_bound(dateKeys.constBegin(), dateKeys.constEnd(), untilDateKey) - dateKeys.constBegin()) - 1;
+    QVector<MeasurementSeries> records;
+    for (int i = last; i >= 0 && records.size() < MAX_MERGED_RECORDS; --i) {
+        MeasurementSeries record;
+        QJsonObject metadata;
+        if (!SeriesCodec::decodeRecordSeries(store->payload(sensorId, dateKeys[i]), &record, &metadata)) {
+            qDebug() << "Nie można zdekodować rekordu historii czujnika ID:" << sensorId << "klucz daty:" << dateKeys[i];
+            continue;
+        }
+        records.append(record);
+        if (!metadata["delta"].toBool()) {
+            break;
+        }
+    }
+    if (records.size() == 1) {
+        return records.first();
+    }
+    QMap<qint64, float> points;
+    QString key;
+    for (int r = records.size() - 1; r >= 0; --r) {
+        const MeasurementSeries& record = records[r];
+        if (!record.key().isEmpty()) {
+            key = record.key();
+        }
+        for (int i = 0; i < record.size(); ++i) {
+            points.insert(record.timestamp(i), pointValue(record, i));
+        }
+    }
+    return seriesFromPoints(key, points);
+}
+
+/**
+ * @brief Oblicza skrót SHA-1 klucza i kolumn szeregu.
+ * @param series Szereg pomiarów.
+ * @return Skrót treści.
+ */
+QByteArray DeltaHistoryWriter::contentHash(const MeasurementSeries& series)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(series.key().toUtf8());
+    hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(series.timestamps().constData()),
+                                         int(series.size() * sizeof(qint64))));
+    hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(series.values().constData()),
+                                         int(series.size() * sizeof(float))));
+    hash.addData(QByteArray::fromRawData(reinterpret_cast<const char*>(series.nulls().constData()),
+                                         int(series.nulls().size() * sizeof(quint64))));
+    return hash.result();
+}
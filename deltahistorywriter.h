@@ -0,0 +1,75 @@
+#ifndef DELTAHISTORYWRITER_H
+#define DELTAHISTORYWRITER_H
+
+/**
+ * @file deltahistorywriter.h
+ * @brief Plik nagłówkowy dla klasy DeltaHistoryWriter, zapisu do historii tylko nowych i zmienionych pomiarów.
+ */
+
+#include <QByteArray>          ///< Do skrótu treści szeregu.
+#include <QDate>               ///< Do dnia ostatniego punktu kontrolnego.
+#include <QHash>               ///< Do stanu według czujnika.
+#include <QJsonObject>         ///< Do danych czujnika.
+#include <QMap>                ///< Do zapisanych punktów według czasu.
+#include "historystore.h"      ///< Do magazynu historii.
+#include "measurementseries.h" ///< Do zapisywanych szeregów.
+
+/**
+ * @class DeltaHistoryWriter
+ * @brief Zapisuje w magazynie historii tylko punkty, których jeszcze nie ma (lub których wartość się zmieniła).
+ *
+ * GIOŚ aktualizuje pomiary co godzinę, a autozapis działa co minutę, więc większość zapisów powtarzałaby
+ * ten sam szereg. Skrót treści (SHA-1 kolumn) pozwala pominąć niezmieniony szereg bez porównywania punktów;
+ * zmieniony jest porównywany z zapisanym stanem czujnika i do magazynu trafia rekord z samymi różnicami
+ * (pole "delta").
+ *
+ * Pierwszy zapis czujnika w sesji, pierwszy zapis danego dnia i co CHECKPOINT_INTERVAL różnic zapisywany
+ * jest pełny szereg (punkt kontrolny, rekord bez pola "delta", jak stare rekordy autozapisu). Stan z danej
+ * chwili to punkt kontrolny nie późniejszy niż ona i różnice zapisane po nim, więc odczyt dotyka najwyżej
+ * kilkudziesięciu rekordów niezależnie od długości historii.
+ *
+ * Zapisany stan jest ograniczony do okna ostatnio zapisanego szeregu (API zwraca kilka ostatnich dni).
+ */
+class DeltaHistoryWriter
+{
+public:
+    /// Wynik zapisu.
+    enum Outcome {
+        Unchanged,  ///< Brak nowych punktów, nic nie zapisano.
+        Saved,      ///< Zapisano rekord z nowymi punktami.
+        Failed      ///< Błąd zapisu (opis w HistoryStore::errorString()).
+    };
+
+    /// Konstruktor, przyjmuje magazyn historii.
+    explicit DeltaHistoryWriter(HistoryStore* store = nullptr);
+
+    /// Zapisuje nowe i zmienione punkty szeregu czujnika; savedPoints otrzymuje ich liczbę.
+    Outcome save(int sensorId, const MeasurementSeries& series, const QJsonObject& sensorInfo, int* savedPoints = nullptr);
+    /// Zapomina zapisany stan czujników (po usunięciu rekordów z magazynu).
+    void reset();
+
+    /// Składa szereg czujnika z chwili untilDateKey (pusty = najnowszy): punkt kontrolny i różnice po nim.
+    static MeasurementSeries mergedSeries(const HistoryStore* store, int sensorId, const QString& untilDateKey = QString());
+
+private:
+    /// Liczba rekordów różnic, po której zapisywany jest punkt kontrolny.
+    static constexpr int CHECKPOINT_INTERVAL = 24;
+    /// Najdłuższy łańcuch rekordów czytany przy składaniu (historia zapisana bez punktów kontrolnych).
+    static constexpr int MAX_MERGED_RECORDS = 2 * CHECKPOINT_INTERVAL;
+
+    /// Zwraca skrót klucza i kolumn szeregu.
+    static QByteArray contentHash(const MeasurementSeries& series);
+
+    /// Magazyn historii.
+    HistoryStore* store;
+    /// Skrót ostatnio zapisanego (lub pominiętego) szeregu czujnika.
+    QHash<int, QByteArray> lastHash;
+    /// Zapisane punkty czujnika w oknie ostatniego szeregu (NaN = brak wartości).
+    QHash<int, QMap<qint64, float>> storedPoints;
+    /// Liczba rekordów różnic czujnika od ostatniego punktu kontrolnego.
+    QHash<int, int> deltasSinceCheckpoint;
+    /// Dzień ostatniego punktu kontrolnego czujnika.
+    QHash<int, QDate> checkpointDay;
+};
+
+#endif // DELTAHISTORYWRITER_H
@@ -0,0 +1,427 @@
+#include "historyimporter.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QDateTime>           ///< Biblioteka do obsługi dat i czasu.
+#include <QDirIterator>        ///< Biblioteka do przeglądania katalogów.
+#include <QFile>               ///< Biblioteka do odczytu plików.
+#include <QFileInfo>           ///< Biblioteka do informacji o plikach.
+#include <QJsonArray>          ///< Biblioteka do tablicy pomiarów.
+#include <QJsonDocument>       ///< Biblioteka do pracy z danymi JSON.
+#include <QSet>                ///< Biblioteka do użytych kluczy dat.
+#include <QXmlStreamReader>    ///< Biblioteka do odczytu plików XML.
+#include <QtConcurrent>        ///< Biblioteka do parsowania w puli wątków.
+#include "deltahistorywriter.h" ///< Biblioteka do skrótu treści szeregu.
+
+/**
+ * @file historyimporter.cpp
+ * @brief Implementacja klasy HistoryImporter, równoległego importu wielu plików do magazynu historii.
+ */
+
+namespace {
+/// Format klucza daty rekordu historii.
+const QString DATE_KEY_FORMAT = "yyyyMMdd_HHmmss";
+}
+
+/**
+ * @brief Konstruktor klasy HistoryImporter.
+ * @param store Magazyn historii, do którego trafiają zaimportowane rekordy.
+ * @param parent Opcjonalny rodzic obiektu.
+ */
+HistoryImporter::HistoryImporter(HistoryStore* store, QObject *parent)
+    : QObject(parent), store(store), fileCount(0)
+{
+    watcher = new QFutureWatcher<ParsedFile>(this);
+    connect(watcher, &QFutureWatcher<ParsedFile>::progressValueChanged, this, [this](int value) {
+        emit progress(value, fileCount);
+    });
+    connect(watcher, &QFutureWatcher<ParsedFile>::finished, this, &HistoryImporter::commit);
+}
+
+/**
+ * @brief Destruktor klasy HistoryImporter.
+ * Anuluje parsowanie i czeka na wątki robocze; nic nie jest zapisywane.
+ */
+HistoryImporter::~HistoryImporter()
+{
+    watcher->disconnect(this);
+    watcher->cancel();
+    watcher->waitForFinished();
+}
+
+/**
+ * @brief Uruchamia parsowanie plików w puli wątków.
+ * @param files Ścieżki plików .json i .xml.
+ * @return True, jeśli import wystartował.
+ */
+bool HistoryImporter::start(const QStringList& files)
+{
+    if (isRunning() || files.isEmpty() || !store->isOpen()) {
+        return false;
+    }
+    fileCount = files.size();
+    emit progress(0, fileCount);
+    FileParser parser;
+    parser.options = store->codecSettings();
+    watcher->setFuture(QtConcurrent::mapped(files, parser));
+    return true;
+}
+
+/**
+ * @brief Anuluje import w toku; pliki sparsowane do tej pory nie są zapisywane.
+ */
+void HistoryImporter::cancel()
+{
+    watcher->cancel();
+}
+
+/**
+ * @brief Informuje, czy import jest w toku.
+ * @return True, jeśli pliki są jeszcze parsowane.
+ */
+bool HistoryImporter::isRunning() const
+{
+    return watcher->isRunning();
+}
+
+/**
+ * @brief Zwraca pliki pasujące do wzorców.
+ * @param path Katalog (lub pojedynczy plik).
+ * @param patterns Wzorce nazw, np. {"*.json", "*.xml"}.
+ * @param recursive Czy przeglądać podkatalogi.
+ * @return Posortowane ścieżki plików.
+ */
+QStringList HistoryImporter::findFiles(const QString& path, const QStringList& patterns, bool recursive)
+{
+    const QFileInfo info(path);
+    if (info.isFile()) {
+        return QStringList(info.absoluteFilePath());
+    }
+    QStringList files;
+    QDirIterator it(path, patterns, QDir::Files | QDir::Readable,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+    files.sort();
+    return files;
+}
+
+/**
+ * @brief Wczytuje dane z pliku JSON.
+ * @param filename Ścieżka do pliku JSON.
+ * @param error Opis błędu (opcjonalnie).
+ * @return Obiekt JSON z danymi lub pusty obiekt w razie błędu.
+ */
+QJsonObject HistoryImporter::loadJson(const QString& filename, QString* error)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = "Błąd odczytu pliku: " + file.errorString();
+        }
+        return QJsonObject();
+    }
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    file.close();
+    if (doc.isNull()) {
+        if (error) {
+            *error = "Nieprawidłowy JSON: " + parseError.errorString();
+        }
+        return QJsonObject();
+    }
+    return doc.object();
+}
+
+/**
+ * @brief Wczytuje dane z pliku XML w formacie eksportu.
+ * @param filename Ścieżka do pliku XML.
+ * @param error Opis błędu (opcjonalnie); dane sprzed błędu są zwracane.
+ * @return Obiekt JSON z danymi lub pusty obiekt, jeśli pliku nie da się otworzyć.
+ */
+QJsonObject HistoryImporter::loadXml(const QString& filename, QString* error)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = "Błąd odczytu pliku: " + file.errorString();
+        }
+        return QJsonObject();
+    }
+    QXmlStreamReader reader(&file);
+    QJsonObject result;
+    QJsonArray values;
+    while (!reader.atEnd()) {
+        if (reader.readNextStartElement()) {
+            if (reader.name() == "Key") {
+                result["key"] = reader.readElementText();
+            } else if (reader.name() == "SaveDate") {
+                result["saveDate"] = reader.readElementText();
+            } else if (reader.name() == "SensorInfo") {
+                QJsonObject sensorInfo;
+                while (reader.readNextStartElement()) {
+                    sensorInfo[reader.name().toString()] = reader.readElementText();
+                }
+                result["sensorInfo"] = sensorInfo;
+            } else if (reader.name() == "Values") {
+                while (reader.readNextStartElement()) {
+                    if (reader.name() == "Measurement") {
+                        QJsonObject measurement;
+                        while (reader.readNextStartElement()) {
+                            if (reader.name() == "Date") {
+                                measurement["date"] = reader.readElementText();
+                            } else if (reader.name() == "Value") {
+                                QString valueStr = reader.readElementText();
+                                measurement["value"] = (valueStr == "null") ? QJsonValue::Null : valueStr.toDouble();
+                            } else {
+                                reader.skipCurrentElement();
+                            }
+                        }
+                        values.append(measurement);
+                    } else {
+                        reader.skipCurrentElement();
+                    }
+                }
+            } else {
+                reader.skipCurrentElement();
+            }
+        }
+    }
+    if (reader.hasError() && error) {
+        *error = "Błąd parsowania XML: " + reader.errorString();
+    }
+    result["values"] = values;
+    file.close();
+    return result;
+}
+
+/**
+ * @brief Sprawdza, czy dane mają poprawne pola sensorInfo, key i values.
+ * @param data Dane w formacie eksportu.
+ * @param error Opis pierwszego błędu (opcjonalnie).
+ * @return True, jeśli dane można zapisać w historii.
+ */
+bool HistoryImporter::validate(const QJsonObject& data, QString* error)
+{
+    QString problem;
+    if (!data["sensorInfo"].isObject()) {
+        problem = "Brak pola sensorInfo";
+    } else if (sensorIdOf(data) <= 0) {
+        problem = "Brak ID czujnika w sensorInfo";
+    } else if (data["key"].toString().isEmpty()) {
+        problem = "Brak pola key";
+    } else if (!data["values"].isArray()) {
+        problem = "Brak tablicy values";
+    } else {
+        const QJsonArray values = data["values"].toArray();
+        for (int i = 0; i < values.size() && problem.isEmpty(); ++i) {
+            const QJsonObject measurement = values[i].toObject();
+            qint64 timestampMs = 0;
+            const QJsonValue value = measurement["value"];
+            if (!MeasurementSeries::parseDate(measurement["date"].toString(), &timestampMs)) {
+                problem = QString("Nieprawidłowa data pomiaru nr %1").arg(i + 1);
+            } else if (!value.isDouble() && !value.isNull()) {
+                problem = QString("Nieprawidłowa wartość pomiaru nr %1").arg(i + 1);
+            }
+        }
+    }
+    if (error) {
+        *error = problem;
+    }
+    return problem.isEmpty();
+}
+
+/**
+ * @brief Zwraca ID czujnika zapisane w sensorInfo.
+ * @param data Dane w formacie eksportu.
+ * @return ID czujnika lub 0, jeśli brak.
+ */
+int HistoryImporter::sensorIdOf(const QJsonObject& data)
+{
+    const QJsonValue id = data["sensorInfo"].toObject()["id"];
+    return id.isString() ? id.toString().toInt() : id.toInt();
+}
+
+/**
+ * @brief Czyta, parsuje, sprawdza i koduje plik w wątku roboczym.
+ * Rekord dostaje klucz daty z saveDate pliku; wolny klucz dobiera commit() w wątku głównym.
+ * @param path Ścieżka pliku (format według rozszerzenia).
+ * @param options Kodowanie rekordów magazynu.
+ * @return Wynik parsowania; error jest pusty dla poprawnego pliku.
+ */
+HistoryImporter::ParsedFile HistoryImporter::parseFile(const QString& path, const SeriesCodec::Options& options)
+{
+    ParsedFile parsed;
+    parsed.path = path;
+    QJsonObject data;
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "json") {
+        data = loadJson(path, &parsed.error);
+    } else if (suffix == "xml") {
+        data = loadXml(path, &parsed.error);
+    } else {
+        parsed.error = "Nieobsługiwany format importu";
+    }
+    if (parsed.error.isEmpty() && validate(data, &parsed.error)) {
+        parsed.record = HistoryStore::prepareBatchRecord(sensorIdOf(data), preferredDateKey(data), data, options);
+        parsed.hash = payloadHash(parsed.record.payload);
+    }
+    return parsed;
+}
+
+/**
+ * @brief Zapisuje poprawne pliki jedną paczką i zgłasza wynik.
+ * Pliki już zapisane w magazynie lub powtórzone w paczce są pomijane. Po anulowaniu nic nie jest zapisywane.
+ */
+void HistoryImporter::commit()
+{
+    if (watcher->isCanceled()) {
+        qDebug() << "Import anulowany, nie zapisano żadnego pliku";
+        emit finished(0, 0, QStringList("Import anulowany"));
+        return;
+    }
+    QVector<HistoryStore::BatchRecord> records;
+    QStringList errors;
+    int failed = 0;
+    int skipped = 0;
+    QSet<QString> used;
+    QHash<QString, QByteArray> batchHashes;
+    const QList<ParsedFile> results = watcher->future().results();
+    for (const ParsedFile& parsed : results) {
+        if (!parsed.error.isEmpty()) {
+            ++failed;
+            if (errors.size() < MAX_REPORTED_ERRORS) {
+                errors.append(QFileInfo(parsed.path).fileName() + ": " + parsed.error);
+            }
+            continue;
+        }
+        HistoryStore::BatchRecord record = parsed.record;
+        if (isImported(store, record.sensorId, record.dateKey, parsed.hash, &batchHashes)) {
+            ++skipped;
+            continue;
+        }
+        const QString dateKey = availableDateKey(store, record.sensorId, record.dateKey, &used);
+        batchHashes.insert(QString::number(record.sensorId) + "/" + dateKey, parsed.hash);
+        if (dateKey != record.dateKey) {
+            /// Ramka zawiera klucz daty, więc zostanie zbudowana przy zapisie.
+            record.dateKey = dateKey;
+            record.frame.clear();
+        }
+        records.append(record);
+    }
+    if (!store->putBatch(records)) {
+        qDebug() << "Błąd zapisu paczki importu:" << store->errorString();
+        errors.prepend("Błąd zapisu: " + store->errorString());
+        failed += records.size();
+        records.clear();
+    }
+    if (skipped > 0) {
+        errors.append("Pominięto pliki zaimportowane wcześniej: " + QString::number(skipped));
+    }
+    qDebug() << "Zaimportowano" << records.size() << "plików, odrzucono" << failed << "pominięto" << skipped;
+    emit progress(fileCount, fileCount);
+    emit finished(records.size(), failed, errors);
+}
+
+/**
+ * @brief Zwraca klucz daty rekordu: z saveDate pliku, a bez niej z bieżącego czasu.
+ * Klucz zajęty w magazynie lub w tej paczce jest przesuwany o sekundę, aby pliki się nie nadpisywały.
+ * @param store Magazyn historii.
+ * @param sensorId ID czujnika.
+ * @param data Dane pliku.
+ * @param used Klucze użyte w paczce ("sensorId/dateKey"), uzupełniane o wynik; nullptr dla pojedynczego pliku.
+ * @return Klucz daty.
+ */
+QString HistoryImporter::uniqueDateKey(const HistoryStore* store, int sensorId, const QJsonObject& data,
+                                       QSet<QString>* used)
+{
+    return availableDateKey(store, sensorId, preferredDateKey(data), used);
+}
+
+/**
+ * @brief Zwraca klucz daty z saveDate pliku, a bez niej z bieżącego czasu.
+ * @param data Dane pliku.
+ * @return Klucz daty (może być zajęty).
+ */
+QString HistoryImporter::preferredDateKey(const QJsonObject& data)
+{
+    QDateTime saveDate = QDateTime::fromString(data["saveDate"].toString(), Qt::ISODate);
+    if (!saveDate.isValid()) {
+        saveDate = QDateTime::currentDateTime();
+    }
+    return saveDate.toString(DATE_KEY_FORMAT);
+}
+
+/**
+ * @brief Zwraca klucz daty, przesuwając go o sekundę, dopóki jest zajęty w magazynie lub w used.
+ * @param store Magazyn historii.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz preferowany.
+ * @param used Klucze użyte w paczce ("sensorId/dateKey"), uzupełniane o wynik; może być nullptr.
+ * @return Wolny klucz daty.
+ */
+QString HistoryImporter::availableDateKey(const HistoryStore* store, int sensorId, const QString& dateKey,
+                                          QSet<QString>* used)
+{
+    QDateTime dateTime = QDateTime::fromString(dateKey, DATE_KEY_FORMAT);
+    QString result = dateKey;
+    while ((used && used->contains(QString::number(sensorId) + "/" + result)) || store->contains(sensorId, result)) {
+        dateTime = dateTime.addSecs(1);
+        result = dateTime.toString(DATE_KEY_FORMAT);
+    }
+    if (used) {
+        used->insert(QString::number(sensorId) + "/" + result);
+    }
+    return result;
+}
+
+/**
+ * @brief Zwraca skrót treści rekordu.
+ * Skrót liczony jest ze zdekodowanego szeregu, więc nie zależy od ustawień kodowania magazynu.
+ * @param payload Treść rekordu (SeriesCodec lub zwarty JSON).
+ * @return Skrót SHA-1 lub pusty napis, jeśli treści nie da się odczytać.
+ */
+QByteArray HistoryImporter::payloadHash(const QByteArray& payload)
+{
+    MeasurementSeries series;
+    if (!SeriesCodec::decodeRecordSeries(payload, &series)) {
+        return QByteArray();
+    }
+    return DeltaHistoryWriter::contentHash(series);
+}
+
+/**
+ * @brief Sprawdza, czy rekord o podanej treści został już zaimportowany.
+ * Import przesuwa zajęty klucz o sekundę, więc sprawdzane są kolejne zajęte klucze od dateKey.
+ * @param store Magazyn historii.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz preferowany (z saveDate pliku).
+ * @param hash Skrót treści rekordu (payloadHash).
+ * @param batch Skróty rekordów bieżącej paczki ("sensorId/dateKey"); może być nullptr.
+ * @return True, jeśli ten sam szereg jest już zapisany.
+ */
+bool HistoryImporter::isImported(const HistoryStore* store, int sensorId, const QString& dateKey, const QByteArray& hash,
+                                 const QHash<QString, QByteArray>* batch)
+{
+    if (hash.isEmpty()) {
+        return false;
+    }
+    QDateTime dateTime = QDateTime::fromString(dateKey, DATE_KEY_FORMAT);
+    QString key = dateKey;
+    while (true) {
+        const QString batchKey = QString::number(sensorId) + "/" + key;
+        const bool inBatch = batch && batch->contains(batchKey);
+        const bool inStore = store->contains(sensorId, key);
+        if (!inBatch && !inStore) {
+            return false;
+        }
+        if ((inBatch && batch->value(batchKey) == hash)
+            || (inStore && payloadHash(store->payload(sensorId, key)) == hash)) {
+            return true;
+        }
+        if (!dateTime.isValid()) {
+            return false;
+        }
+        dateTime = dateTime.addSecs(1);
+        key = dateTime.toString(DATE_KEY_FORMAT);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef HISTORYIMPORTER_H
+#define HISTORYIMPORTER_H
+
+/**
+ * @file historyimporter.h
+ * @brief Plik nagłówkowy dla klasy HistoryImporter, równoległego importu wielu plików do magazynu historii.
+ */
+
+#include <QObject>
+#include <QFutureWatcher>      ///< Do odbioru wyników parsowania w wątku głównym.
+#include <QHash>               ///< Do skrótów rekordów paczki.
+#include <QJsonObject>         ///< Do danych zaimportowanych plików.
+#include <QStringList>         ///< Do listy plików i błędów.
+#include "historystore.h"      ///< Do zapisu paczki rekordów.
+
+/**
+ * @class HistoryImporter
+ * @brief Importuje pliki JSON i XML (format eksportu/autozapisu) z katalogu do magazynu historii.
+ *
+ * Pliki są czytane, parsowane, sprawdzane (pola sensorInfo, key, values) i kodowane do postaci rekordu
+ * magazynu w puli wątków QtConcurrent, a poprawne trafiają do magazynu jedną paczką (HistoryStore::putBatch)
+ * po sparsowaniu wszystkich; w wątku głównym zostaje dobranie wolnych kluczy dat i dopisanie ramek.
+ * Magazyn nie jest zmieniany w trakcie parsowania, a anulowany import nie zapisuje niczego.
+ *
+ * Plik, którego szereg jest już zapisany pod kluczem z jego saveDate (lub kluczem przesuniętym z niego
+ * przy wcześniejszym imporcie), jest pomijany, więc ponowny import katalogu nie dubluje rekordów.
+ * Treści porównywane są skrótem SHA-1 zdekodowanego szeregu (DeltaHistoryWriter::contentHash).
+ */
+class HistoryImporter : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Wynik parsowania jednego pliku.
+    struct ParsedFile {
+        QString path;                      ///< Ścieżka pliku.
+        QString error;                     ///< Opis błędu (pusty, jeśli plik jest poprawny).
+        HistoryStore::BatchRecord record;  ///< Zakodowany rekord (klucz daty z saveDate pliku).
+        QByteArray hash;                   ///< Skrót treści rekordu (payloadHash).
+    };
+
+    /// Konstruktor, przyjmuje magazyn historii.
+    explicit HistoryImporter(HistoryStore* store, QObject *parent = nullptr);
+    /// Destruktor, anuluje i czeka na zakończenie parsowania.
+    ~HistoryImporter();
+
+    /// Uruchamia import plików; false, jeśli import jest w toku, lista jest pusta lub magazyn zamknięty.
+    bool start(const QStringList& files);
+    /// Anuluje import w toku (nic nie zostanie zapisane).
+    void cancel();
+    /// Informuje, czy import jest w toku.
+    bool isRunning() const;
+
+    /// Zwraca pliki katalogu pasujące do wzorców (np. "*.json"); ścieżka pliku zwraca ten plik.
+    static QStringList findFiles(const QString& path, const QStringList& patterns, bool recursive);
+    /// Wczytuje plik JSON; error otrzymuje opis błędu.
+    static QJsonObject loadJson(const QString& filename, QString* error);
+    /// Wczytuje plik XML; error otrzymuje opis błędu.
+    static QJsonObject loadXml(const QString& filename, QString* error);
+    /// Sprawdza pola sensorInfo, key i values; error otrzymuje opis błędu.
+    static bool validate(const QJsonObject& data, QString* error);
+    /// Zwraca ID czujnika z sensorInfo (liczba w JSON, tekst w XML); 0, jeśli brak.
+    static int sensorIdOf(const QJsonObject& data);
+    /// Zwraca klucz daty rekordu (z saveDate pliku), niekolidujący z magazynem i kluczami used (może być nullptr).
+    static QString uniqueDateKey(const HistoryStore* store, int sensorId, const QJsonObject& data, QSet<QString>* used);
+    /// Zwraca klucz daty z saveDate pliku (bez niej: bieżący czas).
+    static QString preferredDateKey(const QJsonObject& data);
+    /// Zwraca dateKey lub kolejną wolną sekundę, jeśli klucz jest zajęty w magazynie lub w used.
+    static QString availableDateKey(const HistoryStore* store, int sensorId, const QString& dateKey, QSet<QString>* used);
+    /// Zwraca skrót treści zakodowanego rekordu (DeltaHistoryWriter::contentHash zdekodowanego szeregu).
+    static QByteArray payloadHash(const QByteArray& payload);
+    /// Informuje, czy rekord o tym skrócie jest zapisany pod dateKey lub kolejnymi zajętymi sekundami (w magazynie
+    /// lub w paczce batch: "sensorId/dateKey" -> skrót; batch może być nullptr).
+    static bool isImported(const HistoryStore* store, int sensorId, const QString& dateKey, const QByteArray& hash,
+                           const QHash<QString, QByteArray>* batch);
+
+signals:
+    /// Informuje o postępie (przetworzone pliki z wszystkich).
+    void progress(int done, int total);
+    /// Informuje o zakończeniu importu (zapisane i odrzucone pliki, opisy błędów).
+    void finished(int imported, int failed, const QStringList& errors);
+
+private:
+    /// Funkcja parsowania plików dla QtConcurrent::mapped z kodowaniem magazynu.
+    struct FileParser {
+        typedef ParsedFile result_type;  ///< Typ wyniku (wymagany przez QtConcurrent w Qt 5).
+        SeriesCodec::Options options;    ///< Kodowanie rekordów.
+        /// Parsuje plik.
+        ParsedFile operator()(const QString& path) const { return parseFile(path, options); }
+    };
+
+    /// Czyta, parsuje, sprawdza i koduje plik (wątek roboczy).
+    static ParsedFile parseFile(const QString& path, const SeriesCodec::Options& options);
+    /// Zapisuje poprawne pliki jedną paczką i zgłasza wynik.
+    void commit();
+
+    /// Maksymalna liczba opisów błędów przekazywana w wyniku.
+    static constexpr int MAX_REPORTED_ERRORS = 20;
+
+    /// Magazyn historii.
+    HistoryStore* store;
+    /// Obserwator parsowania w puli wątków.
+    QFutureWatcher<ParsedFile>* watcher;
+    /// Liczba plików importu w toku.
+    int fileCount;
+};
+
+#endif // HISTORYIMPORTER_H
@@ -0,0 +1,474 @@
+#include "historyrollups.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QFile>               ///< Biblioteka do operacji na plikach.
+#include <QSaveFile>           ///< Biblioteka do atomowego zapisu pliku.
+#include <QDataStream>         ///< Biblioteka do binarnego kodowania agregatów.
+#include <QDateTime>           ///< Biblioteka do granic dób i miesięcy.
+#include <QSet>                ///< Biblioteka do zbioru dotkniętych dób.
+#include <QtEndian>            ///< Biblioteka do konwersji kolejności bajtów.
+#include <algorithm>           ///< Biblioteka do min/max.
+#include <cmath>               ///< Biblioteka do operacji matematycznych.
+
+/**
+ * @file historyrollups.cpp
+ * @brief Implementacja klasy HistoryRollups, agregatów godzinowych, dobowych i miesięcznych historii.
+ *
+ * Plik rollups.dat: magic, wersja, CRC-16 treści i treść QDataStream z rozmiarami segmentów, z których
+ * powstały agregaty, oraz otwartą godziną (początek i punkty) i trzema poziomami agregatów każdego czujnika.
+ */
+
+namespace {
+/// Znacznik początku pliku agregatów ("AQHR").
+const quint32 ROLLUPS_MAGIC = 0x41514852;
+/// Wersja formatu agregatów (3: punkty tylko otwartej godziny; pliki starszych wersji są odbudowywane).
+const quint16 ROLLUPS_VERSION = 3;
+/// Rozmiar nagłówka pliku agregatów (bajty).
+const int ROLLUPS_HEADER_SIZE = 8;
+/// Długość godziny (ms).
+const qint64 HOUR_MS = 3600000;
+
+/// Oblicza sumę kontrolną CRC-16 treści pliku agregatów.
+quint16 rollupsChecksum(const QByteArray& body)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(body));
+#else
+    return qChecksum(body.constData(), uint(body.size()));
+#endif
+}
+
+/// Sprawdza, czy dwa agregaty godziny opisują te same wartości (suma z dokładnością do kolejności dodawania).
+bool sameBucket(const HistoryRollups::Bucket& a, const HistoryRollups::Bucket& b)
+{
+    return a.count == b.count && a.min == b.min && a.max == b.max
+           && std::abs(a.sum - b.sum) <= 1e-9 * std::max(1.0, std::abs(a.sum));
+}
+
+/// Zwraca początek doby lokalnej (ms od epoki).
+qint64 dayStart(const QDate& date)
+{
+    return QDateTime(date, QTime(0, 0)).toMSecsSinceEpoch();
+}
+
+/// Zapisuje poziom agregatów.
+void writeTier(QDataStream& out, const QMap<qint64, HistoryRollups::Bucket>& tier)
+{
+    out << quint32(tier.size());
+    for (const HistoryRollups::Bucket& bucket : tier) {
+        out << qint64(bucket.start) << bucket.min << bucket.max << bucket.sum << qint32(bucket.count);
+    }
+}
+
+/// Zapisuje punkty otwartej godziny.
+void writePoints(QDataStream& out, const QMap<qint64, float>& points)
+{
+    out << quint32(points.size());
+    for (auto it = points.constBegin(); it != points.constEnd(); ++it) {
+        out << qint64(it.key()) << it.value();
+    }
+}
+
+/// Wczytuje punkty otwartej godziny.
+void readPoints(QDataStream& in, QMap<qint64, float>* points)
+{
+    quint32 size = 0;
+    in >> size;
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        qint64 timestamp = 0;
+        float value = 0.0f;
+        in >> timestamp >> value;
+        points->insert(timestamp, value);
+    }
+}
+
+/// Wczytuje poziom agregatów.
+void readTier(QDataStream& in, QMap<qint64, HistoryRollups::Bucket>* tier)
+{
+    quint32 size = 0;
+    in >> size;
+    for (quint32 i = 0; i < size && in.status() == QDataStream::Ok; ++i) {
+        HistoryRollups::Bucket bucket;
+        qint32 count = 0;
+        in >> bucket.start >> bucket.min >> bucket.max >> bucket.sum >> count;
+        bucket.count = count;
+        tier->insert(bucket.start, bucket);
+    }
+}
+}
+
+/**
+ * @brief Dopisuje punkty szeregu i przelicza dotknięte godziny, doby oraz miesiące.
+ * Najnowsza godzina z wartością staje się otwartą godziną czujnika (poprzednia zostaje zamknięta).
+ * Punkty otwartej godziny są scalane z zapamiętanymi (ostatni zapis wygrywa). Zamknięta godzina bez
+ * agregatu dostaje agregat z punktów rekordu; godzina z agregatem, którą rekord zmienia lub z której
+ * usuwa punkt, trafia do staleHours i nie jest zmieniana.
+ * @param sensorId ID czujnika.
+ * @param series Szereg zapisanego rekordu.
+ * @param staleHours Zbiór uzupełniany o zamknięte godziny do przeliczenia z rekordów (replaceHours).
+ */
+void HistoryRollups::addSeries(int sensorId, const MeasurementSeries& series, QSet<qint64>* staleHours)
+{
+    if (series.isEmpty()) {
+        return;
+    }
+    SensorTiers& tiers = sensors[sensorId];
+    qint64 newestHour = tiers.openHour;
+    for (int i = 0; i < series.size(); ++i) {
+        if (!series.isNull(i) && std::isfinite(series.value(i))) {
+            newestHour = std::max(newestHour, hourStart(series.timestamp(i)));
+        }
+    }
+    if (newestHour != tiers.openHour) {
+        /// Agregat poprzedniej otwartej godziny jest aktualny, więc jej punkty nie są już potrzebne.
+        tiers.openHour = newestHour;
+        tiers.openPoints.clear();
+        dirty = true;
+    }
+
+    QSet<qint64> touchedHours;
+    QMap<qint64, QMap<qint64, float>> closedPoints;
+    QSet<qint64> changedHours;
+    for (int i = 0; i < series.size(); ++i) {
+        const qint64 timestamp = series.timestamp(i);
+        const float value = series.value(i);
+        const bool isNull = series.isNull(i) || !std::isfinite(value);
+        const qint64 hour = hourStart(timestamp);
+        if (hour == tiers.openHour) {
+            if (isNull) {
+                if (tiers.openPoints.remove(timestamp) == 0) {
+                    continue;
+                }
+            } else {
+                auto existing = tiers.openPoints.find(timestamp);
+                if (existing != tiers.openPoints.end() && existing.value() == value) {
+                    continue;
+                }
+                tiers.openPoints.insert(timestamp, value);
+            }
+            touchedHours.insert(hour);
+        } else if (isNull) {
+            if (tiers.hours.contains(hour)) {
+                changedHours.insert(hour);
+            }
+        } else {
+            closedPoints[hour].insert(timestamp, value);
+        }
+    }
+
+    for (auto it = closedPoints.constBegin(); it != closedPoints.constEnd(); ++it) {
+        Bucket bucket;
+        pointsRange(it.value(), it.key(), it.key() + HOUR_MS, &bucket);
+        bucket.start = it.key();
+        auto existing = tiers.hours.constFind(it.key());
+        if (existing == tiers.hours.constEnd()) {
+            tiers.hours.insert(it.key(), bucket);
+            touchedHours.insert(it.key());
+        } else if (!sameBucket(existing.value(), bucket)) {
+            changedHours.insert(it.key());
+        }
+    }
+    for (qint64 hour : changedHours) {
+        staleHours->insert(hour);
+    }
+    if (touchedHours.isEmpty()) {
+        return;
+    }
+    if (touchedHours.contains(tiers.openHour)) {
+        Bucket bucket;
+        const bool any = pointsRange(tiers.openPoints, tiers.openHour, tiers.openHour + HOUR_MS, &bucket);
+        setHour(tiers, tiers.openHour, bucket, any);
+    }
+    refreshDays(tiers, touchedHours);
+    dirty = true;
+}
+
+/**
+ * @brief Zastępuje agregaty godzin agregatami z podanych punktów.
+ * Punkty otwartej godziny są przy tym zapamiętywane na nowo.
+ * @param sensorId ID czujnika.
+ * @param hours Początki godzin do zastąpienia.
+ * @param points Aktualne punkty czujnika z tych godzin (złożone z jego rekordów).
+ */
+void HistoryRollups::replaceHours(int sensorId, const QSet<qint64>& hours, const QMap<qint64, float>& points)
+{
+    if (hours.isEmpty()) {
+        return;
+    }
+    SensorTiers& tiers = sensors[sensorId];
+    for (qint64 hour : hours) {
+        Bucket bucket;
+        const bool any = pointsRange(points, hour, hour + HOUR_MS, &bucket);
+        setHour(tiers, hour, bucket, any);
+        if (hour == tiers.openHour) {
+            tiers.openPoints.clear();
+            for (auto it = points.lowerBound(hour); it != points.constEnd() && it.key() < hour + HOUR_MS; ++it) {
+                tiers.openPoints.insert(it.key(), it.value());
+            }
+        }
+    }
+    refreshDays(tiers, hours);
+    dirty = true;
+}
+
+/**
+ * @brief Zwraca początek godziny zawierającej znacznik czasu.
+ * @param timestamp Znacznik czasu (ms od epoki).
+ * @return Początek godziny (ms od epoki).
+ */
+qint64 HistoryRollups::hourStart(qint64 timestamp)
+{
+    return (timestamp >= 0 ? timestamp : timestamp - HOUR_MS + 1) / HOUR_MS * HOUR_MS;
+}
+
+/**
+ * @brief Ustawia agregat godziny albo go usuwa, jeśli godzina nie ma punktów.
+ * @param tiers Agregaty czujnika.
+ * @param hour Początek godziny (ms od epoki).
+ * @param bucket Agregat godziny (bez ustawionego początku).
+ * @param any Czy godzina ma co najmniej jeden punkt.
+ */
+void HistoryRollups::setHour(SensorTiers& tiers, qint64 hour, const Bucket& bucket, bool any)
+{
+    if (any) {
+        Bucket result = bucket;
+        result.start = hour;
+        tiers.hours.insert(hour, result);
+    } else {
+        tiers.hours.remove(hour);
+    }
+}
+
+/**
+ * @brief Przelicza doby (z godzin) i miesiące (z dób) obejmujące podane godziny.
+ * @param tiers Agregaty czujnika.
+ * @param touchedHours Początki zmienionych godzin.
+ */
+void HistoryRollups::refreshDays(SensorTiers& tiers, const QSet<qint64>& touchedHours)
+{
+    QSet<QDate> touchedDays;
+    for (qint64 hour : touchedHours) {
+        touchedDays.insert(QDateTime::fromMSecsSinceEpoch(hour).date());
+    }
+
+    QSet<QDate> touchedMonths;
+    for (const QDate& day : touchedDays) {
+        const qint64 from = dayStart(day);
+        Bucket result;
+        if (mergeRange(tiers.hours, from, dayStart(day.addDays(1)), &result)) {
+            result.start = from;
+            tiers.days.insert(from, result);
+        } else {
+            tiers.days.remove(from);
+        }
+        touchedMonths.insert(QDate(day.year(), day.month(), 1));
+    }
+    for (const QDate& month : touchedMonths) {
+        const qint64 from = dayStart(month);
+        Bucket result;
+        if (mergeRange(tiers.days, from, dayStart(month.addMonths(1)), &result)) {
+            result.start = from;
+            tiers.months.insert(from, result);
+        } else {
+            tiers.months.remove(from);
+        }
+    }
+}
+
+/**
+ * @brief Usuwa agregaty czujnika.
+ * @param sensorId ID czujnika.
+ */
+void HistoryRollups::removeSensor(int sensorId)
+{
+    if (sensors.remove(sensorId) > 0) {
+        dirty = true;
+    }
+}
+
+/**
+ * @brief Usuwa wszystkie agregaty.
+ */
+void HistoryRollups::clear()
+{
+    sensors.clear();
+    dirty = true;
+}
+
+/**
+ * @brief Zwraca agregaty poziomu z podanego zakresu czasu.
+ * @param sensorId ID czujnika.
+ * @param tier Poziom agregacji.
+ * @param fromMs Początek zakresu (ms od epoki).
+ * @param toMs Koniec zakresu (ms od epoki, włącznie).
+ * @return Agregaty posortowane według początku przedziału.
+ */
+QVector<HistoryRollups::Bucket> HistoryRollups::buckets(int sensorId, Tier tier, qint64 fromMs, qint64 toMs) const
+{
+    QVector<Bucket> result;
+    auto sensorIt = sensors.constFind(sensorId);
+    if (sensorIt == sensors.constEnd()) {
+        return result;
+    }
+    const QMap<qint64, Bucket>& source = tier == Hourly ? sensorIt->hours
+                                         : tier == Daily ? sensorIt->days : sensorIt->months;
+    for (auto it = source.lowerBound(fromMs); it != source.constEnd() && it.key() <= toMs; ++it) {
+        result.append(it.value());
+    }
+    return result;
+}
+
+/**
+ * @brief Składa agregat z punktów leżących w [from, to).
+ * @param points Punkty według znacznika czasu.
+ * @param from Początek przedziału (ms od epoki).
+ * @param to Koniec przedziału (ms od epoki, bez niego).
+ * @param result Złożony agregat (bez ustawionego początku).
+ * @return True, jeśli w przedziale był co najmniej jeden punkt.
+ */
+bool HistoryRollups::pointsRange(const QMap<qint64, float>& points, qint64 from, qint64 to, Bucket* result)
+{
+    bool any = false;
+    for (auto it = points.lowerBound(from); it != points.constEnd() && it.key() < to; ++it) {
+        const float value = it.value();
+        if (!any) {
+            result->min = value;
+            result->max = value;
+            any = true;
+        } else {
+            result->min = std::min(result->min, value);
+            result->max = std::max(result->max, value);
+        }
+        result->sum += value;
+        ++result->count;
+    }
+    return any;
+}
+
+/**
+ * @brief Składa agregat z agregatów niższego poziomu leżących w [from, to).
+ * @param source Agregaty niższego poziomu.
+ * @param from Początek przedziału (ms od epoki).
+ * @param to Koniec przedziału (ms od epoki, bez niego).
+ * @param result Złożony agregat (bez ustawionego początku).
+ * @return True, jeśli w przedziale był co najmniej jeden agregat.
+ */
+bool HistoryRollups::mergeRange(const QMap<qint64, Bucket>& source, qint64 from, qint64 to, Bucket* result)
+{
+    bool any = false;
+    for (auto it = source.lowerBound(from); it != source.constEnd() && it.key() < to; ++it) {
+        if (!any) {
+            result->min = it->min;
+            result->max = it->max;
+            any = true;
+        } else {
+            result->min = std::min(result->min, it->min);
+            result->max = std::max(result->max, it->max);
+        }
+        result->sum += it->sum;
+        result->count += it->count;
+    }
+    return any;
+}
+
+/**
+ * @brief Wczytuje agregaty z pliku.
+ * @param path Ścieżka pliku rollups.dat.
+ * @param coveredBytes Rozmiary segmentów, z których powstały agregaty.
+ * @return True, jeśli plik istnieje i jest poprawny.
+ */
+bool HistoryRollups::load(const QString& path, QMap<int, qint64>* coveredBytes)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    const QByteArray body = data.mid(ROLLUPS_HEADER_SIZE);
+    if (data.size() < ROLLUPS_HEADER_SIZE
+        || qFromBigEndian<quint32>(data.constData()) != ROLLUPS_MAGIC
+        || qFromBigEndian<quint16>(data.constData() + 4) != ROLLUPS_VERSION
+        || qFromBigEndian<quint16>(data.constData() + 6) != rollupsChecksum(body)) {
+        qDebug() << "Nieprawidłowy plik agregatów historii:" << path;
+        return false;
+    }
+
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    QHash<int, SensorTiers> loaded;
+    quint32 segmentCount = 0;
+    in >> segmentCount;
+    for (quint32 i = 0; i < segmentCount && in.status() == QDataStream::Ok; ++i) {
+        qint32 segmentId = 0;
+        qint64 covered = 0;
+        in >> segmentId >> covered;
+        coveredBytes->insert(segmentId, covered);
+    }
+    quint32 sensorCount = 0;
+    in >> sensorCount;
+    for (quint32 i = 0; i < sensorCount && in.status() == QDataStream::Ok; ++i) {
+        qint32 sensorId = 0;
+        in >> sensorId;
+        SensorTiers& tiers = loaded[sensorId];
+        qint64 openHour = 0;
+        in >> openHour;
+        tiers.openHour = openHour;
+        readPoints(in, &tiers.openPoints);
+        readTier(in, &tiers.hours);
+        readTier(in, &tiers.days);
+        readTier(in, &tiers.months);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Niekompletny plik agregatów historii:" << path;
+        coveredBytes->clear();
+        return false;
+    }
+    sensors = loaded;
+    dirty = false;
+    return true;
+}
+
+/**
+ * @brief Zapisuje agregaty do pliku (atomowo, przez QSaveFile).
+ * @param path Ścieżka pliku rollups.dat.
+ * @param coveredBytes Rozmiary segmentów, z których powstały agregaty.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryRollups::save(const QString& path, const QMap<int, qint64>& coveredBytes)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << quint32(coveredBytes.size());
+    for (auto it = coveredBytes.constBegin(); it != coveredBytes.constEnd(); ++it) {
+        out << qint32(it.key()) << qint64(it.value());
+    }
+    out << quint32(sensors.size());
+    for (auto it = sensors.constBegin(); it != sensors.constEnd(); ++it) {
+        out << qint32(it.key());
+        out << qint64(it->openHour);
+        writePoints(out, it->openPoints);
+        writeTier(out, it->hours);
+        writeTier(out, it->days);
+        writeTier(out, it->months);
+    }
+
+    QByteArray header(ROLLUPS_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(ROLLUPS_MAGIC, header.data());
+    qToBigEndian<quint16>(ROLLUPS_VERSION, header.data() + 4);
+    qToBigEndian<quint16>(rollupsChecksum(body), header.data() + 6);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Błąd zapisu agregatów historii:" << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(body);
+    if (!file.commit()) {
+        qDebug() << "Błąd zapisu agregatów historii:" << file.errorString();
+        return false;
+    }
+    dirty = false;
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef HISTORYROLLUPS_H
+#define HISTORYROLLUPS_H
+
+/**
+ * @file historyrollups.h
+ * @brief Plik nagłówkowy dla klasy HistoryRollups, agregatów godzinowych, dobowych i miesięcznych historii.
+ */
+
+#include <QHash>               ///< Do agregatów według czujnika.
+#include <QMap>                ///< Do agregatów posortowanych według czasu.
+#include <QSet>                ///< Do godzin wymagających przeliczenia.
+#include <QVector>             ///< Do zwracania zakresu agregatów.
+#include <limits>              ///< Do znacznika braku otwartej godziny.
+#include "measurementseries.h" ///< Do dodawania zapisanych szeregów.
+
+/**
+ * @class HistoryRollups
+ * @brief Poziomy agregatów (min, max, suma, liczba) historii każdego czujnika.
+ *
+ * Przechowywane są tylko agregaty oraz punkty otwartej (najnowszej) godziny każdego czujnika, więc
+ * pamięć i plik rollups.dat nie rosną z liczbą pomiarów. W otwartej godzinie punkt z późniejszego rekordu
+ * zastępuje wcześniejszy, a brak wartości go usuwa (jak przy składaniu widoku historii), więc nakładające
+ * się rekordy autozapisu nie liczą pomiaru wielokrotnie.
+ *
+ * Punkty zamkniętej godziny tworzą jej agregat tylko wtedy, gdy godzina nie ma jeszcze agregatu; rekord,
+ * którego punkty dają ten sam agregat, uznaje się za powtórzenie (np. okno API w kolejnym autozapisie).
+ * Pozostałe zmiany zamkniętych godzin addSeries zgłasza jako godziny do przeliczenia, a właściciel
+ * (HistoryStore) składa ich punkty z rekordów czujnika i przekazuje je do replaceHours.
+ * Po każdej zmianie przeliczane są tylko dotknięte doby (z co najwyżej 24 godzin) i miesiące
+ * (z co najwyżej 31 dób). Doby i miesiące liczone są w czasie lokalnym.
+ */
+class HistoryRollups
+{
+public:
+    /// Poziom agregacji.
+    enum Tier {
+        Hourly,  ///< Godziny.
+        Daily,   ///< Doby.
+        Monthly  ///< Miesiące.
+    };
+
+    /// Agregat przedziału czasu.
+    struct Bucket {
+        qint64 start = 0;   ///< Początek przedziału (ms od epoki).
+        float min = 0.0f;   ///< Najmniejsza wartość.
+        float max = 0.0f;   ///< Największa wartość.
+        double sum = 0.0;   ///< Suma wartości.
+        int count = 0;      ///< Liczba wartości.
+
+        /// Zwraca średnią.
+        double mean() const { return count > 0 ? sum / count : 0.0; }
+    };
+
+    /// Dodaje punkty zapisanego szeregu; zamknięte godziny, których nie da się zaktualizować, trafiają do staleHours.
+    void addSeries(int sensorId, const MeasurementSeries& series, QSet<qint64>* staleHours);
+    /// Zastępuje agregaty podanych godzin agregatami z punktów złożonych z rekordów czujnika.
+    void replaceHours(int sensorId, const QSet<qint64>& hours, const QMap<qint64, float>& points);
+    /// Usuwa agregaty czujnika (przed ich przeliczeniem).
+    void removeSensor(int sensorId);
+    /// Usuwa wszystkie agregaty.
+    void clear();
+    /// Zwraca agregaty poziomu, których początek leży w [fromMs, toMs], posortowane według czasu.
+    QVector<Bucket> buckets(int sensorId, Tier tier, qint64 fromMs, qint64 toMs) const;
+    /// Informuje, czy są zmiany niezapisane na dysk.
+    bool isDirty() const { return dirty; }
+
+    /// Wczytuje agregaty z pliku; coveredBytes otrzymuje rozmiary segmentów, z których powstały.
+    bool load(const QString& path, QMap<int, qint64>* coveredBytes);
+    /// Zapisuje agregaty wraz z rozmiarami segmentów, z których powstały.
+    bool save(const QString& path, const QMap<int, qint64>& coveredBytes);
+
+    /// Zwraca początek godziny zawierającej znacznik czasu (ms od epoki).
+    static qint64 hourStart(qint64 timestamp);
+
+private:
+    /// Agregaty jednego czujnika według początku przedziału.
+    struct SensorTiers {
+        qint64 openHour = std::numeric_limits<qint64>::min(); ///< Początek otwartej (najnowszej) godziny.
+        QMap<qint64, float> openPoints; ///< Punkty otwartej godziny według znacznika czasu (ms od epoki).
+        QMap<qint64, Bucket> hours;   ///< Godziny.
+        QMap<qint64, Bucket> days;    ///< Doby.
+        QMap<qint64, Bucket> months;  ///< Miesiące.
+    };
+
+    /// Składa agregat z punktów [from, to); false, jeśli żadnego nie ma.
+    static bool pointsRange(const QMap<qint64, float>& points, qint64 from, qint64 to, Bucket* result);
+    /// Składa agregat z agregatów [from, to) niższego poziomu; false, jeśli żadnego nie ma.
+    static bool mergeRange(const QMap<qint64, Bucket>& source, qint64 from, qint64 to, Bucket* result);
+    /// Ustawia lub usuwa agregat godziny.
+    static void setHour(SensorTiers& tiers, qint64 hour, const Bucket& bucket, bool any);
+    /// Przelicza doby i miesiące obejmujące podane godziny.
+    static void refreshDays(SensorTiers& tiers, const QSet<qint64>& touchedHours);
+
+    /// Agregaty według ID czujnika.
+    QHash<int, SensorTiers> sensors;
+    /// Czy są zmiany niezapisane na dysk.
+    bool dirty = false;
+};
+
+#endif // HISTORYROLLUPS_H
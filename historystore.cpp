@@ -0,0 +1,1498 @@
+#include "historystore.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QDir>                ///< Biblioteka do pracy z katalogami.
+#include <QDataStream>         ///< Biblioteka do binarnego kodowania rekordów.
+#include <QDateTime>           ///< Biblioteka do kluczy dat przeliczanych godzin.
+#include <QFileInfo>           ///< Biblioteka do informacji o plikach.
+#include <QSaveFile>           ///< Biblioteka do atomowego zapisu indeksu.
+#include <QJsonDocument>       ///< Biblioteka do pracy z danymi JSON.
+#include <QtEndian>            ///< Biblioteka do konwersji kolejności bajtów.
+#include <QtConcurrent>        ///< Biblioteka do uruchamiania zadań w puli wątków.
+#include <algorithm>           ///< Biblioteka do sortowania.
+#include <cmath>               ///< Biblioteka do sprawdzania wartości skończonych.
+#include <limits>              ///< Biblioteka do ograniczenia rezerwacji paczki.
+
+/**
+ * @file historystore.cpp
+ * @brief Implementacja klasy HistoryStore, magazynu historii opartego na segmentach tylko-do-dopisywania.
+ *
+ * Format segmentu: nagłówek (magic, wersja, flagi), a po nim ramki rekordów. Ramka to długość treści
+ * (quint32, big-endian), suma kontrolna CRC-16 treści (quint16) oraz treść zakodowana QDataStream:
+ * typ rekordu, ID czujnika, klucz daty i dane zakodowane przez SeriesCodec (starsze rekordy: zwarty JSON).
+ *
+ * Plik index.dat: magic, wersja, CRC-16 treści i treść QDataStream z rozmiarami segmentów pokrytymi
+ * przez indeks oraz położeniami rekordów każdego czujnika.
+ *
+ * Plik rollups.dat (HistoryRollups): agregaty czujników i rozmiary segmentów, z których powstały.
+ */
+
+namespace {
+/// Znacznik początku pliku segmentu ("AQHS").
+const quint32 SEGMENT_MAGIC = 0x41514853;
+/// Wersja formatu segmentu.
+const quint16 SEGMENT_VERSION = 1;
+/// Rozmiar nagłówka segmentu (bajty).
+const int SEGMENT_HEADER_SIZE = 8;
+/// Flaga segmentu powstałego w wyniku kompaktowania.
+const quint16 COMPACTED_SEGMENT = 0x0001;
+/// Rozmiar nagłówka ramki rekordu (bajty).
+const int FRAME_HEADER_SIZE = 6;
+/// Znacznik początku pliku indeksu ("AQHI").
+const quint32 INDEX_MAGIC = 0x41514849;
+/// Wersja formatu indeksu.
+const quint16 INDEX_VERSION = 1;
+/// Rozmiar nagłówka pliku indeksu (bajty).
+const int INDEX_HEADER_SIZE = 8;
+/// Nazwa pliku indeksu.
+const QString INDEX_FILENAME = "index.dat";
+/// Nazwa pliku agregatów.
+const QString ROLLUPS_FILENAME = "rollups.dat";
+/// Nazwa pliku blokady magazynu.
+const QString LOCK_FILENAME = "store.lock";
+/// Format klucza daty rekordu.
+const QString DATE_KEY_FORMAT = "yyyyMMdd_HHmmss";
+/// Zapas przy wyborze rekordów do przeliczenia godziny (ms); rekord nie zawiera pomiarów późniejszych niż jego
+/// klucz daty, a zapas pokrywa przesunięcie zegara stacji.
+const qint64 ROLLUP_KEY_MARGIN_MS = 24 * 3600000LL;
+/// Górny limit rozmiaru treści rekordu, chroni przed odczytem uszkodzonej długości.
+const quint32 MAX_BODY_BYTES = 256 * 1024 * 1024;
+
+/// Oblicza sumę kontrolną CRC-16 treści rekordu.
+quint16 bodyChecksum(const QByteArray& body)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(body));
+#else
+    return qChecksum(body.constData(), uint(body.size()));
+#endif
+}
+
+/// Zwraca nazwę pliku segmentu o podanym numerze.
+QString segmentFileName(int segmentId)
+{
+    return QString("segment_%1.log").arg(segmentId, 6, 10, QChar('0'));
+}
+
+/// Zwraca nazwę pliku tymczasowego kompaktowania dla segmentu docelowego.
+QString compactFileName(int segmentId)
+{
+    return QString("segment_%1.compact").arg(segmentId, 6, 10, QChar('0'));
+}
+}
+
+/**
+ * @brief Konstruktor klasy HistoryStore.
+ * @param directory Katalog, w którym przechowywane są segmenty.
+ * @param parent Opcjonalny rodzic obiektu.
+ */
+HistoryStore::HistoryStore(const QString& directory, QObject *parent)
+    : QObject(parent), storeDirectory(directory), opened(false), activeSegmentId(0), unsavedIndexChanges(0)
+{
+    compactionWatcher = new QFutureWatcher<CompactionResult>(this);
+    connect(compactionWatcher, &QFutureWatcher<CompactionResult>::finished, this, [this]() {
+        applyCompaction(compactionWatcher->result());
+    });
+}
+
+/**
+ * @brief Destruktor klasy HistoryStore.
+ * Czeka na wątek kompaktowania; niezatwierdzony wynik zostanie wycofany przy następnym otwarciu.
+ */
+HistoryStore::~HistoryStore()
+{
+    if (compactionWatcher->isRunning()) {
+        compactionWatcher->waitForFinished();
+    }
+    flush();
+    releaseMappings();
+    activeFile.close();
+}
+
+/**
+ * @brief Otwiera magazyn i buduje indeks na podstawie istniejących segmentów.
+ * Najpierw zajmuje blokadę katalogu; magazyn otwarty przez inny proces nie jest otwierany.
+ * @return True, jeśli magazyn jest gotowy do pracy; false w przeciwnym razie.
+ */
+bool HistoryStore::open()
+{
+    QDir dir;
+    if (!dir.exists(storeDirectory) && !dir.mkpath(storeDirectory)) {
+        lastError = "Nie można utworzyć katalogu historii: " + storeDirectory;
+        qDebug() << lastError;
+        return false;
+    }
+    if (!storeLock) {
+        storeLock.reset(new QLockFile(storeDirectory + "/" + LOCK_FILENAME));
+        /// Blokada nie wygasa z czasem; przejmowana jest tylko po procesie, który już nie działa.
+        storeLock->setStaleLockTime(0);
+    }
+    if (!storeLock->isLocked() && !storeLock->tryLock(0)) {
+        if (storeLock->error() == QLockFile::LockFailedError) {
+            qint64 pid = 0;
+            QString hostname;
+            QString application;
+            storeLock->getLockInfo(&pid, &hostname, &application);
+            lastError = QString("Magazyn historii jest używany przez inny proces (%1, PID %2 na %3): %4")
+                            .arg(application).arg(pid).arg(hostname, storeDirectory);
+        } else {
+            lastError = "Nie można utworzyć blokady magazynu historii: " + storeDirectory;
+        }
+        qDebug() << lastError;
+        return false;
+    }
+
+    index.clear();
+    segmentBytes.clear();
+    segmentLiveBytes.clear();
+    rollupTiers.clear();
+    staleRollups.clear();
+    staleRollupHours.clear();
+    releaseMappings();
+    activeFile.close();
+
+    bool filesChanged = recoverInterruptedCompaction();
+
+    /// Segmenty starsze niż ostatni skompaktowany to pozostałości przerwanego kompaktowania.
+    QList<int> segments = listSegments();
+    int lastCompacted = 0;
+    for (int segmentId : segments) {
+        QFile file(segmentPath(segmentId));
+        quint16 flags = 0;
+        if (file.open(QIODevice::ReadOnly) && readSegmentHeader(file, &flags) && (flags & COMPACTED_SEGMENT)) {
+            lastCompacted = segmentId;
+        }
+    }
+    QList<int> liveSegments;
+    for (int segmentId : segments) {
+        if (segmentId < lastCompacted) {
+            qDebug() << "Usuwanie pozostałości kompaktowania:" << segmentPath(segmentId);
+            QFile::remove(segmentPath(segmentId));
+            filesChanged = true;
+        } else {
+            liveSegments.append(segmentId);
+        }
+    }
+
+    /// Indeks jest ważny, jeśli każdy opisany segment istnieje i nie jest krótszy niż pokryty fragment.
+    QMap<int, qint64> coveredBytes;
+    bool indexValid = !filesChanged && loadIndex(&coveredBytes) && coversLiveSegments(coveredBytes, liveSegments);
+    /// Agregaty sprawdzane są tak samo, niezależnie od indeksu (zapisywane są rzadziej).
+    QMap<int, qint64> rollupsCoveredBytes;
+    if (filesChanged || !rollupTiers.load(rollupsPath(), &rollupsCoveredBytes)
+        || !coversLiveSegments(rollupsCoveredBytes, liveSegments)) {
+        qDebug() << "Odbudowa agregatów historii z segmentów:" << storeDirectory;
+        rollupTiers.clear();
+        rollupsCoveredBytes.clear();
+    }
+    if (!indexValid) {
+        qDebug() << "Odbudowa indeksu historii z segmentów:" << storeDirectory;
+        index.clear();
+        segmentBytes.clear();
+        segmentLiveBytes.clear();
+        coveredBytes.clear();
+    }
+    unsavedIndexChanges = 0;
+
+    /// Odczytuje tylko rekordy, których nie obejmuje indeks lub agregaty.
+    for (int i = 0; i < liveSegments.size(); ++i) {
+        const int segmentId = liveSegments[i];
+        scanSegment(segmentId, coveredBytes.value(segmentId, SEGMENT_HEADER_SIZE),
+                    rollupsCoveredBytes.value(segmentId, SEGMENT_HEADER_SIZE), i == liveSegments.size() - 1);
+    }
+
+    int activeId = liveSegments.isEmpty() ? 1 : liveSegments.last();
+    if (segmentBytes.value(activeId) >= SEGMENT_MAX_BYTES) {
+        ++activeId;
+    }
+    if (!openActiveSegment(activeId)) {
+        return false;
+    }
+    opened = true;
+    if (!indexValid || unsavedIndexChanges > 0) {
+        saveIndex();
+    }
+    updateStaleRollups();
+    if (rollupTiers.isDirty()) {
+        saveRollups();
+    }
+    qDebug() << "Otwarto magazyn historii:" << storeDirectory << "segmenty:" << segmentBytes.size() << "czujniki:" << index.size();
+    return true;
+}
+
+/**
+ * @brief Informuje, czy magazyn jest otwarty.
+ * @return True, jeśli open() zakończyło się powodzeniem.
+ */
+bool HistoryStore::isOpen() const
+{
+    return opened;
+}
+
+/**
+ * @brief Informuje, czy magazyn nie zawiera żadnych rekordów.
+ * @return True, jeśli indeks jest pusty.
+ */
+bool HistoryStore::isEmpty() const
+{
+    return index.isEmpty();
+}
+
+/**
+ * @brief Zwraca katalog segmentów.
+ * @return Ścieżka do katalogu magazynu.
+ */
+QString HistoryStore::directory() const
+{
+    return storeDirectory;
+}
+
+/**
+ * @brief Zwraca opis ostatniego błędu.
+ * @return Tekst błędu lub pusty napis.
+ */
+QString HistoryStore::errorString() const
+{
+    return lastError;
+}
+
+/**
+ * @brief Zapisuje niezapisane zmiany indeksu i agregatów.
+ * Proces, który nie kończy się przez destruktor (np. zatrzymana usługa), traci najwyżej zmiany
+ * od ostatniego wywołania; przy otwarciu są one i tak odtwarzane z segmentów.
+ * @return True, jeśli zapis się powiódł lub nie było czego zapisywać.
+ */
+bool HistoryStore::flush()
+{
+    if (!opened) {
+        return true;
+    }
+    bool ok = true;
+    if (unsavedIndexChanges > 0) {
+        ok = saveIndex() && ok;
+    }
+    if (rollupTiers.isDirty()) {
+        ok = saveRollups() && ok;
+    }
+    return ok;
+}
+
+/**
+ * @brief Dopisuje rekord danych dla czujnika i klucza daty.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @param data Dane do zapisania.
+ * @return True, jeśli zapis się powiódł; false w przeciwnym razie.
+ */
+bool HistoryStore::put(int sensorId, const QString& dateKey, const QJsonObject& data)
+{
+    if (!opened) {
+        lastError = "Magazyn historii nie jest otwarty";
+        return false;
+    }
+    RecordLocation location;
+    const QByteArray payload = SeriesCodec::encodeRecord(data, codecOptions);
+    if (!appendRecord(PutRecord, sensorId, dateKey, payload, &location)) {
+        return false;
+    }
+    applyRecord(PutRecord, sensorId, dateKey, location);
+    addToRollups(sensorId, MeasurementSeries::fromJson(data));
+    updateStaleRollups();
+    maybeSaveIndex();
+    return true;
+}
+
+/**
+ * @brief Dopisuje rekord z gotowego szeregu; używane przez import strumieniowy.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @param series Szereg pomiarów rekordu.
+ * @param metadata Pola rekordu inne niż "key" i "values".
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryStore::putSeries(int sensorId, const QString& dateKey, const MeasurementSeries& series, const QJsonObject& metadata)
+{
+    if (!opened) {
+        lastError = "Magazyn historii nie jest otwarty";
+        return false;
+    }
+    RecordLocation location;
+    const QByteArray payload = SeriesCodec::encodeSeriesRecord(series, metadata, codecOptions);
+    if (!appendRecord(PutRecord, sensorId, dateKey, payload, &location)) {
+        return false;
+    }
+    applyRecord(PutRecord, sensorId, dateKey, location);
+    addToRollups(sensorId, series);
+    updateStaleRollups();
+    maybeSaveIndex();
+    return true;
+}
+
+/**
+ * @brief Koduje rekord paczki: treść (SeriesCodec), ramkę i szereg do agregatów.
+ * Nie korzysta ze stanu magazynu, więc może działać w wątku roboczym importu.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @param data Dane w formacie API.
+ * @param options Kodowanie treści (codecSettings() magazynu).
+ * @return Rekord gotowy do putBatch.
+ */
+HistoryStore::BatchRecord HistoryStore::prepareBatchRecord(int sensorId, const QString& dateKey, const QJsonObject& data,
+                                                           const SeriesCodec::Options& options)
+{
+    BatchRecord record;
+    record.sensorId = sensorId;
+    record.dateKey = dateKey;
+    record.payload = SeriesCodec::encodeRecord(data, options);
+    record.frame = encodeFrame(PutRecord, sensorId, dateKey, record.payload);
+    record.series = MeasurementSeries::fromJson(data);
+    return record;
+}
+
+/**
+ * @brief Dopisuje paczkę rekordów jednym zapisem do aktywnego segmentu.
+ *
+ * Rekordy są zakodowane wcześniej (prepareBatchRecord, w wątku roboczym); tutaj ramki trafiają do pliku
+ * jednym wywołaniem write() i jednym flush(). Ramka jest budowana tylko dla rekordu, którego klucz daty
+ * zmieniono po przygotowaniu. Indeks i agregaty są aktualizowane dopiero po udanym zapisie; indeks
+ * jest zapisywany, a zmienione zamknięte godziny przeliczane, raz na końcu.
+ * Paczka nie jest dzielona między segmenty, więc aktywny segment może przekroczyć limit rozmiaru.
+ * @param records Rekordy do zapisania (późniejszy wygrywa przy tym samym czujniku i kluczu daty).
+ * @return True, jeśli zapisano wszystkie rekordy; false, jeśli żadnego.
+ */
+bool HistoryStore::putBatch(const QVector<BatchRecord>& records)
+{
+    if (!opened) {
+        lastError = "Magazyn historii nie jest otwarty";
+        return false;
+    }
+    if (records.isEmpty()) {
+        return true;
+    }
+    if (activeFile.size() >= SEGMENT_MAX_BYTES && !openActiveSegment(activeSegmentId + 1)) {
+        return false;
+    }
+    QVector<QByteArray> frames;
+    frames.reserve(records.size());
+    qint64 batchSize = 0;
+    for (const BatchRecord& record : records) {
+        frames.append(record.frame.isEmpty()
+                      ? encodeFrame(PutRecord, record.sensorId, record.dateKey, record.payload) : record.frame);
+        batchSize += frames.last().size();
+    }
+    QByteArray batch;
+    /// Paczka większa niż pojemność QByteArray i tak się nie zmieści; rezerwacja jest tylko podpowiedzią.
+    batch.reserve(int(qMin<qint64>(batchSize, std::numeric_limits<int>::max())));
+    for (const QByteArray& frame : frames) {
+        batch.append(frame);
+    }
+
+    const qint64 offset = activeFile.size();
+    if (activeFile.write(batch) != batch.size() || !activeFile.flush()) {
+        lastError = "Błąd zapisu paczki rekordów historii: " + activeFile.errorString();
+        qDebug() << lastError;
+        activeFile.resize(offset);
+        return false;
+    }
+    RecordLocation location;
+    location.segmentId = activeSegmentId;
+    location.offset = offset;
+    for (int i = 0; i < records.size(); ++i) {
+        location.length = frames[i].size();
+        applyRecord(PutRecord, records[i].sensorId, records[i].dateKey, location);
+        addToRollups(records[i].sensorId, records[i].series);
+        location.offset += location.length;
+    }
+    segmentBytes[activeSegmentId] = location.offset;
+    updateStaleRollups();
+    saveIndex();
+    return true;
+}
+
+/**
+ * @brief Odczytuje rekord i buduje z niego obiekt JSON (dekodowanie jest przezroczyste).
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return Obiekt JSON z danymi lub pusty obiekt, jeśli brak rekordu lub błąd odczytu.
+ */
+QJsonObject HistoryStore::get(int sensorId, const QString& dateKey) const
+{
+    const QByteArray data = payload(sensorId, dateKey);
+    return data.isEmpty() ? QJsonObject() : SeriesCodec::decodeRecord(data);
+}
+
+/**
+ * @brief Odczytuje szereg rekordu bez pośredniej tablicy JSON.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return Szereg rekordu lub pusty szereg, jeśli brak rekordu lub błąd odczytu.
+ */
+MeasurementSeries HistoryStore::series(int sensorId, const QString& dateKey) const
+{
+    MeasurementSeries result;
+    const QByteArray data = payload(sensorId, dateKey);
+    if (!data.isEmpty() && !SeriesCodec::decodeRecordSeries(data, &result)) {
+        qDebug() << "Nie można zdekodować rekordu historii dla czujnika ID:" << sensorId << "klucz daty:" << dateKey;
+        return MeasurementSeries();
+    }
+    return result;
+}
+
+/**
+ * @brief Ustawia kodowanie nowych rekordów (istniejące rekordy są czytane niezależnie od ustawień).
+ * @param options Ustawienia SeriesCodec.
+ */
+void HistoryStore::setCodecOptions(const SeriesCodec::Options& options)
+{
+    codecOptions = options;
+}
+
+/**
+ * @brief Zwraca zakodowaną treść rekordu.
+ * Rekordy zamkniętych segmentów są czytane ze zmapowanej pamięci, a aktywnego segmentu
+ * jednym odczytem od zapamiętanego przesunięcia.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return Treść rekordu (SeriesCodec lub zwarty JSON) lub pusta tablica, jeśli brak rekordu lub błąd odczytu.
+ */
+QByteArray HistoryStore::payload(int sensorId, const QString& dateKey) const
+{
+    if (!contains(sensorId, dateKey)) {
+        return QByteArray();
+    }
+    const RecordLocation location = index.value(sensorId).value(dateKey);
+    QByteArray body;
+    qint64 frameLength = 0;
+    bool frameOk = false;
+    const MappedSegment* mapped = location.segmentId != activeSegmentId ? mapSegment(location.segmentId) : nullptr;
+    if (mapped && location.offset + location.length <= mapped->size) {
+        frameOk = parseFrame(reinterpret_cast<const char*>(mapped->data) + location.offset, location.length, &body, &frameLength);
+    } else {
+        QFile file(segmentPath(location.segmentId));
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(location.offset)) {
+            qDebug() << "Błąd odczytu segmentu historii:" << file.fileName() << file.errorString();
+            return QByteArray();
+        }
+        frameOk = readFrame(file, &body, &frameLength);
+    }
+    quint8 type = 0;
+    int storedSensorId = 0;
+    QString storedDateKey;
+    QByteArray data;
+    if (!frameOk
+        || !decodeBody(body, &type, &storedSensorId, &storedDateKey, &data)
+        || type != PutRecord || storedSensorId != sensorId || storedDateKey != dateKey) {
+        qDebug() << "Uszkodzony rekord historii dla czujnika ID:" << sensorId << "klucz daty:" << dateKey;
+        return QByteArray();
+    }
+    return data;
+}
+
+/**
+ * @brief Sprawdza, czy istnieje rekord dla czujnika i klucza daty.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return True, jeśli rekord istnieje.
+ */
+bool HistoryStore::contains(int sensorId, const QString& dateKey) const
+{
+    auto it = index.constFind(sensorId);
+    return it != index.constEnd() && it->contains(dateKey);
+}
+
+/**
+ * @brief Zwraca klucze dat zapisane dla czujnika, posortowane rosnąco.
+ * @param sensorId ID czujnika.
+ * @return Lista kluczy dat.
+ */
+QStringList HistoryStore::dateKeys(int sensorId) const
+{
+    return index.value(sensorId).keys();
+}
+
+/**
+ * @brief Zwraca ID czujników, które mają zapisane rekordy.
+ * @return Lista ID czujników.
+ */
+QList<int> HistoryStore::sensorIds() const
+{
+    return index.keys();
+}
+
+/**
+ * @brief Usuwa rekord czujnika, dopisując znacznik usunięcia.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return True, jeśli rekord istniał i został usunięty.
+ */
+bool HistoryStore::remove(int sensorId, const QString& dateKey)
+{
+    if (!removeRecord(sensorId, dateKey)) {
+        return false;
+    }
+    updateStaleRollups();
+    maybeSaveIndex();
+    return true;
+}
+
+/**
+ * @brief Usuwa rekordy o podanym kluczu daty dla wszystkich czujników.
+ * @param dateKey Klucz daty.
+ * @return Liczba usuniętych rekordów.
+ */
+int HistoryStore::removeDateKey(const QString& dateKey)
+{
+    QList<int> sensorIds;
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        if (it->contains(dateKey)) {
+            sensorIds.append(it.key());
+        }
+    }
+    int removed = 0;
+    for (int sensorId : sensorIds) {
+        if (removeRecord(sensorId, dateKey)) {
+            ++removed;
+        }
+    }
+    /// Agregaty są przeliczane raz dla całej operacji.
+    updateStaleRollups();
+    maybeSaveIndex();
+    return removed;
+}
+
+/**
+ * @brief Przenosi dane z pliku air_quality_history.json do segmentów.
+ * Wszystkie rekordy są zapisywane jedną paczką (putBatch), więc błąd nie zostawia części historii;
+ * po udanym imporcie stary plik otrzymuje rozszerzenie .migrated. Ponowny import tego samego pliku
+ * zapisuje te same klucze dat, więc tylko zastępuje rekordy.
+ * @param legacyPath Ścieżka do starego pliku historii.
+ * @return Liczba przeniesionych rekordów lub -1 w razie błędu.
+ */
+int HistoryStore::importLegacyFile(const QString& legacyPath)
+{
+    QFile legacyFile(legacyPath);
+    if (!legacyFile.open(QIODevice::ReadOnly)) {
+        lastError = "Błąd otwarcia starego pliku historii: " + legacyFile.errorString();
+        return -1;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(legacyFile.readAll());
+    legacyFile.close();
+    if (doc.isNull()) {
+        lastError = "Nieprawidłowy JSON w starym pliku historii: " + legacyPath;
+        return -1;
+    }
+    const QJsonObject history = doc.object();
+    QVector<BatchRecord> records;
+    for (auto sensorIt = history.begin(); sensorIt != history.end(); ++sensorIt) {
+        const int sensorId = sensorIt.key().toInt();
+        const QJsonObject sensorHistory = sensorIt.value().toObject();
+        for (auto it = sensorHistory.begin(); it != sensorHistory.end(); ++it) {
+            records.append(prepareBatchRecord(sensorId, it.key(), it.value().toObject(), codecOptions));
+        }
+    }
+    if (!putBatch(records)) {
+        return -1;
+    }
+    const int imported = records.size();
+    if (!legacyFile.rename(legacyPath + ".migrated")) {
+        qDebug() << "Nie można zmienić nazwy starego pliku historii:" << legacyFile.errorString();
+    }
+    return imported;
+}
+
+/**
+ * @brief Zwraca agregaty czujnika z podanego poziomu i zakresu czasu.
+ * @param sensorId ID czujnika.
+ * @param tier Poziom agregacji (godziny, doby, miesiące).
+ * @param fromMs Początek zakresu (ms od epoki).
+ * @param toMs Koniec zakresu (ms od epoki, włącznie).
+ * @return Agregaty posortowane według czasu.
+ */
+QVector<HistoryRollups::Bucket> HistoryStore::rollups(int sensorId, HistoryRollups::Tier tier, qint64 fromMs, qint64 toMs) const
+{
+    return rollupTiers.buckets(sensorId, tier, fromMs, toMs);
+}
+
+/**
+ * @brief Zwraca kopię agregatów; kontenery Qt są współdzielone niejawnie, więc kopia jest tania,
+ * a późniejsze zapisy magazynu jej nie zmieniają.
+ * @return Agregaty wszystkich czujników.
+ */
+HistoryRollups HistoryStore::rollupsSnapshot() const
+{
+    return rollupTiers;
+}
+
+/**
+ * @brief Sprawdza, czy zamknięte segmenty zawierają dość nieaktualnych danych do kompaktowania.
+ * @return True, jeśli kompaktowanie się opłaca.
+ */
+bool HistoryStore::needsCompaction() const
+{
+    qint64 sealedBytes = 0;
+    qint64 deadBytes = 0;
+    for (auto it = segmentBytes.constBegin(); it != segmentBytes.constEnd(); ++it) {
+        if (it.key() == activeSegmentId) {
+            continue;
+        }
+        sealedBytes += it.value();
+        deadBytes += it.value() - segmentLiveBytes.value(it.key());
+    }
+    return deadBytes >= COMPACTION_MIN_DEAD_BYTES && deadBytes * 2 >= sealedBytes;
+}
+
+/**
+ * @brief Uruchamia kompaktowanie zamkniętych segmentów w puli wątków.
+ * Aktywny segment nie jest kompaktowany, więc zapisy mogą trwać równolegle.
+ * @return True, jeśli kompaktowanie zostało uruchomione.
+ */
+bool HistoryStore::compactInBackground()
+{
+    if (!opened || isCompacting()) {
+        return false;
+    }
+    QList<int> sealed;
+    for (auto it = segmentBytes.constBegin(); it != segmentBytes.constEnd(); ++it) {
+        if (it.key() != activeSegmentId) {
+            sealed.append(it.key());
+        }
+    }
+    if (sealed.isEmpty()) {
+        return false;
+    }
+    const QString directoryPath = storeDirectory;
+    const int targetSegmentId = sealed.last();
+    qDebug() << "Kompaktowanie segmentów historii:" << sealed;
+    compactionWatcher->setFuture(QtConcurrent::run([directoryPath, sealed, targetSegmentId]() {
+        return runCompaction(directoryPath, sealed, targetSegmentId);
+    }));
+    return true;
+}
+
+/**
+ * @brief Informuje, czy kompaktowanie jest w toku.
+ * @return True, jeśli wątek kompaktowania pracuje.
+ */
+bool HistoryStore::isCompacting() const
+{
+    return compactionWatcher->isRunning();
+}
+
+/**
+ * @brief Zwraca ścieżkę do pliku segmentu.
+ * @param segmentId Numer segmentu.
+ * @return Pełna ścieżka pliku.
+ */
+QString HistoryStore::segmentPath(int segmentId) const
+{
+    return storeDirectory + "/" + segmentFileName(segmentId);
+}
+
+/**
+ * @brief Zwraca ścieżkę do pliku tymczasowego kompaktowania.
+ * @param segmentId Numer segmentu docelowego.
+ * @return Pełna ścieżka pliku.
+ */
+QString HistoryStore::compactPath(int segmentId) const
+{
+    return storeDirectory + "/" + compactFileName(segmentId);
+}
+
+/**
+ * @brief Zwraca ścieżkę do pliku indeksu.
+ * @return Pełna ścieżka pliku index.dat.
+ */
+QString HistoryStore::indexPath() const
+{
+    return storeDirectory + "/" + INDEX_FILENAME;
+}
+
+/**
+ * @brief Zwraca ścieżkę do pliku agregatów.
+ * @return Pełna ścieżka pliku rollups.dat.
+ */
+QString HistoryStore::rollupsPath() const
+{
+    return storeDirectory + "/" + ROLLUPS_FILENAME;
+}
+
+/**
+ * @brief Sprawdza, czy zapisane rozmiary segmentów opisują początek obecnych segmentów.
+ * Każdy opisany segment musi istnieć i nie być krótszy niż pokryty fragment, a segmenty starsze
+ * od ostatniego opisanego nie mogą być pominięte.
+ * @param coveredBytes Pokryte rozmiary segmentów (z indeksu lub pliku agregatów).
+ * @param liveSegments Numery obecnych segmentów.
+ * @return True, jeśli wystarczy odczytać rekordy dopisane za pokrytymi fragmentami.
+ */
+bool HistoryStore::coversLiveSegments(const QMap<int, qint64>& coveredBytes, const QList<int>& liveSegments) const
+{
+    const int lastCovered = coveredBytes.isEmpty() ? 0 : coveredBytes.lastKey();
+    for (int segmentId : liveSegments) {
+        if (!coveredBytes.contains(segmentId) && segmentId < lastCovered) {
+            return false;
+        }
+    }
+    for (auto it = coveredBytes.constBegin(); it != coveredBytes.constEnd(); ++it) {
+        if (!liveSegments.contains(it.key()) || QFileInfo(segmentPath(it.key())).size() < it.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Zwraca numery segmentów obecnych w katalogu, posortowane rosnąco.
+ * @return Lista numerów segmentów.
+ */
+QList<int> HistoryStore::listSegments() const
+{
+    QList<int> segments;
+    const QStringList files = QDir(storeDirectory).entryList(QStringList() << "segment_*.log", QDir::Files);
+    for (const QString& name : files) {
+        bool ok = false;
+        int segmentId = name.mid(8, name.length() - 12).toInt(&ok);
+        if (ok && segmentId > 0) {
+            segments.append(segmentId);
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+/**
+ * @brief Kończy lub wycofuje kompaktowanie przerwane zamknięciem programu.
+ * Jeśli segment docelowy nadal istnieje, wynik nie został zatwierdzony i jest usuwany;
+ * w przeciwnym razie plik tymczasowy przejmuje nazwę segmentu docelowego.
+ * @return True, jeśli zmieniono pliki segmentów (indeks trzeba wtedy odbudować).
+ */
+bool HistoryStore::recoverInterruptedCompaction()
+{
+    const QStringList files = QDir(storeDirectory).entryList(QStringList() << "segment_*.compact", QDir::Files);
+    bool changed = false;
+    for (const QString& name : files) {
+        int segmentId = name.mid(8, name.length() - 16).toInt();
+        if (QFile::exists(segmentPath(segmentId))) {
+            QFile::remove(compactPath(segmentId));
+        } else {
+            qDebug() << "Kończenie przerwanego kompaktowania segmentu:" << segmentId;
+            QFile::rename(compactPath(segmentId), segmentPath(segmentId));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Odczytuje rekordy segmentu nieobjęte indeksem lub agregatami i aktualizuje je.
+ * @param segmentId Numer segmentu.
+ * @param indexFrom Przesunięcie pierwszego rekordu nieobjętego indeksem.
+ * @param rollupsFrom Przesunięcie pierwszego rekordu nieobjętego agregatami.
+ * @param isLast Czy to ostatni segment (jego uszkodzona końcówka jest obcinana).
+ * @return True, jeśli segment odczytano do końca.
+ */
+bool HistoryStore::scanSegment(int segmentId, qint64 indexFrom, qint64 rollupsFrom, bool isLast)
+{
+    QFile file(segmentPath(segmentId));
+    quint16 flags = 0;
+    if (!file.open(QIODevice::ReadOnly) || !readSegmentHeader(file, &flags)) {
+        qDebug() << "Pominięto nieprawidłowy segment historii:" << file.fileName();
+        return false;
+    }
+    qint64 offset = qMax<qint64>(qMin(indexFrom, rollupsFrom), SEGMENT_HEADER_SIZE);
+    if (!file.seek(offset)) {
+        return false;
+    }
+    QByteArray body;
+    qint64 frameLength = 0;
+    while (readFrame(file, &body, &frameLength)) {
+        quint8 type = 0;
+        int sensorId = 0;
+        QString dateKey;
+        QByteArray payload;
+        if (!decodeBody(body, &type, &sensorId, &dateKey, &payload)) {
+            break;
+        }
+        RecordLocation location;
+        location.segmentId = segmentId;
+        location.offset = offset;
+        location.length = frameLength;
+        /// Godziny usuniętego rekordu odczytuje się z indeksu, zanim usunięcie zostanie do niego zastosowane.
+        if (offset >= rollupsFrom) {
+            if (type == PutRecord) {
+                MeasurementSeries series;
+                if (SeriesCodec::decodeRecordSeries(payload, &series)) {
+                    addToRollups(sensorId, series);
+                }
+            } else if (offset >= indexFrom && contains(sensorId, dateKey)) {
+                markRollupHours(sensorId, HistoryStore::payload(sensorId, dateKey));
+            } else {
+                staleRollups.insert(sensorId);
+            }
+        }
+        if (offset >= indexFrom) {
+            applyRecord(type, sensorId, dateKey, location);
+        }
+        offset += frameLength;
+    }
+    const qint64 fileSize = file.size();
+    file.close();
+    if (offset < fileSize) {
+        if (isLast) {
+            qDebug() << "Obcinanie niepełnego rekordu na końcu segmentu:" << file.fileName() << "od" << offset;
+            QFile::resize(file.fileName(), offset);
+        } else {
+            qDebug() << "Uszkodzony segment historii:" << file.fileName() << "od" << offset;
+        }
+    }
+    segmentBytes[segmentId] = offset;
+    return offset == fileSize;
+}
+
+/**
+ * @brief Otwiera aktywny segment do dopisywania, tworząc go w razie potrzeby.
+ * @param segmentId Numer segmentu.
+ * @return True, jeśli segment jest gotowy do zapisu.
+ */
+bool HistoryStore::openActiveSegment(int segmentId)
+{
+    activeFile.close();
+    activeFile.setFileName(segmentPath(segmentId));
+    const bool isNew = !activeFile.exists() || activeFile.size() == 0;
+    if (!activeFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        lastError = "Błąd otwarcia segmentu historii: " + activeFile.errorString();
+        qDebug() << lastError;
+        return false;
+    }
+    if (isNew && !writeSegmentHeader(activeFile, 0)) {
+        lastError = "Błąd zapisu nagłówka segmentu: " + activeFile.errorString();
+        qDebug() << lastError;
+        return false;
+    }
+    activeSegmentId = segmentId;
+    segmentBytes[segmentId] = activeFile.size();
+    return true;
+}
+
+/**
+ * @brief Dopisuje ramkę rekordu na końcu aktywnego segmentu.
+ * @param type Typ rekordu.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @param payload Zakodowane dane (puste dla znacznika usunięcia).
+ * @param location Położenie zapisanej ramki.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryStore::appendRecord(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload, RecordLocation* location)
+{
+    if (activeFile.size() >= SEGMENT_MAX_BYTES && !openActiveSegment(activeSegmentId + 1)) {
+        return false;
+    }
+    const QByteArray frame = encodeFrame(type, sensorId, dateKey, payload);
+    const qint64 offset = activeFile.size();
+    if (activeFile.write(frame) != frame.size() || !activeFile.flush()) {
+        lastError = "Błąd zapisu segmentu historii: " + activeFile.errorString();
+        qDebug() << lastError;
+        activeFile.resize(offset);
+        return false;
+    }
+    location->segmentId = activeSegmentId;
+    location->offset = offset;
+    location->length = frame.size();
+    segmentBytes[activeSegmentId] = offset + frame.size();
+    return true;
+}
+
+/**
+ * @brief Aktualizuje indeks i liczniki aktualnych bajtów po zapisie lub usunięciu rekordu.
+ * @param type Typ rekordu.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @param location Położenie nowej ramki.
+ */
+void HistoryStore::applyRecord(quint8 type, int sensorId, const QString& dateKey, const RecordLocation& location)
+{
+    ++unsavedIndexChanges;
+    QMap<QString, RecordLocation>& sensorIndex = index[sensorId];
+    auto existing = sensorIndex.find(dateKey);
+    if (existing != sensorIndex.end()) {
+        segmentLiveBytes[existing->segmentId] -= existing->length;
+    }
+    if (type == PutRecord) {
+        sensorIndex[dateKey] = location;
+        segmentLiveBytes[location.segmentId] += location.length;
+    } else {
+        if (existing != sensorIndex.end()) {
+            sensorIndex.erase(existing);
+        }
+        if (sensorIndex.isEmpty()) {
+            index.remove(sensorId);
+        }
+    }
+}
+
+/**
+ * @brief Dopisuje znacznik usunięcia rekordu i oznacza jego godziny do przeliczenia agregatów.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty.
+ * @return True, jeśli rekord istniał i został usunięty.
+ */
+bool HistoryStore::removeRecord(int sensorId, const QString& dateKey)
+{
+    if (!opened || !contains(sensorId, dateKey)) {
+        return false;
+    }
+    const QByteArray removedPayload = payload(sensorId, dateKey);
+    RecordLocation location;
+    if (!appendRecord(DeleteRecord, sensorId, dateKey, QByteArray(), &location)) {
+        return false;
+    }
+    markRollupHours(sensorId, removedPayload);
+    applyRecord(DeleteRecord, sensorId, dateKey, location);
+    return true;
+}
+
+/**
+ * @brief Dodaje szereg rekordu do agregatów; zamknięte godziny do przeliczenia trafiają do staleRollupHours.
+ * @param sensorId ID czujnika.
+ * @param series Szereg rekordu.
+ */
+void HistoryStore::addToRollups(int sensorId, const MeasurementSeries& series)
+{
+    QSet<qint64> staleHours;
+    rollupTiers.addSeries(sensorId, series, &staleHours);
+    if (!staleHours.isEmpty()) {
+        staleRollupHours[sensorId].unite(staleHours);
+    }
+}
+
+/**
+ * @brief Oznacza godziny, w których rekord ma punkty, do przeliczenia agregatów.
+ * Rekord, którego treści nie da się odczytać, oznacza do przeliczenia wszystkie agregaty czujnika.
+ * @param sensorId ID czujnika.
+ * @param payload Treść rekordu (SeriesCodec lub zwarty JSON).
+ */
+void HistoryStore::markRollupHours(int sensorId, const QByteArray& payload)
+{
+    MeasurementSeries series;
+    if (!SeriesCodec::decodeRecordSeries(payload, &series)) {
+        staleRollups.insert(sensorId);
+        return;
+    }
+    QSet<qint64>& hours = staleRollupHours[sensorId];
+    for (int i = 0; i < series.size(); ++i) {
+        hours.insert(HistoryRollups::hourStart(series.timestamp(i)));
+    }
+}
+
+/**
+ * @brief Przelicza agregaty oznaczonych czujników (w całości) i oznaczonych godzin.
+ */
+void HistoryStore::updateStaleRollups()
+{
+    for (int sensorId : staleRollups) {
+        rebuildRollups(sensorId);
+    }
+    staleRollups.clear();
+    for (auto it = staleRollupHours.constBegin(); it != staleRollupHours.constEnd(); ++it) {
+        if (!index.contains(it.key())) {
+            rollupTiers.removeSensor(it.key());
+        } else if (!it->isEmpty()) {
+            recomputeRollupHours(it.key(), it.value());
+        }
+    }
+    staleRollupHours.clear();
+}
+
+/**
+ * @brief Składa punkty podanych godzin z rekordów czujnika i zastępuje nimi agregaty tych godzin.
+ * Odczytywane są tylko rekordy o kluczach daty nie starszych niż najwcześniejsza godzina (z zapasem),
+ * w kolejności kluczy; późniejszy rekord wygrywa, a brak wartości usuwa punkt (jak w widoku historii).
+ * @param sensorId ID czujnika.
+ * @param hours Początki godzin do przeliczenia.
+ */
+void HistoryStore::recomputeRollupHours(int sensorId, const QSet<qint64>& hours)
+{
+    const qint64 firstHour = *std::min_element(hours.constBegin(), hours.constEnd());
+    const QString fromKey = QDateTime::fromMSecsSinceEpoch(firstHour - ROLLUP_KEY_MARGIN_MS).toString(DATE_KEY_FORMAT);
+    const QMap<QString, RecordLocation> sensorIndex = index.value(sensorId);
+    QMap<qint64, float> points;
+    for (auto it = sensorIndex.lowerBound(fromKey); it != sensorIndex.constEnd(); ++it) {
+        MeasurementSeries series;
+        if (!SeriesCodec::decodeRecordSeries(payload(sensorId, it.key()), &series)) {
+            continue;
+        }
+        for (int i = 0; i < series.size(); ++i) {
+            const qint64 timestamp = series.timestamp(i);
+            if (!hours.contains(HistoryRollups::hourStart(timestamp))) {
+                continue;
+            }
+            if (series.isNull(i) || !std::isfinite(series.value(i))) {
+                points.remove(timestamp);
+            } else {
+                points.insert(timestamp, series.value(i));
+            }
+        }
+    }
+    rollupTiers.replaceHours(sensorId, hours, points);
+}
+
+/**
+ * @brief Przelicza agregaty czujnika z aktualnych rekordów.
+ * Używane, gdy nie wiadomo, których godzin dotyczył usunięty rekord (np. indeks zapisany później niż agregaty).
+ * @param sensorId ID czujnika.
+ */
+void HistoryStore::rebuildRollups(int sensorId)
+{
+    rollupTiers.removeSensor(sensorId);
+    const QStringList keys = dateKeys(sensorId);
+    for (const QString& dateKey : keys) {
+        MeasurementSeries series;
+        if (SeriesCodec::decodeRecordSeries(payload(sensorId, dateKey), &series)) {
+            addToRollups(sensorId, series);
+        }
+    }
+}
+
+/**
+ * @brief Zapisuje agregaty wraz z rozmiarami segmentów, które obejmują.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryStore::saveRollups()
+{
+    return rollupTiers.save(rollupsPath(), segmentBytes);
+}
+
+/**
+ * @brief Zwraca mapowanie zamkniętego segmentu, tworząc je przy pierwszym użyciu.
+ * @param segmentId Numer segmentu.
+ * @return Wskaźnik na mapowanie lub nullptr, jeśli mapowanie się nie powiodło.
+ */
+const HistoryStore::MappedSegment* HistoryStore::mapSegment(int segmentId) const
+{
+    auto it = mappedSegments.constFind(segmentId);
+    if (it != mappedSegments.constEnd()) {
+        return &it.value();
+    }
+    MappedSegment mapped;
+    mapped.file = new QFile(segmentPath(segmentId));
+    if (mapped.file->open(QIODevice::ReadOnly)) {
+        mapped.size = mapped.file->size();
+        mapped.data = mapped.file->map(0, mapped.size);
+    }
+    if (!mapped.data) {
+        qDebug() << "Nie można zmapować segmentu historii:" << mapped.file->fileName() << mapped.file->errorString();
+        delete mapped.file;
+        return nullptr;
+    }
+    return &mappedSegments.insert(segmentId, mapped).value();
+}
+
+/**
+ * @brief Zwalnia mapowania segmentów.
+ * Wywoływane przed usunięciem lub zastąpieniem plików (w Windows zmapowanego pliku nie można usunąć).
+ */
+void HistoryStore::releaseMappings()
+{
+    for (auto it = mappedSegments.begin(); it != mappedSegments.end(); ++it) {
+        it->file->unmap(const_cast<uchar*>(it->data));
+        delete it->file;
+    }
+    mappedSegments.clear();
+}
+
+/**
+ * @brief Zatwierdza wynik kompaktowania i przepina indeks na nowy segment.
+ * Kolejność: usunięcie indeksu i segmentu docelowego, zmiana nazwy pliku tymczasowego, usunięcie
+ * starszych segmentów, zapis nowego indeksu. Przerwanie na dowolnym etapie jest naprawiane przez open().
+ * @param result Wynik zwrócony przez wątek kompaktowania.
+ */
+void HistoryStore::applyCompaction(const CompactionResult& result)
+{
+    if (!result.success) {
+        qDebug() << "Kompaktowanie historii nieudane:" << result.error;
+        QFile::remove(compactPath(result.targetSegmentId));
+        emit compactionFinished(false, 0);
+        return;
+    }
+    releaseMappings();
+    QFile::remove(indexPath());
+    QFile::remove(segmentPath(result.targetSegmentId));
+    if (!QFile::rename(compactPath(result.targetSegmentId), segmentPath(result.targetSegmentId))) {
+        qDebug() << "Błąd zatwierdzania kompaktowania, ponowne otwieranie magazynu";
+        opened = false;
+        open();
+        emit compactionFinished(false, 0);
+        return;
+    }
+    for (int segmentId : result.sourceSegments) {
+        if (segmentId != result.targetSegmentId) {
+            QFile::remove(segmentPath(segmentId));
+        }
+        segmentBytes.remove(segmentId);
+        segmentLiveBytes.remove(segmentId);
+    }
+
+    qint64 liveBytes = 0;
+    for (const RecordMove& move : result.moves) {
+        auto sensorIt = index.find(move.sensorId);
+        if (sensorIt == index.end()) {
+            continue;
+        }
+        auto it = sensorIt->find(move.dateKey);
+        if (it != sensorIt->end() && *it == move.from) {
+            *it = move.to;
+            liveBytes += move.to.length;
+        }
+    }
+    segmentBytes[result.targetSegmentId] = result.targetSize;
+    segmentLiveBytes[result.targetSegmentId] = liveBytes;
+    saveIndex();
+    /// Agregaty nie zmieniają się, ale opisują segmenty, które właśnie zastąpiono.
+    saveRollups();
+    qDebug() << "Kompaktowanie historii zakończone, odzyskano bajtów:" << result.reclaimedBytes;
+    emit compactionFinished(true, result.reclaimedBytes);
+}
+
+/**
+ * @brief Wczytuje indeks z pliku index.dat.
+ * @param coveredBytes Rozmiary segmentów obejmowane przez indeks.
+ * @return True, jeśli plik istnieje i jest poprawny.
+ */
+bool HistoryStore::loadIndex(QMap<int, qint64>* coveredBytes)
+{
+    QFile file(indexPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    if (data.size() < INDEX_HEADER_SIZE
+        || qFromBigEndian<quint32>(data.constData()) != INDEX_MAGIC
+        || qFromBigEndian<quint16>(data.constData() + 4) != INDEX_VERSION) {
+        qDebug() << "Nieprawidłowy nagłówek indeksu historii:" << indexPath();
+        return false;
+    }
+    const QByteArray body = data.mid(INDEX_HEADER_SIZE);
+    if (bodyChecksum(body) != qFromBigEndian<quint16>(data.constData() + 6)) {
+        qDebug() << "Uszkodzony indeks historii:" << indexPath();
+        return false;
+    }
+
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 segmentCount = 0;
+    in >> segmentCount;
+    for (quint32 i = 0; i < segmentCount && in.status() == QDataStream::Ok; ++i) {
+        qint32 segmentId = 0;
+        qint64 covered = 0;
+        qint64 live = 0;
+        in >> segmentId >> covered >> live;
+        coveredBytes->insert(segmentId, covered);
+        segmentBytes[segmentId] = covered;
+        segmentLiveBytes[segmentId] = live;
+    }
+    quint32 sensorCount = 0;
+    in >> sensorCount;
+    for (quint32 i = 0; i < sensorCount && in.status() == QDataStream::Ok; ++i) {
+        qint32 sensorId = 0;
+        quint32 entryCount = 0;
+        in >> sensorId >> entryCount;
+        QMap<QString, RecordLocation>& sensorIndex = index[sensorId];
+        for (quint32 j = 0; j < entryCount && in.status() == QDataStream::Ok; ++j) {
+            QString dateKey;
+            qint32 segmentId = 0;
+            RecordLocation location;
+            in >> dateKey >> segmentId >> location.offset >> location.length;
+            location.segmentId = segmentId;
+            sensorIndex.insert(dateKey, location);
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Niekompletny indeks historii:" << indexPath();
+        index.clear();
+        segmentBytes.clear();
+        segmentLiveBytes.clear();
+        coveredBytes->clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje indeks do pliku index.dat (atomowo, przez QSaveFile).
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryStore::saveIndex()
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << quint32(segmentBytes.size());
+    for (auto it = segmentBytes.constBegin(); it != segmentBytes.constEnd(); ++it) {
+        out << qint32(it.key()) << qint64(it.value()) << qint64(segmentLiveBytes.value(it.key()));
+    }
+    out << quint32(index.size());
+    for (auto sensorIt = index.constBegin(); sensorIt != index.constEnd(); ++sensorIt) {
+        out << qint32(sensorIt.key()) << quint32(sensorIt->size());
+        for (auto it = sensorIt->constBegin(); it != sensorIt->constEnd(); ++it) {
+            out << it.key() << qint32(it->segmentId) << qint64(it->offset) << qint64(it->length);
+        }
+    }
+
+    QByteArray header(INDEX_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(INDEX_MAGIC, header.data());
+    qToBigEndian<quint16>(INDEX_VERSION, header.data() + 4);
+    qToBigEndian<quint16>(bodyChecksum(body), header.data() + 6);
+
+    QSaveFile file(indexPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Błąd zapisu indeksu historii:" << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(body);
+    if (!file.commit()) {
+        qDebug() << "Błąd zapisu indeksu historii:" << file.errorString();
+        return false;
+    }
+    unsavedIndexChanges = 0;
+    return true;
+}
+
+/**
+ * @brief Zapisuje indeks po zebraniu INDEX_SAVE_THRESHOLD zmian.
+ * Rekordy dopisane po ostatnim zapisie są odtwarzane z segmentów przy otwarciu.
+ */
+void HistoryStore::maybeSaveIndex()
+{
+    if (unsavedIndexChanges >= INDEX_SAVE_THRESHOLD) {
+        saveIndex();
+    }
+}
+
+/**
+ * @brief Buduje ramkę rekordu: długość i suma kontrolna treści, a po nich treść.
+ * @return Ramka gotowa do dopisania do segmentu.
+ */
+QByteArray HistoryStore::encodeFrame(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload)
+{
+    const QByteArray body = encodeBody(type, sensorId, dateKey, payload);
+    QByteArray frame(FRAME_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(quint32(body.size()), frame.data());
+    qToBigEndian<quint16>(bodyChecksum(body), frame.data() + 4);
+    frame.append(body);
+    return frame;
+}
+
+/**
+ * @brief Koduje treść rekordu.
+ * @return Treść rekordu w formacie QDataStream.
+ */
+QByteArray HistoryStore::encodeBody(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload)
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << type << qint32(sensorId) << dateKey << payload;
+    return body;
+}
+
+/**
+ * @brief Dekoduje treść rekordu.
+ * @return True, jeśli treść jest poprawna.
+ */
+bool HistoryStore::decodeBody(const QByteArray& body, quint8* type, int* sensorId, QString* dateKey, QByteArray* payload)
+{
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    qint32 id = 0;
+    in >> *type >> id >> *dateKey >> *payload;
+    *sensorId = id;
+    return in.status() == QDataStream::Ok && (*type == PutRecord || *type == DeleteRecord);
+}
+
+/**
+ * @brief Sprawdza ramkę rekordu w buforze i zwraca jej treść bez kopiowania danych.
+ * Zwrócona treść wskazuje na bufor, więc musi być użyta, dopóki bufor istnieje.
+ * @param data Początek ramki.
+ * @param available Liczba bajtów dostępnych od początku ramki.
+ * @param body Treść rekordu (QByteArray::fromRawData).
+ * @param frameLength Długość całej ramki.
+ * @return True, jeśli ramka jest kompletna i suma kontrolna się zgadza.
+ */
+bool HistoryStore::parseFrame(const char* data, qint64 available, QByteArray* body, qint64* frameLength)
+{
+    if (available < FRAME_HEADER_SIZE) {
+        return false;
+    }
+    const quint32 bodyLength = qFromBigEndian<quint32>(data);
+    const quint16 checksum = qFromBigEndian<quint16>(data + 4);
+    if (bodyLength == 0 || bodyLength > MAX_BODY_BYTES || FRAME_HEADER_SIZE + qint64(bodyLength) > available) {
+        return false;
+    }
+    *body = QByteArray::fromRawData(data + FRAME_HEADER_SIZE, int(bodyLength));
+    if (bodyChecksum(*body) != checksum) {
+        return false;
+    }
+    *frameLength = FRAME_HEADER_SIZE + qint64(bodyLength);
+    return true;
+}
+
+/**
+ * @brief Odczytuje ramkę rekordu spod bieżącej pozycji pliku i weryfikuje sumę kontrolną.
+ * @param file Otwarty plik segmentu.
+ * @param body Odczytana treść rekordu.
+ * @param frameLength Długość całej ramki.
+ * @return True, jeśli odczytano poprawną ramkę.
+ */
+bool HistoryStore::readFrame(QFile& file, QByteArray* body, qint64* frameLength)
+{
+    const QByteArray header = file.read(FRAME_HEADER_SIZE);
+    if (header.size() != FRAME_HEADER_SIZE) {
+        return false;
+    }
+    const quint32 bodyLength = qFromBigEndian<quint32>(header.constData());
+    const quint16 checksum = qFromBigEndian<quint16>(header.constData() + 4);
+    if (bodyLength == 0 || bodyLength > MAX_BODY_BYTES) {
+        return false;
+    }
+    *body = file.read(bodyLength);
+    if (body->size() != int(bodyLength) || bodyChecksum(*body) != checksum) {
+        return false;
+    }
+    *frameLength = FRAME_HEADER_SIZE + qint64(bodyLength);
+    return true;
+}
+
+/**
+ * @brief Zapisuje nagłówek nowego segmentu.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool HistoryStore::writeSegmentHeader(QFile& file, quint16 flags)
+{
+    QByteArray header(SEGMENT_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(SEGMENT_MAGIC, header.data());
+    qToBigEndian<quint16>(SEGMENT_VERSION, header.data() + 4);
+    qToBigEndian<quint16>(flags, header.data() + 6);
+    return file.write(header) == header.size() && file.flush();
+}
+
+/**
+ * @brief Odczytuje i weryfikuje nagłówek segmentu.
+ * @return True, jeśli nagłówek jest poprawny.
+ */
+bool HistoryStore::readSegmentHeader(QFile& file, quint16* flags)
+{
+    const QByteArray header = file.read(SEGMENT_HEADER_SIZE);
+    if (header.size() != SEGMENT_HEADER_SIZE
+        || qFromBigEndian<quint32>(header.constData()) != SEGMENT_MAGIC
+        || qFromBigEndian<quint16>(header.constData() + 4) != SEGMENT_VERSION) {
+        return false;
+    }
+    *flags = qFromBigEndian<quint16>(header.constData() + 6);
+    return true;
+}
+
+/**
+ * @brief Przepisuje aktualne rekordy zamkniętych segmentów do pliku tymczasowego.
+ * Działa w wątku roboczym i korzysta tylko z niezmiennych, zamkniętych segmentów.
+ * Znaczniki usunięcia są pomijane, bo wynik zastępuje wszystkie starsze segmenty.
+ * @param directory Katalog magazynu.
+ * @param segments Numery zamkniętych segmentów, rosnąco.
+ * @param targetSegmentId Numer segmentu wynikowego (najnowszy z zamkniętych).
+ * @return Wynik kompaktowania z listą przeniesionych rekordów.
+ */
+HistoryStore::CompactionResult HistoryStore::runCompaction(const QString& directory, const QList<int>& segments, int targetSegmentId)
+{
+    CompactionResult result;
+    result.targetSegmentId = targetSegmentId;
+    result.sourceSegments = segments;
+
+    struct LatestRecord {
+        quint8 type = 0;
+        int sensorId = 0;
+        QString dateKey;
+        RecordLocation location;
+    };
+    QHash<QPair<int, QString>, LatestRecord> latest;
+    qint64 sourceBytes = 0;
+
+    for (int segmentId : segments) {
+        QFile file(directory + "/" + segmentFileName(segmentId));
+        quint16 flags = 0;
+        if (!file.open(QIODevice::ReadOnly) || !readSegmentHeader(file, &flags)) {
+            result.error = "Błąd odczytu segmentu: " + file.fileName();
+            return result;
+        }
+        sourceBytes += file.size();
+        qint64 offset = SEGMENT_HEADER_SIZE;
+        QByteArray body;
+        qint64 frameLength = 0;
+        while (readFrame(file, &body, &frameLength)) {
+            LatestRecord record;
+            QByteArray payload;
+            if (!decodeBody(body, &record.type, &record.sensorId, &record.dateKey, &payload)) {
+                break;
+            }
+            record.location.segmentId = segmentId;
+            record.location.offset = offset;
+            record.location.length = frameLength;
+            latest[qMakePair(record.sensorId, record.dateKey)] = record;
+            offset += frameLength;
+        }
+    }
+
+    QList<LatestRecord> live;
+    for (const LatestRecord& record : latest) {
+        if (record.type == PutRecord) {
+            live.append(record);
+        }
+    }
+    std::sort(live.begin(), live.end(), [](const LatestRecord& a, const LatestRecord& b) {
+        return a.location.segmentId != b.location.segmentId ? a.location.segmentId < b.location.segmentId
+                                                            : a.location.offset < b.location.offset;
+    });
+
+    QFile out(directory + "/" + compactFileName(targetSegmentId));
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || !writeSegmentHeader(out, COMPACTED_SEGMENT)) {
+        result.error = "Błąd tworzenia pliku kompaktowania: " + out.errorString();
+        return result;
+    }
+    QFile source;
+    for (const LatestRecord& record : live) {
+        const QString sourcePath = directory + "/" + segmentFileName(record.location.segmentId);
+        if (source.fileName() != sourcePath) {
+            source.close();
+            source.setFileName(sourcePath);
+            if (!source.open(QIODevice::ReadOnly)) {
+                result.error = "Błąd odczytu segmentu: " + sourcePath;
+                return result;
+            }
+        }
+        if (!source.seek(record.location.offset)) {
+            result.error = "Błąd pozycjonowania w segmencie: " + sourcePath;
+            return result;
+        }
+        const QByteArray frame = source.read(record.location.length);
+        const qint64 newOffset = out.pos();
+        if (frame.size() != record.location.length || out.write(frame) != frame.size()) {
+            result.error = "Błąd kopiowania rekordu do pliku kompaktowania";
+            return result;
+        }
+        RecordMove move;
+        move.sensorId = record.sensorId;
+        move.dateKey = record.dateKey;
+        move.from = record.location;
+        move.to.segmentId = targetSegmentId;
+        move.to.offset = newOffset;
+        move.to.length = record.location.length;
+        result.moves.append(move);
+    }
+    if (!out.flush()) {
+        result.error = "Błąd zapisu pliku kompaktowania: " + out.errorString();
+        return result;
+    }
+    result.targetSize = out.size();
+    result.reclaimedBytes = sourceBytes - result.targetSize;
+    result.success = true;
+    return result;
+}
@@ -0,0 +1,282 @@
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+/**
+ * @file historystore.h
+ * @brief Plik nagłówkowy dla klasy HistoryStore, magazynu historii pomiarów opartego na segmentach.
+ */
+
+#include <QObject>
+#include <QFile>               ///< Do zapisu aktywnego segmentu.
+#include <QHash>               ///< Do indeksu czujników.
+#include <QMap>                ///< Do posortowanych kluczy dat.
+#include <QJsonObject>         ///< Do przechowywania rekordów JSON.
+#include <QStringList>         ///< Do listy kluczy dat.
+#include <QFutureWatcher>      ///< Do kompaktowania w tle.
+#include <QLockFile>           ///< Do blokady magazynu przed innymi procesami.
+#include <QScopedPointer>      ///< Do blokady tworzonej przy otwarciu.
+#include <QSet>                ///< Do czujników i godzin z agregatami do przeliczenia.
+#include "historyrollups.h"    ///< Do agregatów godzinowych, dobowych i miesięcznych.
+#include "seriescodec.h"       ///< Do zwartego kodowania rekordów.
+
+/**
+ * @class HistoryStore
+ * @brief Magazyn danych historycznych zapisywany do plików segmentów w trybie tylko-dopisywania.
+ *
+ * Każdy zapis dodaje jeden rekord (sensorId, dateKey) na końcu aktywnego segmentu, więc jego koszt
+ * zależy tylko od rozmiaru nowego rekordu. Nieaktualne rekordy są usuwane przez kompaktowanie
+ * zamkniętych segmentów w wątku roboczym.
+ *
+ * Indeks (sensorId -> posortowane klucze dat -> przesunięcie i długość rekordu) jest zapisywany
+ * w pliku pomocniczym index.dat. Przy otwarciu odczytywane są tylko rekordy dopisane po ostatnim
+ * zapisie indeksu; brakujący lub uszkodzony indeks jest odbudowywany z segmentów.
+ *
+ * Zamknięte segmenty są odczytywane przez mapowanie pamięci: pobranie rekordu dotyka tylko
+ * stron, na których leży jego ramka, więc zużycie pamięci nie rośnie z rozmiarem historii.
+ *
+ * Każdy zapis aktualizuje agregaty godzinowe, dobowe i miesięczne czujnika (HistoryRollups), więc zapytania
+ * o długie okresy czytają kilkaset agregatów zamiast wszystkich rekordów. Godziny, których agregatów nie da
+ * się zaktualizować przyrostowo (zmiana zamkniętej godziny, usunięcie rekordu), są przeliczane raz na
+ * operację z rekordów czujnika o kluczach daty od tej godziny. Agregaty są zapisywane w pliku rollups.dat
+ * przy zamknięciu, po kompaktowaniu i w flush(); rekordy dopisane później są do nich dodawane przy otwarciu.
+ *
+ * Treść rekordu jest kodowana przez SeriesCodec (delta-of-delta czasu, XOR wartości, qCompress); rekordy
+ * zapisane wcześniej jako JSON są odczytywane bez zmian.
+ *
+ * Otwarty magazyn trzyma blokadę store.lock (QLockFile) w swoim katalogu, więc drugi proces (np. tryb
+ * --collect przy działającej aplikacji) nie otworzy go i nie dopisze ramek do tego samego segmentu.
+ * Blokada procesu, który się zakończył, jest przejmowana.
+ */
+class HistoryStore : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Położenie ramki rekordu w pliku segmentu.
+    struct RecordLocation {
+        int segmentId = 0;  ///< Numer segmentu.
+        qint64 offset = 0;  ///< Przesunięcie ramki w pliku.
+        qint64 length = 0;  ///< Długość całej ramki (nagłówek + treść).
+
+        bool operator==(const RecordLocation& other) const
+        {
+            return segmentId == other.segmentId && offset == other.offset && length == other.length;
+        }
+        bool operator!=(const RecordLocation& other) const { return !(*this == other); }
+    };
+
+    /// Rekord zapisywany w paczce, przygotowany w wątku roboczym (prepareBatchRecord).
+    struct BatchRecord {
+        int sensorId = 0;          ///< ID czujnika.
+        QString dateKey;           ///< Klucz daty.
+        QByteArray payload;        ///< Zakodowana treść rekordu.
+        QByteArray frame;          ///< Ramka dla sensorId i dateKey (pusta, jeśli klucz zmieniono po przygotowaniu).
+        MeasurementSeries series;  ///< Punkty rekordu (do agregatów).
+    };
+
+    /// Konstruktor, przyjmuje katalog segmentów i opcjonalnego rodzica.
+    explicit HistoryStore(const QString& directory, QObject *parent = nullptr);
+    /// Destruktor, czeka na zakończenie kompaktowania, zapisuje indeks i agregaty i zamyka aktywny segment.
+    ~HistoryStore();
+
+    /// Otwiera magazyn: odtwarza przerwane kompaktowanie i buduje indeks z segmentów.
+    bool open();
+    /// Informuje, czy magazyn jest otwarty.
+    bool isOpen() const;
+    /// Informuje, czy magazyn nie zawiera żadnych rekordów.
+    bool isEmpty() const;
+    /// Zwraca katalog segmentów.
+    QString directory() const;
+    /// Zwraca opis ostatniego błędu.
+    QString errorString() const;
+    /// Zapisuje niezapisane zmiany indeksu i agregatów (np. po cyklu zbierania).
+    bool flush();
+
+    /// Dopisuje rekord dla czujnika i klucza daty (nadpisuje poprzedni o tym samym kluczu).
+    bool put(int sensorId, const QString& dateKey, const QJsonObject& data);
+    /// Dopisuje rekord z gotowego szeregu i metadanych (bez budowania tablicy JSON).
+    bool putSeries(int sensorId, const QString& dateKey, const MeasurementSeries& series, const QJsonObject& metadata);
+    /// Dopisuje wszystkie rekordy jednym zapisem; przy błędzie nie zapisuje żadnego.
+    bool putBatch(const QVector<BatchRecord>& records);
+    /// Koduje treść i ramkę rekordu paczki oraz buduje jego szereg (bezpieczne w wątku roboczym).
+    static BatchRecord prepareBatchRecord(int sensorId, const QString& dateKey, const QJsonObject& data,
+                                          const SeriesCodec::Options& options);
+    /// Odczytuje rekord dla czujnika i klucza daty; pusty obiekt, jeśli brak.
+    QJsonObject get(int sensorId, const QString& dateKey) const;
+    /// Zwraca zakodowaną treść rekordu (SeriesCodec lub JSON); pusta tablica, jeśli brak.
+    QByteArray payload(int sensorId, const QString& dateKey) const;
+    /// Odczytuje szereg rekordu bez budowania tablicy JSON; pusty szereg, jeśli brak.
+    MeasurementSeries series(int sensorId, const QString& dateKey) const;
+    /// Ustawia kodowanie nowych rekordów.
+    void setCodecOptions(const SeriesCodec::Options& options);
+    /// Zwraca kodowanie nowych rekordów (np. dla rekordów paczki przygotowywanych w wątku roboczym).
+    SeriesCodec::Options codecSettings() const { return codecOptions; }
+    /// Sprawdza, czy istnieje rekord dla czujnika i klucza daty.
+    bool contains(int sensorId, const QString& dateKey) const;
+    /// Zwraca posortowane klucze dat zapisane dla czujnika.
+    QStringList dateKeys(int sensorId) const;
+    /// Zwraca ID czujników, które mają zapisane rekordy.
+    QList<int> sensorIds() const;
+    /// Usuwa rekord czujnika o podanym kluczu daty.
+    bool remove(int sensorId, const QString& dateKey);
+    /// Usuwa rekordy o podanym kluczu daty dla wszystkich czujników; zwraca ich liczbę.
+    int removeDateKey(const QString& dateKey);
+    /// Przenosi dane ze starego pliku air_quality_history.json; zwraca liczbę rekordów.
+    int importLegacyFile(const QString& legacyPath);
+    /// Zwraca agregaty czujnika z poziomu i zakresu czasu (ms od epoki, włącznie).
+    QVector<HistoryRollups::Bucket> rollups(int sensorId, HistoryRollups::Tier tier, qint64 fromMs, qint64 toMs) const;
+    /// Zwraca kopię agregatów do odczytu w wątku roboczym (współdzieloną do pierwszej zmiany).
+    HistoryRollups rollupsSnapshot() const;
+
+    /// Sprawdza, czy zamknięte segmenty zawierają dość nieaktualnych danych do kompaktowania.
+    bool needsCompaction() const;
+    /// Uruchamia kompaktowanie zamkniętych segmentów w tle; false, jeśli nie ma czego kompaktować.
+    bool compactInBackground();
+    /// Informuje, czy kompaktowanie jest w toku.
+    bool isCompacting() const;
+
+signals:
+    /// Informuje o zakończeniu kompaktowania i liczbie odzyskanych bajtów.
+    void compactionFinished(bool success, qint64 reclaimedBytes);
+
+private:
+    /// Typ rekordu w segmencie.
+    enum RecordType : quint8 {
+        PutRecord = 1,    ///< Zapis danych.
+        DeleteRecord = 2  ///< Znacznik usunięcia.
+    };
+
+    /// Przeniesienie rekordu w wyniku kompaktowania.
+    struct RecordMove {
+        int sensorId = 0;
+        QString dateKey;
+        RecordLocation from;
+        RecordLocation to;
+    };
+
+    /// Zmapowany w pamięci zamknięty segment.
+    struct MappedSegment {
+        QFile* file = nullptr;        ///< Otwarty plik segmentu.
+        const uchar* data = nullptr;  ///< Początek mapowania.
+        qint64 size = 0;              ///< Rozmiar mapowania.
+    };
+
+    /// Wynik kompaktowania zwracany z wątku roboczego.
+    struct CompactionResult {
+        bool success = false;
+        QString error;
+        int targetSegmentId = 0;
+        QList<int> sourceSegments;
+        QList<RecordMove> moves;
+        qint64 reclaimedBytes = 0;
+        qint64 targetSize = 0;
+    };
+
+    /// Maksymalny rozmiar aktywnego segmentu przed zamknięciem (bajty).
+    static constexpr qint64 SEGMENT_MAX_BYTES = 4 * 1024 * 1024;
+    /// Minimalna ilość nieaktualnych danych uzasadniająca kompaktowanie (bajty).
+    static constexpr qint64 COMPACTION_MIN_DEAD_BYTES = 1024 * 1024;
+    /// Liczba zmian indeksu, po której jest on zapisywany na dysk.
+    static constexpr int INDEX_SAVE_THRESHOLD = 32;
+
+    /// Zwraca ścieżkę do pliku segmentu.
+    QString segmentPath(int segmentId) const;
+    /// Zwraca ścieżkę do pliku tymczasowego kompaktowania.
+    QString compactPath(int segmentId) const;
+    /// Zwraca posortowaną listę numerów segmentów w katalogu.
+    QList<int> listSegments() const;
+    /// Zwraca ścieżkę do pliku indeksu.
+    QString indexPath() const;
+    /// Zwraca ścieżkę do pliku agregatów.
+    QString rollupsPath() const;
+    /// Sprawdza, czy pokryte rozmiary segmentów opisują początek obecnych segmentów.
+    bool coversLiveSegments(const QMap<int, qint64>& coveredBytes, const QList<int>& liveSegments) const;
+    /// Kończy lub wycofuje kompaktowanie przerwane zamknięciem programu; true, jeśli zmieniono pliki.
+    bool recoverInterruptedCompaction();
+    /// Odczytuje rekordy segmentu nieobjęte indeksem lub agregatami i aktualizuje je.
+    bool scanSegment(int segmentId, qint64 indexFrom, qint64 rollupsFrom, bool isLast);
+    /// Wczytuje indeks z pliku; zwraca pokryte rozmiary segmentów.
+    bool loadIndex(QMap<int, qint64>* coveredBytes);
+    /// Zapisuje indeks do pliku.
+    bool saveIndex();
+    /// Zapisuje indeks, jeśli zebrało się dość niezapisanych zmian.
+    void maybeSaveIndex();
+    /// Otwiera (lub tworzy) aktywny segment do dopisywania.
+    bool openActiveSegment(int segmentId);
+    /// Dopisuje ramkę rekordu do aktywnego segmentu.
+    bool appendRecord(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload, RecordLocation* location);
+    /// Aktualizuje indeks i liczniki po zapisie lub usunięciu rekordu.
+    void applyRecord(quint8 type, int sensorId, const QString& dateKey, const RecordLocation& location);
+    /// Usuwa rekord bez przeliczania agregatów (godziny rekordu są oznaczane do przeliczenia).
+    bool removeRecord(int sensorId, const QString& dateKey);
+    /// Dodaje szereg rekordu do agregatów czujnika, zbierając godziny do przeliczenia.
+    void addToRollups(int sensorId, const MeasurementSeries& series);
+    /// Oznacza godziny objęte treścią rekordu do przeliczenia.
+    void markRollupHours(int sensorId, const QByteArray& payload);
+    /// Przelicza agregaty oznaczonych czujników i godzin.
+    void updateStaleRollups();
+    /// Przelicza podane godziny czujnika z jego rekordów.
+    void recomputeRollupHours(int sensorId, const QSet<qint64>& hours);
+    /// Przelicza agregaty czujnika z jego aktualnych rekordów.
+    void rebuildRollups(int sensorId);
+    /// Zapisuje agregaty do pliku rollups.dat.
+    bool saveRollups();
+    /// Zwraca mapowanie zamkniętego segmentu, tworząc je przy pierwszym użyciu.
+    const MappedSegment* mapSegment(int segmentId) const;
+    /// Zwalnia wszystkie mapowania (przed usunięciem lub zastąpieniem segmentów).
+    void releaseMappings();
+    /// Stosuje wynik kompaktowania w wątku głównym.
+    void applyCompaction(const CompactionResult& result);
+
+    /// Buduje ramkę rekordu (nagłówek i treść).
+    static QByteArray encodeFrame(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload);
+    /// Koduje treść rekordu.
+    static QByteArray encodeBody(quint8 type, int sensorId, const QString& dateKey, const QByteArray& payload);
+    /// Dekoduje treść rekordu.
+    static bool decodeBody(const QByteArray& body, quint8* type, int* sensorId, QString* dateKey, QByteArray* payload);
+    /// Sprawdza ramkę w buforze i zwraca jej treść bez kopiowania.
+    static bool parseFrame(const char* data, qint64 available, QByteArray* body, qint64* frameLength);
+    /// Odczytuje ramkę spod bieżącej pozycji pliku; false przy końcu pliku lub uszkodzeniu.
+    static bool readFrame(QFile& file, QByteArray* body, qint64* frameLength);
+    /// Zapisuje nagłówek nowego segmentu.
+    static bool writeSegmentHeader(QFile& file, quint16 flags);
+    /// Odczytuje nagłówek segmentu.
+    static bool readSegmentHeader(QFile& file, quint16* flags);
+    /// Przepisuje aktualne rekordy zamkniętych segmentów do nowego pliku (wątek roboczy).
+    static CompactionResult runCompaction(const QString& directory, const QList<int>& segments, int targetSegmentId);
+
+    /// Katalog segmentów.
+    QString storeDirectory;
+    /// Opis ostatniego błędu.
+    QString lastError;
+    /// Czy magazyn jest otwarty.
+    bool opened;
+    /// Indeks: ID czujnika -> klucz daty -> położenie rekordu.
+    QHash<int, QMap<QString, RecordLocation>> index;
+    /// Rozmiar każdego segmentu (bajty).
+    QMap<int, qint64> segmentBytes;
+    /// Rozmiar aktualnych rekordów w każdym segmencie (bajty).
+    QMap<int, qint64> segmentLiveBytes;
+    /// Numer aktywnego segmentu.
+    int activeSegmentId;
+    /// Plik aktywnego segmentu.
+    QFile activeFile;
+    /// Liczba zmian indeksu od ostatniego zapisu.
+    int unsavedIndexChanges;
+    /// Mapowania zamkniętych segmentów według numeru.
+    mutable QHash<int, MappedSegment> mappedSegments;
+    /// Obserwator kompaktowania w tle.
+    QFutureWatcher<CompactionResult>* compactionWatcher;
+    /// Agregaty godzinowe, dobowe i miesięczne czujników.
+    HistoryRollups rollupTiers;
+    /// Czujniki, których agregaty trzeba przeliczyć w całości (usunięcie rekordu nieobecnego już w indeksie).
+    QSet<int> staleRollups;
+    /// Godziny czujników, których agregaty trzeba przeliczyć z rekordów.
+    QHash<int, QSet<qint64>> staleRollupHours;
+    /// Kodowanie nowych rekordów.
+    SeriesCodec::Options codecOptions;
+    /// Blokada katalogu magazynu (zwalniana w destruktorze).
+    QScopedPointer<QLockFile> storeLock;
+};
+
+#endif // HISTORYSTORE_H
@@ -0,0 +1,195 @@
+#ifndef JSONSTREAMPARSER_H
+#define JSONSTREAMPARSER_H
+
+/**
+ * @file jsonstreamparser.h
+ * @brief Plik nagłówkowy dla szablonu JsonStreamParser, parsowania strumienia odpowiedzi JSON poza wątkiem GUI.
+ */
+
+#include <QObject>
+#include <QByteArray>
+#include <QFutureWatcher>       ///< Do odbioru sparsowanych paczek w wątku głównym.
+#include <QtConcurrent>         ///< Do parsowania w puli wątków.
+#include <QJsonArray>           ///< Do paczek elementów dla wątku głównego.
+#include <QJsonDocument>        ///< Do parsowania elementów i szkieletu.
+#include <QJsonObject>          ///< Do sparsowanych elementów.
+#include <QList>                ///< Do fragmentów czekających na parsowanie.
+#include <QSharedPointer>       ///< Do stanu współdzielonego z zadaniem w puli wątków.
+#include <functional>           ///< Do funkcji budujących wynik.
+#include "jsonstreamsplitter.h" ///< Do wydzielania elementów ze strumienia.
+
+/**
+ * @class JsonStreamParser
+ * @brief Dzieli i parsuje kolejne fragmenty odpowiedzi w puli wątków, budując wynik element po elemencie.
+ *
+ * Wątek GUI tylko dopisuje fragmenty do kolejki (feed); JsonStreamSplitter, QJsonDocument::fromJson
+ * elementów i funkcja append działają w zadaniu QtConcurrent, które przejmuje wszystkie fragmenty
+ * czekające w kolejce. W danej chwili działa co najwyżej jedno zadanie, więc fragmenty są parsowane
+ * po kolei. Nowe elementy wracają do wątku GUI paczkami (po jednej na zadanie) przez QFutureWatcher,
+ * a po finish() funkcja complete dopełnia wynik w puli wątków (np. buduje indeksy).
+ * Usunięcie obiektu porzuca wynik; zadanie w toku kończy się na własnej kopii stanu.
+ */
+template <typename Result>
+class JsonStreamParser : public QObject
+{
+public:
+    /// Dopisuje sparsowany element do wyniku (pula wątków).
+    using Append = std::function<void(Result*, const QJsonObject&)>;
+    /// Dopełnia wynik na podstawie szkieletu dokumentu; false oznacza niepoprawną odpowiedź (pula wątków).
+    using Complete = std::function<bool(Result*, const QJsonDocument&)>;
+    /// Odbiera nowe elementy (wątek GUI).
+    using BatchHandler = std::function<void(const QJsonArray&)>;
+    /// Odbiera wynik po zakończeniu strumienia (wątek GUI).
+    using FinishHandler = std::function<void(bool, const Result&)>;
+
+    /**
+     * @brief Konstruktor.
+     * @param elementDepth Głębokość tablicy z elementami (jak w JsonStreamSplitter).
+     * @param append Funkcja dopisująca element do wyniku.
+     * @param complete Funkcja dopełniająca wynik po ostatnim elemencie.
+     * @param parent Obiekt nadrzędny w wątku GUI.
+     */
+    JsonStreamParser(int elementDepth, const Append& append, const Complete& complete, QObject* parent = nullptr)
+        : QObject(parent), state(new State{JsonStreamSplitter(elementDepth), Result(), append, complete}),
+          watcher(new QFutureWatcher<Drained>(this))
+    {
+        QObject::connect(watcher, &QFutureWatcher<Drained>::finished, this, [this]() {
+            onDrained(watcher->result());
+        });
+    }
+
+    /**
+     * @brief Ustawia odbiorcę nowych elementów (przed pierwszym fragmentem).
+     * @param handler Funkcja wywoływana w wątku GUI z paczką nowych elementów.
+     */
+    void setBatchHandler(const BatchHandler& handler) { onBatch = handler; }
+
+    /**
+     * @brief Dopisuje fragment do kolejki i uruchamia parsowanie, jeśli nie trwa.
+     * @param chunk Kolejne bajty odpowiedzi.
+     */
+    void feed(const QByteArray& chunk)
+    {
+        if (finishing || chunk.isEmpty()) {
+            return;
+        }
+        pending.append(chunk);
+        startDrain();
+    }
+
+    /**
+     * @brief Kończy strumień; handler dostanie wynik po sparsowaniu fragmentów z kolejki.
+     * @param handler Funkcja wywoływana w wątku GUI (ok = dokument kompletny i poprawny).
+     */
+    void finish(const FinishHandler& handler)
+    {
+        if (finishing) {
+            return;
+        }
+        finishing = true;
+        onFinished = handler;
+        startDrain();
+    }
+
+private:
+    /// Stan parsowania używany wyłącznie przez bieżące zadanie w puli wątków.
+    struct State {
+        JsonStreamSplitter splitter; ///< Wydziela elementy.
+        Result result;               ///< Wynik budowany element po elemencie.
+        Append append;               ///< Dopisuje element do wyniku.
+        Complete complete;           ///< Dopełnia wynik.
+    };
+    /// Wynik jednego zadania parsowania.
+    struct Drained {
+        QJsonArray batch;            ///< Nowe elementy (tylko przy odbiorcy paczek).
+        bool done = false;           ///< Czy było to ostatnie zadanie strumienia.
+        bool ok = false;             ///< Czy dokument był kompletny i poprawny.
+        Result result;               ///< Wynik (tylko w ostatnim zadaniu).
+    };
+
+    /**
+     * @brief Uruchamia zadanie dla fragmentów z kolejki, jeśli poprzednie się zakończyło.
+     */
+    void startDrain()
+    {
+        if (watcher->isRunning() || finalStarted || (pending.isEmpty() && !finishing)) {
+            return;
+        }
+        const QSharedPointer<State> shared = state;
+        const QList<QByteArray> chunks = pending;
+        const bool last = finishing;
+        const bool collect = bool(onBatch);
+        pending.clear();
+        finalStarted = last;
+        watcher->setFuture(QtConcurrent::run([shared, chunks, last, collect]() {
+            return drain(shared, chunks, last, collect);
+        }));
+    }
+
+    /**
+     * @brief Parsuje fragmenty w puli wątków; w ostatnim zadaniu dopełnia i oddaje wynik.
+     * @param shared Stan parsowania.
+     * @param chunks Fragmenty w kolejności odbioru.
+     * @param last Czy strumień jest zakończony.
+     * @param collect Czy zbierać nowe elementy dla wątku GUI.
+     * @return Paczka nowych elementów i ewentualny wynik.
+     */
+    static Drained drain(const QSharedPointer<State>& shared, const QList<QByteArray>& chunks, bool last, bool collect)
+    {
+        Drained drained;
+        for (const QByteArray& chunk : chunks) {
+            for (const QByteArray& element : shared->splitter.feed(chunk)) {
+                const QJsonObject object = QJsonDocument::fromJson(element).object();
+                shared->append(&shared->result, object);
+                if (collect) {
+                    drained.batch.append(object);
+                }
+            }
+        }
+        if (last) {
+            drained.done = true;
+            drained.ok = shared->splitter.isComplete() && !shared->splitter.hasError();
+            if (drained.ok) {
+                const QJsonDocument skeleton = QJsonDocument::fromJson(shared->splitter.skeleton());
+                drained.ok = !skeleton.isNull() && shared->complete(&shared->result, skeleton);
+            }
+            drained.result = std::move(shared->result);
+        }
+        return drained;
+    }
+
+    /**
+     * @brief Przekazuje wynik zadania w wątku GUI i uruchamia kolejne.
+     * @param drained Wynik zadania.
+     */
+    void onDrained(const Drained& drained)
+    {
+        if (!drained.batch.isEmpty() && onBatch) {
+            onBatch(drained.batch);
+        }
+        if (drained.done) {
+            if (onFinished) {
+                onFinished(drained.ok, drained.result);
+            }
+            return;
+        }
+        startDrain();
+    }
+
+    /// Stan współdzielony z zadaniem w puli wątków.
+    QSharedPointer<State> state;
+    /// Obserwator bieżącego zadania.
+    QFutureWatcher<Drained>* watcher;
+    /// Fragmenty czekające na parsowanie.
+    QList<QByteArray> pending;
+    /// Odbiorca nowych elementów.
+    BatchHandler onBatch;
+    /// Odbiorca wyniku.
+    FinishHandler onFinished;
+    /// Czy wywołano finish().
+    bool finishing = false;
+    /// Czy uruchomiono ostatnie zadanie.
+    bool finalStarted = false;
+};
+
+#endif // JSONSTREAMPARSER_H
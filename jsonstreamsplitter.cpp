@@ -0,0 +1,111 @@
+#include "jsonstreamsplitter.h"
+
+/**
+ * @file jsonstreamsplitter.cpp
+ * @brief Implementacja klasy JsonStreamSplitter, przyrostowego dzielenia strumienia JSON na elementy.
+ */
+
+/**
+ * @brief Konstruktor klasy JsonStreamSplitter.
+ * @param elementDepth Głębokość tablicy, której elementy są wydzielane (1 = tablica główna).
+ */
+JsonStreamSplitter::JsonStreamSplitter(int elementDepth)
+    : elementDepth(elementDepth)
+{
+    reset();
+}
+
+/**
+ * @brief Przywraca stan początkowy.
+ */
+void JsonStreamSplitter::reset()
+{
+    containers.clear();
+    element.clear();
+    skeletonBytes.clear();
+    inElement = false;
+    inString = false;
+    escaped = false;
+    complete = false;
+    error = false;
+}
+
+/**
+ * @brief Przetwarza fragment danych.
+ * Napisy są przepisywane bez interpretacji (z obsługą \\"), białe znaki poza napisami są pomijane,
+ * a przecinki między wydzielanymi elementami usuwane, więc szkielet pozostaje poprawnym JSON-em.
+ * @param chunk Kolejne bajty dokumentu.
+ * @return Kompletne elementy zakończone w tym fragmencie.
+ */
+QVector<QByteArray> JsonStreamSplitter::feed(const QByteArray& chunk)
+{
+    QVector<QByteArray> elements;
+    for (const char c : chunk) {
+        if (error) {
+            break;
+        }
+        QByteArray& target = inElement ? element : skeletonBytes;
+        if (inString) {
+            target.append(c);
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                inString = false;
+            }
+            continue;
+        }
+        const bool atElementLevel = !inElement && containers.size() == elementDepth && containers.last();
+        switch (c) {
+        case '"':
+            inString = true;
+            target.append(c);
+            break;
+        case '{':
+        case '[':
+            if (complete) {
+                error = true;
+                break;
+            }
+            if (atElementLevel) {
+                inElement = true;
+                element.append(c);
+            } else {
+                target.append(c);
+            }
+            containers.append(c == '[');
+            break;
+        case '}':
+        case ']':
+            if (containers.isEmpty() || containers.last() != (c == ']')) {
+                error = true;
+                break;
+            }
+            containers.removeLast();
+            target.append(c);
+            if (inElement && containers.size() == elementDepth) {
+                elements.append(element);
+                element.clear();
+                inElement = false;
+            }
+            if (containers.isEmpty()) {
+                complete = true;
+            }
+            break;
+        case ',':
+            if (!atElementLevel) {
+                target.append(c);
+            }
+            break;
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+        default:
+            target.append(c);
+        }
+    }
+    return elements;
+}
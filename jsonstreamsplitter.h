@@ -0,0 +1,60 @@
+#ifndef JSONSTREAMSPLITTER_H
+#define JSONSTREAMSPLITTER_H
+
+/**
+ * @file jsonstreamsplitter.h
+ * @brief Plik nagłówkowy dla klasy JsonStreamSplitter, przyrostowego dzielenia strumienia JSON na elementy.
+ */
+
+#include <QByteArray>
+#include <QVector>             ///< Do listy gotowych elementów i stosu zagnieżdżeń.
+
+/**
+ * @class JsonStreamSplitter
+ * @brief Przyrostowy tokenizer JSON wydzielający kolejne elementy tablicy z danymi w miarę nadchodzenia bajtów.
+ *
+ * Dane są podawane fragmentami (np. z QNetworkReply::readyRead). Każdy kompletny obiekt lub tablica
+ * będąca elementem tablicy na głębokości elementDepth jest zwracana jako osobny, mały dokument JSON
+ * (głębokość 1: elementy tablicy głównej, np. station/findAll; głębokość 2: np. "values" w getData).
+ * Pozostała część dokumentu (szkielet, np. {"key":"PM10","values":[]}) jest zbierana osobno.
+ * W pamięci jest tylko bieżący, niedokończony element, a nie cały dokument DOM.
+ */
+class JsonStreamSplitter
+{
+public:
+    /// Konstruktor, przyjmuje głębokość tablicy, której elementy mają być wydzielane.
+    explicit JsonStreamSplitter(int elementDepth = 1);
+
+    /// Przetwarza kolejny fragment danych; zwraca elementy zakończone w tym fragmencie.
+    QVector<QByteArray> feed(const QByteArray& chunk);
+    /// Zwraca dokument bez wydzielonych elementów.
+    QByteArray skeleton() const { return skeletonBytes; }
+    /// Informuje, czy dokument główny został zamknięty.
+    bool isComplete() const { return complete; }
+    /// Informuje, czy napotkano niepoprawną strukturę (np. niedomknięty nawias).
+    bool hasError() const { return error; }
+    /// Przywraca stan początkowy.
+    void reset();
+
+private:
+    /// Głębokość tablicy z elementami.
+    int elementDepth;
+    /// Stos otwartych kontenerów (true = tablica).
+    QVector<bool> containers;
+    /// Bajty bieżącego, niedokończonego elementu.
+    QByteArray element;
+    /// Szkielet dokumentu bez wydzielonych elementów.
+    QByteArray skeletonBytes;
+    /// Czy bieżący znak należy do elementu.
+    bool inElement;
+    /// Czy jesteśmy wewnątrz napisu.
+    bool inString;
+    /// Czy poprzedni znak w napisie był ukośnikiem wstecznym.
+    bool escaped;
+    /// Czy dokument główny został zamknięty.
+    bool complete;
+    /// Czy wystąpił błąd struktury.
+    bool error;
+};
+
+#endif // JSONSTREAMSPLITTER_H
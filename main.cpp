@@ -1,13 +1,195 @@
 #include <QApplication>        ///< Biblioteka do tworzenia aplikacji Qt.
 #include <QQmlApplicationEngine> ///< Biblioteka do obsługi silnika QML.
 #include <QQmlContext>         ///< Biblioteka do przekazywania danych do QML.
+#include <QCoreApplication>    ///< Biblioteka do aplikacji bez interfejsu (tryb zbierania danych).
+#include <QCommandLineParser>  ///< Biblioteka do opcji linii poleceń.
+#include <QStandardPaths>      ///< Biblioteka do znajdowania standardowych ścieżek.
+#include <QThreadPool>         ///< Biblioteka do ustawienia rozmiaru puli wątków.
+#include <QElapsedTimer>       ///< Biblioteka do pomiaru czasu w teście wydajności.
+#include <QRandomGenerator>    ///< Biblioteka do danych testu wydajności.
+#include <QVector>             ///< Biblioteka do kolumn testu wydajności.
+#include <QDebug>              ///< Biblioteka do wypisywania wyników testu wydajności.
+#include <QTimer>              ///< Biblioteka do sprawdzania żądania zatrzymania trybu zbierania.
+#include <csignal>             ///< Biblioteka do obsługi SIGINT/SIGTERM w trybie zbierania.
+#include <cstring>             ///< Biblioteka do porównywania argumentów.
+#include <cmath>               ///< Biblioteka do porównania wyników wariantów.
+#include "statskernels.h"      ///< Plik nagłówkowy dla wektorowych statystyk (test wydajności).
 #include "mainwindow.h"        ///< Plik nagłówkowy dla klasy MainWindow.
+#include "stationcollector.h"  ///< Plik nagłówkowy dla trybu zbierania danych bez GUI.
 
 /**
  * @file main.cpp
  * @brief Główny plik programu, inicjalizujący aplikację Qt i ładujący interfejs QML.
+ *
+ * Z opcją --collect program działa bez interfejsu (np. na serwerze) i cyklicznie zbiera pomiary
+ * wszystkich stacji do magazynu historii. Opcja --bench-stats mierzy czas wariantów StatsKernels.
  */
 
+/**
+ * @brief Ustawia nazwy organizacji i aplikacji (wyznaczają katalog danych w obu trybach).
+ * @param app Obiekt aplikacji.
+ */
+static void setApplicationNames(QCoreApplication& app)
+{
+    /// Ustawia nazwę organizacji dla aplikacji.
+    app.setOrganizationName("JPOGIOS");
+    /// Ustawia domenę organizacji dla ustawień aplikacji.
+    app.setOrganizationDomain("jpo.example.com");
+    /// Ustawia nazwę aplikacji.
+    app.setApplicationName("MonitorJakosciPowietrza");
+}
+
+/// Ustawiane przez obsługę SIGINT/SIGTERM, sprawdzane w pętli zdarzeń trybu zbierania.
+static volatile std::sig_atomic_t stopRequested = 0;
+
+/**
+ * @brief Obsługuje SIGINT/SIGTERM; tylko zapamiętuje żądanie, bo w obsłudze sygnału nie wolno wołać Qt.
+ * @param signal Numer sygnału.
+ */
+static void requestStop(int signal)
+{
+    Q_UNUSED(signal);
+    stopRequested = 1;
+}
+
+/**
+ * @brief Uruchamia tryb zbierania danych bez interfejsu.
+ * Zatrzymanie (Ctrl+C, SIGTERM od menedżera usług) kończy pętlę zdarzeń, więc destruktor magazynu
+ * historii zapisuje indeks i agregaty.
+ * @param argc Liczba argumentów linii poleceń.
+ * @param argv Tablica argumentów linii poleceń.
+ * @return Kod wyjścia programu.
+ */
+static int runCollector(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    setApplicationNames(app);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Zbieranie pomiarów wszystkich stacji GIOŚ do magazynu historii.");
+    parser.addHelpOption();
+    parser.addOption({"collect", "Tryb zbierania danych bez interfejsu."});
+    parser.addOption({"interval", "Odstęp między cyklami w minutach (0 = jeden cykl).", "minuty", "60"});
+    parser.addOption({"connections", "Limit równoległych połączeń z API.", "liczba", "8"});
+    parser.addOption({"threads", "Liczba wątków parsowania (domyślnie liczba rdzeni).", "liczba"});
+    parser.addOption({"data-dir", "Katalog danych (domyślnie ten sam co w aplikacji z GUI).", "katalog"});
+    parser.addOption({"compression", "Poziom kompresji rekordów historii 0-9 (0 = bez kompresji).", "poziom", "6"});
+    parser.addOption({"json-records", "Zapisuje rekordy historii jako zwarty JSON zamiast kodowania kolumnowego."});
+    parser.process(app);
+
+    if (parser.isSet("threads")) {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, parser.value("threads").toInt()));
+    }
+    const QString dataDir = parser.isSet("data-dir")
+        ? parser.value("data-dir")
+        : QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/data";
+    const int interval = qMax(0, parser.value("interval").toInt());
+
+    StationCollector collector(dataDir + "/history", parser.value("connections").toInt());
+    SeriesCodec::Options codecOptions;
+    codecOptions.columnar = !parser.isSet("json-records");
+    codecOptions.compressionLevel = qBound(0, parser.value("compression").toInt(), 9);
+    collector.setCodecOptions(codecOptions);
+    if (interval == 0) {
+        QObject::connect(&collector, &StationCollector::cycleFinished, &app, [&app](int, int, int, int failed) {
+            app.exit(failed > 0 ? 2 : 0);
+        });
+    }
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    QTimer stopTimer;
+    QObject::connect(&stopTimer, &QTimer::timeout, &app, [&app]() {
+        if (stopRequested) {
+            qDebug() << "Zatrzymano zbieranie danych";
+            app.quit();
+        }
+    });
+    stopTimer.start(200);
+    if (!collector.start(interval)) {
+        return 1;
+    }
+    return app.exec();
+}
+
+/**
+ * @brief Mierzy czas wariantów StatsKernels (skalarny, SSE2, AVX2) na tym samym buforze.
+ * Wypisuje najlepszy czas z kilku powtórzeń i sprawdza, czy warianty dają ten sam wynik.
+ * @param argc Liczba argumentów linii poleceń.
+ * @param argv Tablica argumentów linii poleceń.
+ * @return Kod wyjścia programu (1, jeśli wyniki wariantów się różnią).
+ */
+static int runStatsBenchmark(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    setApplicationNames(app);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Test wydajności statystyk historii (StatsKernels).");
+    parser.addHelpOption();
+    parser.addOption({"bench-stats", "Tryb testu wydajności statystyk."});
+    parser.addOption({"points", "Liczba punktów w buforze.", "liczba", "10000000"});
+    parser.addOption({"repeat", "Liczba powtórzeń każdego wariantu.", "liczba", "5"});
+    parser.addOption({"null-ratio", "Udział braków pomiaru (0-1).", "udział", "0.05"});
+    parser.process(app);
+
+    const int size = qMax(1, parser.value("points").toInt());
+    const int repeat = qMax(1, parser.value("repeat").toInt());
+    const double nullRatio = qBound(0.0, parser.value("null-ratio").toDouble(), 1.0);
+    const float threshold = 50.0f;
+
+    /// Stałe ziarno: każdy wariant i każde uruchomienie liczy ten sam bufor.
+    QRandomGenerator random(2024);
+    QVector<float> values(size);
+    QVector<quint64> nullMask((size + 63) / 64, 0);
+    for (int i = 0; i < size; ++i) {
+        values[i] = float(5.0 + 80.0 * random.generateDouble());
+        if (random.generateDouble() < nullRatio) {
+            nullMask[i >> 6] |= quint64(1) << (i & 63);
+        }
+    }
+
+    QVector<StatsKernels::Implementation> implementations = {StatsKernels::Implementation::Scalar};
+    if (StatsKernels::bestImplementation() != StatsKernels::Implementation::Scalar) {
+        implementations.append(StatsKernels::Implementation::Sse2);
+    }
+    if (StatsKernels::bestImplementation() == StatsKernels::Implementation::Avx2) {
+        implementations.append(StatsKernels::Implementation::Avx2);
+    }
+
+    qDebug().noquote() << "Punkty:" << size << "braki:" << nullRatio << "powtórzenia:" << repeat;
+    StatsKernels::Summary reference;
+    qint64 scalarNs = 0;
+    bool consistent = true;
+    for (StatsKernels::Implementation implementation : implementations) {
+        StatsKernels::Summary summary;
+        qint64 bestNs = -1;
+        for (int r = 0; r < repeat; ++r) {
+            QElapsedTimer timer;
+            timer.start();
+            summary = StatsKernels::summarize(values.constData(), nullMask.constData(), size, threshold, implementation);
+            const qint64 elapsed = timer.nsecsElapsed();
+            bestNs = bestNs < 0 ? elapsed : qMin(bestNs, elapsed);
+        }
+        if (implementation == StatsKernels::Implementation::Scalar) {
+            reference = summary;
+            scalarNs = bestNs;
+        } else if (summary.count != reference.count || summary.exceedances != reference.exceedances
+                   || summary.min != reference.min || summary.max != reference.max
+                   || std::abs(summary.mean() - reference.mean()) > 1e-6 * std::abs(reference.mean()) + 1e-9) {
+            consistent = false;
+        }
+        qDebug().noquote() << StatsKernels::implementationName(implementation) << ":" << bestNs / 1000000.0 << "ms,"
+                           << (bestNs > 0 ? double(size) / bestNs * 1000.0 : 0.0) << "mln punktów/s, przyspieszenie"
+                           << (bestNs > 0 ? double(scalarNs) / bestNs : 0.0) << "x, średnia" << summary.mean()
+                           << "przekroczenia" << summary.exceedances;
+    }
+    if (!consistent) {
+        qDebug() << "Warianty StatsKernels dały różne wyniki";
+        return 1;
+    }
+    return 0;
+}
+
 /**
  * @brief Funkcja główna programu.
  * @param argc Liczba argumentów linii poleceń.
@@ -16,15 +198,19 @@
  */
 int main(int argc, char *argv[])
 {
+    /// Tryb bez interfejsu nie tworzy QApplication, więc nie wymaga ekranu.
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--collect") == 0) {
+            return runCollector(argc, argv);
+        }
+        if (std::strcmp(argv[i], "--bench-stats") == 0) {
+            return runStatsBenchmark(argc, argv);
+        }
+    }
+
     /// Tworzy obiekt aplikacji Qt z argumentami linii poleceń.
     QApplication app(argc, argv);
-
-    /// Ustawia nazwę organizacji dla aplikacji.
-    app.setOrganizationName("JPOGIOS");
-    /// Ustawia domenę organizacji dla ustawień aplikacji.
-    app.setOrganizationDomain("jpo.example.com");
-    /// Ustawia nazwę aplikacji.
-    app.setApplicationName("MonitorJakosciPowietrza");
+    setApplicationNames(app);
 
     /// Tworzy silnik do obsługi plików QML.
     QQmlApplicationEngine engine;
@@ -29,7 +29,9 @@ ApplicationWindow {
     property real maxValue: 100      //!< Maksymalna wartość pomiaru
     property real avgValue: 0        //!< Średnia wartość pomiaru
     property real stdDevValue: 0     //!< Odchylenie standardowe
-    property var measurementData: []  //!< Dane pomiarowe do wykresu
+    property bool importRunning: false //!< Czy trwa import katalogu
+    property int importDone: 0       //!< Przetworzone pliki importu
+    property int importTotal: 0      //!< Wszystkie pliki importu
 
     // Kolory używane w interfejsie
     property color primaryColor: "#98FB98"   //!< Główny kolor (zielony)
@@ -47,13 +49,15 @@ ApplicationWindow {
      * @brief Inicjalizuje połączenia sygnałów z C++ do funkcji QML po załadowaniu komponentu.
      */
     Component.onCompleted: {
-        mainWindow.stationsUpdateRequested.connect(onStationsUpdate);
         mainWindow.stationInfoUpdateRequested.connect(updateStationInfo);
         mainWindow.sensorsUpdateRequested.connect(onSensorsUpdate);
         mainWindow.measurementsUpdateRequested.connect(setMeasurementData);
         mainWindow.historicalDataListUpdated.connect(updateHistoricalDataList);
         mainWindow.statisticsUpdated.connect(updateStatistics);
+        mainWindow.importProgress.connect(onImportProgress);
+        mainWindow.importFinished.connect(onImportFinished);
         console.log("QML initialized, signal connections set up");
+        selectRestoredSensor(mainWindow.restoreSession());
     }
 
     /**
@@ -153,6 +157,39 @@ ApplicationWindow {
                 onClicked: importFileDialog.open()
             }
 
+            Button {
+                text: "Importuj katalog" //!< Przycisk do importu wszystkich plików JSON/XML z katalogu
+                Layout.fillWidth: true
+                height: 40
+                enabled: !importRunning
+                palette.button: accentColor
+                palette.buttonText: lightTextColor
+                onClicked: importFolderDialog.open()
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                visible: importRunning
+                spacing: 8
+
+                ProgressBar {
+                    Layout.fillWidth: true
+                    from: 0
+                    to: Math.max(1, importTotal)
+                    value: importDone
+                }
+
+                Label {
+                    text: Math.round(100 * importDone / Math.max(1, importTotal)) + "%"
+                    color: textColor
+                }
+
+                Button {
+                    text: "Anuluj"
+                    onClicked: mainWindow.cancelImport()
+                }
+            }
+
             Rectangle {
                 Layout.fillWidth: true
                 height: 1
@@ -247,12 +284,18 @@ ApplicationWindow {
         title: "Importuj dane"
         folder: Platform.StandardPaths.writableLocation(Platform.StandardPaths.DocumentsLocation)
         fileMode: Platform.FileDialog.OpenFile
-        nameFilters: ["JSON (*.json)", "XML (*.xml)"]
+        nameFilters: ["JSON (*.json)", "XML (*.xml)", "CSV (*.csv)"]
         onAccepted: {
             var path = file.toString().replace(/^(file:\/{2})/, "");
             if (Qt.platform.os === "windows") path = path.replace(/^\//, "");
             var format = selectedNameFilter.match(/.+\(\*\.(\w+)\)/)[1];
             var success = mainWindow.importDataFromFile(path, format);
+            if (format !== "json") {
+                // XML i CSV są importowane w tle; wynik przychodzi w onImportFinished
+                importRunning = success;
+                if (!success) showNotification("Błąd importu", true);
+                return;
+            }
             showNotification(success ? "Dane zaimportowane" : "Błąd importu", !success);
             if (success) {
                 historicalDataDialog.close();
@@ -261,6 +304,23 @@ ApplicationWindow {
         }
     }
 
+    /**
+     * @brief Okno dialogowe do wyboru katalogu do importu (pliki *.json i *.xml, z podkatalogami).
+     */
+    Platform.FolderDialog {
+        id: importFolderDialog
+        title: "Importuj katalog"
+        folder: Platform.StandardPaths.writableLocation(Platform.StandardPaths.DocumentsLocation)
+        onAccepted: {
+            var path = folder.toString().replace(/^(file:\/{2})/, "");
+            if (Qt.platform.os === "windows") path = path.replace(/^\//, "");
+            importRunning = mainWindow.importDirectory(path, "*.json *.xml", true);
+            if (!importRunning) {
+                showNotification("Brak plików do importu", true);
+            }
+        }
+    }
+
     /**
      * @brief Okno dialogowe do potwierdzenia usunięcia danych.
      */
@@ -395,6 +455,7 @@ ApplicationWindow {
                                 font.pixelSize: 14
                                 background: Rectangle { color: "transparent" }
                                 onAccepted: mainWindow.searchStations(text)
+                                onTextChanged: mainWindow.searchStations(text) //!< Wyszukiwanie w trakcie pisania
                             }
 
                             Button {
@@ -453,7 +514,7 @@ ApplicationWindow {
                             Layout.fillHeight: true
                             clip: true
                             spacing: 4
-                            model: ListModel { id: stationsModel }
+                            model: mainWindow.stationModel //!< Model C++ aktualizowany minimalnymi zmianami wierszy
 
                             delegate: Rectangle {
                                 width: ListView.view.width
@@ -466,7 +527,11 @@ ApplicationWindow {
                                     anchors.fill: parent
                                     hoverEnabled: true
                                     onClicked: {
-                                        currentStation = model.station;
+                                        currentStation = {
+                                            "stationId": model.stationId,
+                                            "stationName": model.name,
+                                            "city": model.city
+                                        };
                                         console.log("Station selected, ID:", model.stationId);
                                         mainWindow.stationSelected(model.stationId);
                                     }
@@ -485,7 +550,7 @@ ApplicationWindow {
                                     }
 
                                     Label {
-                                        text: model.display
+                                        text: model.name
                                         Layout.fillWidth: true
                                         elide: Text.ElideRight
                                         font.pixelSize: 14
@@ -502,7 +567,7 @@ ApplicationWindow {
                             font.pixelSize: 14
                             color: textColor
                             Layout.alignment: Qt.AlignCenter
-                            visible: stationsModel.count === 0
+                            visible: mainWindow.stationModel.count === 0
                         }
                     }
                 }
@@ -680,9 +745,21 @@ ApplicationWindow {
                                     backgroundColor: cardBackground
                                     animationOptions: ChartView.SeriesAnimations
 
+                                    // Po zmianie rozmiaru lub przybliżenia widoczny przedział jest ponownie decymowany w C++
+                                    onWidthChanged: chartRefreshTimer.restart()
+
+                                    Timer {
+                                        id: chartRefreshTimer
+                                        interval: 50 //!< Łączy serię zmian rozmiaru/przybliżenia w jedno odświeżenie
+                                        onTriggered: mainWindow.refreshChartSeries(lineSeries, chartView.plotArea.width,
+                                                                                   axisX.min.getTime(), axisX.max.getTime())
+                                    }
+
                                     DateTimeAxis {
                                         id: axisX
                                         format: "dd.MM HH:mm"
+                                        onMinChanged: chartRefreshTimer.restart()
+                                        onMaxChanged: chartRefreshTimer.restart()
                                         tickCount: 5
                                         labelsColor: textColor
                                         gridLineColor: borderColor
@@ -744,6 +821,8 @@ ApplicationWindow {
                                             }
                                         }
                                         onExited: tooltip.visible = false
+                                        onWheel: chartView.zoom(wheel.angleDelta.y > 0 ? 1.25 : 0.8) //!< Przybliżenie kółkiem myszy
+                                        onDoubleClicked: chartView.zoomReset() //!< Powrót do pełnego zakresu
                                     }
 
                                     Rectangle {
@@ -796,7 +875,7 @@ ApplicationWindow {
                                             Layout.fillWidth: true
                                             Layout.fillHeight: true
                                             clip: true
-                                            model: ListModel { id: dataModel }
+                                            model: mainWindow.measurementModel //!< Model C++ z wyświetlanym szeregiem
 
                                             delegate: Rectangle {
                                                 width: parent.width
@@ -941,34 +1020,6 @@ ApplicationWindow {
         }
     }
 
-    /**
-     * @brief Czyści listę stacji.
-     */
-    function clearStationsList() {
-        stationsModel.clear();
-        console.log("Stations list cleared");
-    }
-
-    /**
-     * @brief Dodaje stację do listy.
-     * @param stationId ID stacji.
-     * @param stationName Nazwa stacji.
-     * @param address Adres stacji.
-     */
-    function addStation(stationId, stationName, address) {
-        stationsModel.append({
-            "stationId": stationId,
-            "display": stationName,
-            "station": {
-                "stationId": stationId,
-                "stationName": stationName,
-                "addressStreet": address,
-                "gegrLat": "",
-                "gegrLon": ""
-            }
-        });
-    }
-
     /**
      * @brief Aktualizuje informacje o wybranej stacji.
      * @param stationId ID stacji.
@@ -1025,8 +1076,6 @@ ApplicationWindow {
      */
     function clearMeasurementData() {
         lineSeries.clear();
-        dataModel.clear();
-        measurementData = [];
         minValue = 0;
         maxValue = 100;
         avgValue = 0;
@@ -1040,16 +1089,16 @@ ApplicationWindow {
     }
 
     /**
-     * @brief Ustawia dane pomiarowe na wykresie i w tabeli.
+     * @brief Ustawia dane pomiarowe na wykresie; tabela korzysta bezpośrednio z modelu C++.
      * @param key Klucz danych.
-     * @param values Wartości pomiarowe.
+     * @param count Liczba punktów z wartością.
      */
-    function setMeasurementData(key, values) {
-        console.log("setMeasurementData called with key:", key, "values count:", values.length);
+    function setMeasurementData(key, count) {
+        console.log("setMeasurementData called with key:", key, "values count:", count);
         clearMeasurementData();
         busyIndicator.running = false;
 
-        if (!values || values.length === 0) {
+        if (count === 0) {
             statusLabel.text = "Brak danych";
             statusIcon.text = "⚠️";
             statusIcon.visible = true;
@@ -1057,53 +1106,9 @@ ApplicationWindow {
             return;
         }
 
-        var unit = currentSensor ? currentSensor.paramFormula : "";
-        var minVal = Number.MAX_VALUE;
-        var maxVal = -Number.MAX_VALUE;
-        var sum = 0;
-        var count = 0;
-        var minDate = null;
-        var maxDate = null;
-
-        measurementData = [];
-        for (var i = 0; i < values.length; i++) {
-            var dateStr = values[i].date;
-            var value = values[i].value;
-
-            if (value === null || isNaN(value) || value === undefined) {
-                console.log("Skipping invalid value at index", i, ":", value);
-                continue;
-            }
-
-            var date = new Date(dateStr);
-            if (!date || isNaN(date.getTime())) {
-                console.log("Invalid date at index", i, ":", dateStr);
-                continue;
-            }
-
-            value = parseFloat(value);
-            if (isNaN(value)) {
-                console.log("Invalid parsed value at index", i, ":", value);
-                continue;
-            }
-
-            minVal = Math.min(minVal, value);
-            maxVal = Math.max(maxVal, value);
-            sum += value;
-            count++;
-
-            if (!minDate || date < minDate) minDate = date;
-            if (!maxDate || date > maxDate) maxDate = date;
-
-            lineSeries.append(date.getTime(), value);
-            dataModel.append({
-                "date": date.toLocaleString(Qt.locale(), "dd.MM.yyyy HH:mm"),
-                "value": value
-            });
-            measurementData.push({ date: date, value: value });
-        }
-
-        if (count === 0) {
+        // Wszystkie punkty trafiają do serii jednym wywołaniem C++
+        var range = mainWindow.fillChartSeries(lineSeries, chartView.plotArea.width);
+        if (!range.count) {
             statusLabel.text = "Brak ważnych danych";
             statusIcon.text = "⚠️";
             statusIcon.visible = true;
@@ -1111,12 +1116,18 @@ ApplicationWindow {
             return;
         }
 
+        var unit = currentSensor ? currentSensor.paramFormula : "";
+        var minVal = range.minValue;
+        var maxVal = range.maxValue;
+        var minDate = new Date(range.minTime);
+        var maxDate = new Date(range.maxTime);
+
         minValue = minVal;
         maxValue = maxVal;
-        avgValue = sum / count;
+        avgValue = range.mean;
 
         // Dopasowuje osie wykresu
-        if (count === 1) {
+        if (range.count === 1) {
             axisY.min = minVal - 1;
             axisY.max = maxVal + 1;
             axisX.min = new Date(minDate.getTime() - 3600 * 1000); // 1 godzina przed
@@ -1136,19 +1147,51 @@ ApplicationWindow {
         statusIcon.visible = true;
 
         chartView.update();
-        console.log("Chart updated with", count, "valid points, minVal:", minVal, "maxVal:", maxVal);
+        console.log("Chart updated with", range.count, "valid points, minVal:", minVal, "maxVal:", maxVal);
+    }
+
+    /**
+     * @brief Zaznacza czujnik przywrócony z migawki poprzedniej sesji.
+     * @param sensorId ID czujnika (0, jeśli nic nie przywrócono).
+     */
+    function selectRestoredSensor(sensorId) {
+        for (var i = 0; i < sensorsModel.count; i++) {
+            if (sensorsModel.get(i).sensorId === sensorId) {
+                currentSensor = sensorsModel.get(i).sensor;
+                currentSensorId = sensorId;
+                console.log("Restored sensor, ID:", sensorId);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Aktualizuje postęp importu katalogu lub pliku.
+     * @param done Przetworzone pliki (lub kilobajty pliku).
+     * @param total Wszystkie pliki (lub rozmiar pliku w kilobajtach).
+     */
+    function onImportProgress(done, total) {
+        importRunning = true;
+        importDone = done;
+        importTotal = total;
     }
 
     /**
-     * @brief Aktualizuje listę stacji.
-     * @param stations Lista stacji.
+     * @brief Pokazuje wynik importu katalogu lub pliku i odświeża listę danych historycznych.
+     * @param imported Zapisane pliki.
+     * @param failed Odrzucone pliki.
+     * @param errors Opisy błędów (pierwsze z nich).
      */
-    function onStationsUpdate(stations) {
-        clearStationsList();
-        for (var i = 0; i < stations.length; i++) {
-            addStation(stations[i].id, stations[i].name, stations[i].city);
+    function onImportFinished(imported, failed, errors) {
+        importRunning = false;
+        for (var i = 0; i < errors.length; i++) {
+            console.log("Import:", errors[i]);
+        }
+        showNotification("Zaimportowano plików: " + imported + (failed > 0 ? ", odrzucono: " + failed : ""),
+                         imported === 0 && (failed > 0 || errors.length > 0));
+        if (imported > 0 && currentSensorId !== 0) {
+            mainWindow.getAvailableHistoricalData(currentSensorId);
         }
-        console.log("Stations updated:", stations.length);
     }
 
     /**
@@ -1193,6 +1236,15 @@ ApplicationWindow {
             stdDevValue = stats.stdDev;
             var unit = currentSensor ? currentSensor.paramFormula : "";
             dataAnalysisLabel.text = `Min: ${minValue.toFixed(1)} ${unit} | Max: ${maxValue.toFixed(1)} ${unit} | Śr: ${avgValue.toFixed(1)} ${unit} | Std: ${stdDevValue.toFixed(1)} ${unit}`;
+            if (stats.p95 !== undefined && stats.p95 !== null) {
+                dataAnalysisLabel.text += ` | P50: ${stats.p50.toFixed(1)} | P95: ${stats.p95.toFixed(1)} | P99: ${stats.p99.toFixed(1)}`;
+            }
+            if (stats.mean24h !== undefined && stats.mean24h !== null) {
+                dataAnalysisLabel.text += ` | Śr. 24h: ${stats.mean24h.toFixed(1)} ${unit}`;
+            }
+            if (stats.mean8h !== undefined && stats.mean8h !== null) {
+                dataAnalysisLabel.text += ` | Śr. 8h: ${stats.mean8h.toFixed(1)} ${unit}`;
+            }
             console.log("Statistics updated: min=", minValue, "max=", maxValue, "mean=", avgValue, "stdDev=", stdDevValue);
         } else {
             console.log("No statistics available");
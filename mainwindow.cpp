@@ -2,10 +2,13 @@
 #include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
 #include <QDateTime>          ///< Biblioteka do obsługi dat i czasu.
 #include <QJsonDocument>      ///< Biblioteka do pracy z danymi JSON.
-#include <QXmlStreamReader>   ///< Biblioteka do parsowania XML.
 #include <QUrl>               ///< Biblioteka do obsługi adresów URL.
 #include <QFileInfo>          ///< Biblioteka do informacji o plikach.
+#include <QElapsedTimer>      ///< Biblioteka do pomiaru czasu operacji.
 #include <cmath>              ///< Biblioteka do operacji matematycznych.
+#include <algorithm>          ///< Biblioteka do porządkowania punktów rekordu.
+#include <numeric>            ///< Biblioteka do numerowania punktów rekordu (std::iota).
+#include <queue>              ///< Biblioteka do kopca scalającego rekordy historii.
 
 /**
  * @file mainwindow.cpp
@@ -18,15 +21,25 @@
  * @param parent Opcjonalny rodzic obiektu.
  */
 MainWindow::MainWindow(QObject *parent)
-    : QObject(parent), currentSensorId(0)
+    : QObject(parent), currentSensorId(0), currentStationId(0)
 {
-    /// Tworzy managera do żądań sieciowych.
-    networkManager = new QNetworkAccessManager(this);
+    /// Tworzy dyspozytora żądań sieciowych.
+    apiDispatcher = new ApiDispatcher(API_BASE_URL, this);
+    apiDispatcher->enableDiskCache(getDataDirectory() + "/" + HTTP_CACHE_DIRNAME, HTTP_CACHE_MAX_BYTES);
+    /// Tworzy kolejkę równoległego pobierania pomiarów.
+    measurementPrefetcher = new MeasurementPrefetcher(apiDispatcher, PREFETCH_MAX_CONCURRENT, this);
+    connect(measurementPrefetcher, &MeasurementPrefetcher::measurementsFetched, this, &MainWindow::onMeasurementsFetched);
+    connect(measurementPrefetcher, &MeasurementPrefetcher::fetchFailed, this, &MainWindow::onMeasurementsFetchFailed);
     /// Ustawia timer autozapisu na 60 sekund.
     autoSaveTimer = new QTimer(this);
     autoSaveTimer->setInterval(60000);
     connect(autoSaveTimer, &QTimer::timeout, this, &MainWindow::autoSaveMeasurements);
     autoSaveTimer->start();
+    /// Tworzy modele listy stacji i tabeli pomiarów dla QML.
+    stationListModel = new StationListModel(this);
+    measurementTableModel = new MeasurementTableModel(this);
+    /// Przywraca stan ostatniej sesji, zanim odpowie API; lista stacji jest potem uzgadniana w tle.
+    loadSnapshot();
     /// Pobiera listę stacji na starcie.
     fetchStations();
 
@@ -45,113 +58,239 @@ MainWindow::MainWindow(QObject *parent)
         qDebug() << "Katalog danych już istnieje:" << dataDir;
         emit dataPathInfo("Katalog danych: " + dataDir);
     }
+
+    /// Plik JSON starszej wersji przejmuje nową nazwę; load() rozpozna format, a zapis przepisze go binarnie.
+    const QString legacyCachePath = getDataDirectory() + "/" + LEGACY_CACHE_FILENAME;
+    if (!QFile::exists(getCachePath()) && QFile::exists(legacyCachePath)) {
+        if (QFile::rename(legacyCachePath, getCachePath())) {
+            qDebug() << "Przeniesiono pamięć podręczną z:" << legacyCachePath;
+        } else {
+            qDebug() << "Nie można przenieść pamięci podręcznej z:" << legacyCachePath;
+        }
+    }
+
+    /// Wczytuje pamięć podręczną pomiarów jeden raz; dalsze odczyty nie sięgają do dysku.
+    measurementCache = new MeasurementCache(getCachePath(), CACHE_VALIDITY_HOURS * 3600, CACHE_MAX_ENTRIES, this);
+    measurementCache->setFlushInterval(CACHE_FLUSH_INTERVAL_SECONDS * 1000);
+    connect(measurementCache, &MeasurementCache::flushed, this, [this](const QString& path, bool success) {
+        if (success) {
+            emit dataPathInfo("Zapisano pamięć podręczną: " + path);
+        } else {
+            emit autoSaveStatus("Błąd zapisu pamięci podręcznej: " + path, false);
+            emit dataPathInfo("Błąd zapisu pamięci podręcznej: " + path);
+        }
+    });
+    measurementCache->load();
+
+    /// Otwiera magazyn historii i uruchamia okresowe kompaktowanie w tle.
+    openHistoryStore();
+    compactionTimer = new QTimer(this);
+    compactionTimer->setInterval(COMPACTION_INTERVAL_MINUTES * 60000);
+    connect(compactionTimer, &QTimer::timeout, this, [this]() {
+        if (historyStore->needsCompaction()) {
+            historyStore->compactInBackground();
+        }
+    });
+    compactionTimer->start();
 }
 
 /**
  * @brief Destruktor klasy MainWindow.
- * Zwalnianie zasobów jest automatyczne dzięki hierarchii Qt.
+ * Zapisuje niezapisane zmiany pamięci podręcznej i migawkę sesji; pozostałe zasoby zwalnia hierarchia Qt.
  */
 MainWindow::~MainWindow()
 {
+    measurementCache->flush();
+    saveSnapshot();
 }
 
 /**
- * @brief Zwraca ścieżkę do katalogu danych aplikacji.
- * @return Ścieżka do katalogu w standardowej lokalizacji AppData.
+ * @brief Wczytuje migawkę ostatniej sesji.
+ * Lista stacji trafia od razu do modelu i indeksów, więc interfejs jest użyteczny bez sieci.
+ * Wybrana stacja i czujnik są pokazywane w QML po wywołaniu restoreSession().
  */
-QString MainWindow::getDataDirectory()
+void MainWindow::loadSnapshot()
 {
-    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/data";
+    QElapsedTimer timer;
+    timer.start();
+    SessionSnapshot snapshot;
+    if (!snapshot.load(getDataDirectory() + "/" + SNAPSHOT_FILENAME) || snapshot.isEmpty()) {
+        return;
+    }
+    const StationsParseResult stations = ReplyParser::indexStations(snapshot.stations);
+    allStations = stations.stations;
+    stationsMap = stations.stationsMap;
+    stationSearchIndex = stations.searchIndex;
+    stationSpatialIndex = stations.spatialIndex;
+    stationListModel->setStations(allStations);
+
+    if (stationsMap.contains(snapshot.stationId)) {
+        currentStationId = snapshot.stationId;
+        sensorsMap = ReplyParser::indexSensors(snapshot.sensors).sensorsMap;
+        if (sensorsMap.contains(snapshot.sensorId)) {
+            currentSensorId = snapshot.sensorId;
+            currentSeries = snapshot.series;
+        }
+        sessionPending = true;
+    }
+    qDebug() << "Przywrócono migawkę sesji z" << snapshot.savedAt.toString(Qt::ISODate)
+             << ":" << allStations.size() << "stacji w" << timer.elapsed() << "ms";
 }
 
 /**
- * @brief Zapisuje dane pomiarowe do pliku historii w formacie JSON.
- * @param sensorId ID czujnika.
- * @param data Dane pomiarowe do zapisania.
- * @param dateKey Klucz daty dla danych.
- * @return True, jeśli zapis się powiódł; false w przeciwnym razie.
+ * @brief Zapisuje migawkę sesji, jeśli stan zmienił się od ostatniego zapisu.
+ * @return True, jeśli nie było zmian lub zapis się powiódł.
  */
-bool MainWindow::saveToHistoryFile(int sensorId, const QJsonObject& data, const QString& dateKey)
+bool MainWindow::saveSnapshot()
 {
-    QString historyPath = getDataDirectory() + "/air_quality_history.json";
-    QFile historyFile(historyPath);
-    QJsonObject history;
-
-    /// Wczytuje istniejącą historię, jeśli plik istnieje.
-    if (historyFile.exists() && historyFile.open(QIODevice::ReadOnly)) {
-        QJsonDocument doc = QJsonDocument::fromJson(historyFile.readAll());
-        if (!doc.isNull()) {
-            history = doc.object();
-        } else {
-            qDebug() << "Uszkodzony plik historii, tworzenie nowego:" << historyPath;
-            emit autoSaveStatus("Uszkodzony plik historii: " + historyPath, false);
-        }
-        historyFile.close();
+    if (!snapshotDirty || allStations.isEmpty()) {
+        return true;
     }
-
-    /// Sprawdza możliwość zapisu pliku.
-    QFileInfo fileInfo(historyPath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists() && !dir.mkpath(".")) {
-        qDebug() << "Nie można utworzyć katalogu:" << dir.path();
-        emit autoSaveStatus("Błąd: Nie można utworzyć katalogu " + dir.path(), false);
-        emit dataPathInfo("Błąd: Nie można utworzyć katalogu " + dir.path());
-        return false;
+    SessionSnapshot snapshot;
+    snapshot.stations = allStations;
+    snapshot.stationId = currentStationId;
+    for (const QJsonObject& sensor : sensorsMap) {
+        snapshot.sensors.append(sensor);
     }
-    if (!fileInfo.isWritable() && historyFile.exists()) {
-        qDebug() << "Brak uprawnień do zapisu pliku:" << historyPath;
-        emit autoSaveStatus("Błąd: Brak uprawnień do zapisu pliku " + historyPath, false);
-        emit dataPathInfo("Błąd: Brak uprawnień do zapisu pliku " + historyPath);
+    snapshot.sensorId = currentSensorId;
+    snapshot.series = currentSeries;
+    snapshot.savedAt = QDateTime::currentDateTime();
+    const QString path = getDataDirectory() + "/" + SNAPSHOT_FILENAME;
+    if (!snapshot.save(path)) {
+        emit dataPathInfo("Błąd zapisu migawki sesji: " + path);
         return false;
     }
+    snapshotDirty = false;
+    return true;
+}
 
-    /// Dodaje dane dla czujnika do historii.
-    if (!history.contains(QString::number(sensorId))) {
-        history[QString::number(sensorId)] = QJsonObject();
+/**
+ * @brief Pokazuje w QML stan przywrócony z migawki i odświeża go z API w tle.
+ * Stacja, czujniki i pomiary są wysyłane od razu; odpowiedzi API zastępują je, gdy nadejdą.
+ * @return ID przywróconego czujnika (0, jeśli brak migawki lub czujnika).
+ */
+int MainWindow::restoreSession()
+{
+    if (!sessionPending || !stationsMap.contains(currentStationId)) {
+        return 0;
+    }
+    sessionPending = false;
+    QJsonArray sensors;
+    for (const QJsonObject& sensor : sensorsMap) {
+        sensors.append(sensor);
+    }
+    stationSelected(currentStationId);
+    emit sensorsUpdateRequested(ReplyParser::indexSensors(sensors).sensorsList);
+    if (currentSensorId > 0 && !currentSeries.isEmpty()) {
+        processAndDisplayMeasurements(currentSeries);
     }
-    QJsonObject sensorHistory = history[QString::number(sensorId)].toObject();
-    sensorHistory[dateKey] = data;
-    history[QString::number(sensorId)] = sensorHistory;
+    return currentSensorId;
+}
 
-    /// Zapisuje do pliku tymczasowego dla bezpieczeństwa.
-    QString tempPath = historyPath + ".tmp";
-    QFile tempFile(tempPath);
-    if (!tempFile.open(QIODevice::WriteOnly)) {
-        qDebug() << "Błąd otwierania pliku tymczasowego:" << tempFile.errorString();
-        emit autoSaveStatus("Błąd zapisu: Brak dostępu do pliku " + tempPath, false);
-        emit dataPathInfo("Błąd zapisu: Brak dostępu do pliku " + tempPath);
-        return false;
+/**
+ * @brief Zwraca ścieżkę do katalogu danych aplikacji.
+ * @return Ścieżka do katalogu w standardowej lokalizacji AppData.
+ */
+QString MainWindow::getDataDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/data";
+}
+
+/**
+ * @brief Otwiera magazyn historii w katalogu danych.
+ * Jeśli magazyn jest pusty, a istnieje stary plik air_quality_history.json, przenosi jego zawartość.
+ */
+void MainWindow::openHistoryStore()
+{
+    historyStore = new HistoryStore(getDataDirectory() + "/" + HISTORY_DIRNAME, this);
+    historyWriter = DeltaHistoryWriter(historyStore);
+    historyImporter = new HistoryImporter(historyStore, this);
+    connect(historyImporter, &HistoryImporter::progress, this, &MainWindow::importProgress);
+    connect(historyImporter, &HistoryImporter::finished, this,
+            [this](int imported, int failed, const QStringList& errors) {
+        if (imported > 0) {
+            /// Zaimportowane rekordy mogą zawierać punkty, których zapisany stan autozapisu nie zna.
+            historyWriter.reset();
+            emit dataPathInfo("Zaimportowano " + QString::number(imported) + " plików do: " + historyStore->directory());
+        }
+        emit importFinished(imported, failed, errors);
+    });
+    streamingImporter = new StreamingImporter(historyStore, this);
+    connect(streamingImporter, &StreamingImporter::progress, this, [this](qint64 bytesRead, qint64 totalBytes) {
+        /// Kilobajty mieszczą się w int także dla plików większych niż 2 GB.
+        emit importProgress(int(bytesRead / 1024), int(totalBytes / 1024));
+    });
+    connect(streamingImporter, &StreamingImporter::finished, this,
+            [this](int points, int records, int skippedLines, const QString& error) {
+        QStringList messages;
+        if (!error.isEmpty()) {
+            messages.append(error);
+        }
+        if (skippedLines > 0) {
+            messages.append("Pominięto nieprawidłowych pomiarów: " + QString::number(skippedLines));
+        }
+        if (records > 0) {
+            historyWriter.reset();
+            emit dataPathInfo("Zaimportowano " + QString::number(points) + " pomiarów do: " + historyStore->directory());
+        }
+        emit importFinished(records > 0 ? 1 : 0, error.isEmpty() ? 0 : 1, messages);
+    });
+    if (!historyStore->open()) {
+        qDebug() << "Błąd otwarcia magazynu historii:" << historyStore->errorString();
+        emit dataPathInfo("Błąd: " + historyStore->errorString());
+        return;
     }
-    QJsonDocument doc(history);
-    tempFile.write(doc.toJson());
-    tempFile.close();
+    /// Plik jest przemianowywany dopiero po udanym przeniesieniu, więc jego obecność oznacza niedokończoną migrację.
+    QString legacyPath = getDataDirectory() + "/" + LEGACY_HISTORY_FILENAME;
+    if (QFile::exists(legacyPath)) {
+        int imported = historyStore->importLegacyFile(legacyPath);
+        if (imported < 0) {
+            qDebug() << "Błąd przenoszenia starej historii:" << historyStore->errorString();
+            emit dataPathInfo("Błąd przenoszenia historii: " + legacyPath);
+        } else {
+            qDebug() << "Przeniesiono" << imported << "wpisów historii z:" << legacyPath;
+            emit dataPathInfo("Przeniesiono historię do: " + historyStore->directory());
+        }
+    }
+}
 
-    /// Zastępuje oryginalny plik.
-    if (historyFile.exists() && !historyFile.remove()) {
-        qDebug() << "Błąd usuwania starego pliku historii:" << historyFile.errorString();
-        emit autoSaveStatus("Błąd zapisu: Nie można usunąć starego pliku " + historyPath, false);
-        emit dataPathInfo("Błąd zapisu: Nie można usunąć starego pliku " + historyPath);
+/**
+ * @brief Zapisuje dane pomiarowe do magazynu historii.
+ * Dopisuje jeden rekord na końcu aktywnego segmentu, bez przepisywania wcześniejszych danych.
+ * @param sensorId ID czujnika.
+ * @param data Dane pomiarowe do zapisania.
+ * @param dateKey Klucz daty dla danych.
+ * @return True, jeśli zapis się powiódł; false w przeciwnym razie.
+ */
+bool MainWindow::saveToHistoryFile(int sensorId, const QJsonObject& data, const QString& dateKey)
+{
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit autoSaveStatus("Błąd: Magazyn historii niedostępny " + historyStore->directory(), false);
+        emit dataPathInfo("Błąd: Magazyn historii niedostępny " + historyStore->directory());
         return false;
     }
-    if (!tempFile.rename(historyPath)) {
-        qDebug() << "Błąd zmiany nazwy pliku tymczasowego:" << tempFile.errorString();
-        emit autoSaveStatus("Błąd zapisu: Problem z zapisem pliku " + historyPath, false);
-        emit dataPathInfo("Błąd zapisu: Problem z zapisem pliku " + historyPath);
+    if (!historyStore->put(sensorId, dateKey, data)) {
+        qDebug() << "Błąd zapisu do magazynu historii:" << historyStore->errorString();
+        emit autoSaveStatus("Błąd zapisu: " + historyStore->errorString(), false);
+        emit dataPathInfo("Błąd zapisu: " + historyStore->errorString());
         return false;
     }
 
-    qDebug() << "Dane zapisano do pliku historii dla czujnika ID:" << sensorId << "z kluczem daty:" << dateKey;
-    emit autoSaveStatus("Dane zapisane automatycznie: " + historyPath, true);
-    emit dataPathInfo("Zapisano plik: " + historyPath);
+    qDebug() << "Dane zapisano do historii dla czujnika ID:" << sensorId << "z kluczem daty:" << dateKey;
+    emit autoSaveStatus("Dane zapisane automatycznie: " + historyStore->directory(), true);
+    emit dataPathInfo("Zapisano dane w: " + historyStore->directory());
     return true;
 }
 
 /**
  * @brief Automatycznie zapisuje pomiary co 60 sekund.
- * Sprawdza, czy dane są dostępne, i zapisuje je do pliku historii.
+ * Sprawdza, czy dane są dostępne, i zapisuje do historii tylko nowe lub zmienione punkty;
+ * niezmieniony szereg (ten sam skrót treści) jest pomijany.
  */
 void MainWindow::autoSaveMeasurements()
 {
+    saveSnapshot();
     /// Sprawdza, czy wybrano czujnik.
     if (currentSensorId == 0) {
         qDebug() << "Autozapis pominięty: Brak wybranego czujnika";
@@ -159,7 +298,7 @@ void MainWindow::autoSaveMeasurements()
         return;
     }
     /// Sprawdza, czy są dane pomiarowe.
-    if (currentMeasurements.isEmpty()) {
+    if (currentSeries.isEmpty()) {
         qDebug() << "Autozapis pominięty: Brak danych pomiarowych";
         emit autoSaveStatus("Brak danych do zapisu", false);
         return;
@@ -171,15 +310,30 @@ void MainWindow::autoSaveMeasurements()
         return;
     }
 
-    /// Przygotowuje dane do zapisu.
-    QJsonObject dataToSave = currentMeasurements;
-    dataToSave["sensorInfo"] = sensorsMap[currentSensorId];
-    dataToSave["saveDate"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-    QString dateKey = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit autoSaveStatus("Błąd: Magazyn historii niedostępny " + historyStore->directory(), false);
+        return;
+    }
 
-    /// Zapisuje dane do pliku historii.
-    bool success = saveToHistoryFile(currentSensorId, dataToSave, dateKey);
-    qDebug() << (success ? "Autozapis zakończony powodzeniem" : "Autozapis nieudany") << "dla czujnika ID:" << currentSensorId;
+    /// Zapisuje tylko punkty, których jeszcze nie ma w historii.
+    int savedPoints = 0;
+    switch (historyWriter.save(currentSensorId, currentSeries, sensorsMap[currentSensorId], &savedPoints)) {
+    case DeltaHistoryWriter::Unchanged:
+        qDebug() << "Autozapis pominięty: Brak nowych pomiarów dla czujnika ID:" << currentSensorId;
+        emit autoSaveStatus("Brak nowych pomiarów, historia aktualna", true);
+        break;
+    case DeltaHistoryWriter::Saved:
+        qDebug() << "Autozapis zakończony powodzeniem dla czujnika ID:" << currentSensorId << "nowe punkty:" << savedPoints;
+        emit autoSaveStatus("Zapisano nowe pomiary (" + QString::number(savedPoints) + "): " + historyStore->directory(), true);
+        emit dataPathInfo("Zapisano dane w: " + historyStore->directory());
+        break;
+    case DeltaHistoryWriter::Failed:
+        qDebug() << "Autozapis nieudany dla czujnika ID:" << currentSensorId;
+        emit autoSaveStatus("Błąd zapisu: " + historyStore->errorString(), false);
+        emit dataPathInfo("Błąd zapisu: " + historyStore->errorString());
+        break;
+    }
 }
 
 /**
@@ -187,123 +341,218 @@ void MainWindow::autoSaveMeasurements()
  */
 void MainWindow::fetchStations()
 {
-    QNetworkRequest request(QUrl(API_BASE_URL + API_STATIONS_ENDPOINT));
-    QNetworkReply* reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &MainWindow::onStationsReceived);
+    /// Odpowiedź w toku i tak trafi do onStationsReceived; drugi strumień dublowałby stacje.
+    if (apiDispatcher->isInFlight(ApiEndpoint::Stations, 0)) {
+        return;
+    }
+    if (stationStream) {
+        stationStream->deleteLater();
+    }
+    stationStream = new JsonStreamParser<StationsParseResult>(1, [](StationsParseResult* result, const QJsonObject& station) {
+        result->stations.append(station);
+    }, [](StationsParseResult* result, const QJsonDocument& skeleton) {
+        if (!skeleton.isArray()) {
+            return false;
+        }
+        *result = ReplyParser::indexStations(result->stations);
+        return true;
+    }, this);
+    /// Przy pierwszym wczytaniu stacje trafiają do listy w QML paczkami, zanim nadejdzie cała odpowiedź.
+    streamStationsToModel = stationListModel->stationCount() == 0;
+    if (streamStationsToModel) {
+        stationStream->setBatchHandler([this](const QJsonArray& stations) {
+            /// Paczka zadania, które skończyło się już po odrzuceniu strumienia, nie trafia do modelu.
+            if (streamStationsToModel) {
+                stationListModel->appendStations(stations);
+            }
+        });
+    }
+    apiDispatcher->get(ApiEndpoint::Stations, 0, this, [this](const ApiReply& reply) {
+        onStationsReceived(reply);
+    }, false, [this](const ApiRequest& request, const QByteArray& chunk) {
+        onStationsChunk(request, chunk);
+    });
+}
+
+/**
+ * @brief Przekazuje kolejny fragment listy stacji do parsowania w puli wątków.
+ * @param request Metadane żądania.
+ * @param chunk Kolejne bajty treści.
+ */
+void MainWindow::onStationsChunk(const ApiRequest& request, const QByteArray& chunk)
+{
+    Q_UNUSED(request);
+    if (stationStream) {
+        stationStream->feed(chunk);
+    }
 }
 
 /**
  * @brief Obsługuje odpowiedź API z listą stacji.
- * Zapisuje stacje do mapy i wyświetla je w QML.
+ * Zapisuje stacje do mapy i wyświetla je w QML. Przy każdym błędzie model wraca do ostatniej poprawnej
+ * listy, żeby stacje dopisane ze strumienia nie zostały w QML bez wpisów w stationsMap.
+ * @param reply Odpowiedź API.
  */
-void MainWindow::onStationsReceived()
+void MainWindow::onStationsReceived(const ApiReply& reply)
 {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
+    JsonStreamParser<StationsParseResult>* stream = stationStream;
+    stationStream = nullptr;
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania stacji:" << reply.errorString;
+        if (stream) {
+            stream->deleteLater();
+        }
+        discardStreamedStations();
+        return;
+    }
+    /// Mapa stacji i indeksy powstają w puli wątków; tutaj są tylko podmieniane.
+    const auto onParsed = [this](const StationsParseResult& result) {
+        if (!result.ok) {
+            qDebug() << "Nieprawidłowa odpowiedź JSON dla listy stacji";
+            discardStreamedStations();
+            return;
+        }
+        streamStationsToModel = false;
+        allStations = result.stations;
+        stationsMap = result.stationsMap;
+        stationSearchIndex = result.searchIndex;
+        stationSpatialIndex = result.spatialIndex;
+        stationListModel->setStations(allStations);
+        reapplyStationFilter();
+        snapshotDirty = true;
+    };
+    if (!stream) {
+        ReplyParser::run(this, &ReplyParser::parseStations, reply.body, onParsed);
+        return;
+    }
+    /// Pełna treść istnieje tylko, gdy żądanie dzielił oczekujący bez onChunk.
+    const QByteArray body = reply.body;
+    stream->finish([this, stream, body, onParsed](bool ok, const StationsParseResult& result) {
+        stream->deleteLater();
+        if (ok) {
+            onParsed(result);
+        } else if (!body.isEmpty()) {
+            qDebug() << "Niekompletny strumień listy stacji, parsowanie całej odpowiedzi";
+            ReplyParser::run(this, &ReplyParser::parseStations, body, onParsed);
+        } else {
+            qDebug() << "Nieprawidłowa odpowiedź JSON dla listy stacji";
+            discardStreamedStations();
+        }
+    });
+}
 
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray stations = jsonDoc.array();
-        allStations = stations;
+/**
+ * @brief Usuwa z modelu stacje dopisane ze strumienia, który się nie powiódł.
+ * Model dostaje ostatnią poprawną listę (allStations); przy pierwszym wczytaniu jest ona pusta.
+ */
+void MainWindow::discardStreamedStations()
+{
+    if (!streamStationsToModel) {
+        return;
+    }
+    streamStationsToModel = false;
+    stationListModel->setStations(allStations);
+    reapplyStationFilter();
+}
 
-        /// Zapisuje stacje do mapy.
-        stationsMap.clear();
-        for (const QJsonValue& value : stations) {
-            QJsonObject station = value.toObject();
-            stationsMap[station["id"].toInt()] = station;
-        }
-        displayStations(stations);
-    } else {
-        qDebug() << "Błąd pobierania stacji:" << reply->errorString();
+/**
+ * @brief Powtarza aktywne wyszukiwanie po wczytaniu listy stacji od nowa.
+ * Model pokazuje wtedy stacje dopasowane tylko po nazwie i mieście; wyszukiwanie przywraca pełne wyniki
+ * i ich kolejność, a tekst w polu wyszukiwania QML znów zgadza się z listą.
+ */
+void MainWindow::reapplyStationFilter()
+{
+    const QString filter = stationListModel->filterText();
+    if (!filter.isEmpty()) {
+        searchStations(filter);
     }
-    reply->deleteLater();
 }
 
 /**
  * @brief Obsługuje odpowiedź API z listą czujników.
  * Zapisuje czujniki do mapy i przekazuje listę do QML.
+ * @param reply Odpowiedź API (ID stacji w metadanych żądania).
  */
-void MainWindow::onSensorsReceived()
-{
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
-        QJsonArray sensors = jsonDoc.array();
-
-        /// Zapisuje czujniki i przygotowuje dane dla QML.
-        sensorsMap.clear();
-        QVariantList sensorsList;
-        for (const QJsonValue& value : sensors) {
-            QJsonObject sensor = value.toObject();
-            int sensorId = sensor["id"].toInt();
-            sensorsMap[sensorId] = sensor;
-            QVariantMap sensorData;
-            sensorData["id"] = sensorId;
-            sensorData["param"] = sensor["param"].toObject()["paramName"].toString();
-            sensorData["code"] = sensor["param"].toObject()["paramCode"].toString();
-            sensorsList.append(sensorData);
-        }
-        emit sensorsUpdateRequested(sensorsList);
-    } else {
-        qDebug() << "Błąd pobierania czujników:" << reply->errorString();
+void MainWindow::onSensorsReceived(const ApiReply& reply)
+{
+    if (reply.request.id != currentStationId) {
+        qDebug() << "Pominięto czujniki nieaktualnej stacji ID:" << reply.request.id;
+        return;
     }
-    reply->deleteLater();
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania czujników:" << reply.errorString;
+        return;
+    }
+    const int stationId = reply.request.id;
+    ReplyParser::run(this, &ReplyParser::parseSensors, reply.body, [this, stationId](const SensorsParseResult& result) {
+        /// Użytkownik mógł wybrać inną stację w trakcie parsowania.
+        if (stationId != currentStationId) {
+            return;
+        }
+        if (!result.ok) {
+            qDebug() << "Nieprawidłowa odpowiedź JSON dla czujników stacji ID:" << stationId;
+            return;
+        }
+        sensorsMap = result.sensorsMap;
+        snapshotDirty = true;
+        for (auto it = sensorsMap.constBegin(); it != sensorsMap.constEnd(); ++it) {
+            sensorCatalog.insert(it.key(), StationAggregator::sensorInfo(it.value()));
+        }
+        emit sensorsUpdateRequested(result.sensorsList);
+
+        /// Pobiera z wyprzedzeniem pomiary czujników stacji, których nie ma w cache.
+        QList<int> missingSensors;
+        for (auto it = sensorsMap.constBegin(); it != sensorsMap.constEnd(); ++it) {
+            if (!measurementCache->contains(it.key())) {
+                missingSensors.append(it.key());
+            }
+        }
+        measurementPrefetcher->prefetch(missingSensors, sensorsMap.contains(currentSensorId) ? currentSensorId : 0);
+    });
 }
 
 /**
  * @brief Obsługuje odpowiedź API z indeksem jakości powietrza.
  * Przetwarza dane i aktualizuje interfejs QML.
+ * @param reply Odpowiedź API (ID stacji w metadanych żądania).
  */
-void MainWindow::onAirQualityIndexReceived()
-{
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject airQuality = jsonDoc.object();
-
-        /// Określa poziom jakości powietrza i kolor.
-        QString indexLevel = "Brak danych";
-        QString color = "#808080";
-        if (!airQuality.isEmpty() && airQuality.contains("stIndexLevel") && !airQuality["stIndexLevel"].isNull()) {
-            indexLevel = airQuality["stIndexLevel"].toObject()["indexLevelName"].toString();
-            if (indexLevel == "Bardzo dobry") color = "#00FF00";
-            else if (indexLevel == "Dobry") color = "#97FF00";
-            else if (indexLevel == "Umiarkowany") color = "#FFFF00";
-            else if (indexLevel == "Dostateczny") color = "#FFBB00";
-            else if (indexLevel == "Zły") color = "#FF0000";
-            else if (indexLevel == "Bardzo zły") color = "#990000";
-        }
-        emit airQualityUpdateRequested(indexLevel, color);
-    } else {
-        qDebug() << "Błąd pobierania indeksu jakości powietrza:" << reply->errorString();
+void MainWindow::onAirQualityIndexReceived(const ApiReply& reply)
+{
+    if (reply.request.id != currentStationId) {
+        qDebug() << "Pominięto indeks jakości nieaktualnej stacji ID:" << reply.request.id;
+        return;
+    }
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania indeksu jakości powietrza:" << reply.errorString;
+        return;
     }
-    reply->deleteLater();
+    const int stationId = reply.request.id;
+    ReplyParser::run(this, &ReplyParser::parseAirQuality, reply.body, [this, stationId](const AirQualityParseResult& result) {
+        if (stationId == currentStationId) {
+            emit airQualityUpdateRequested(result.indexLevel, result.color);
+        }
+    });
 }
 
 /**
- * @brief Wyszukuje stacje na podstawie tekstu (nazwa lub miasto).
+ * @brief Wyszukuje stacje na podstawie tekstu (nazwa, miasto, gmina lub województwo).
+ * Korzysta z indeksu bez polskich znaków, więc np. "lodz" znajduje "Łódź".
  * @param searchText Tekst wyszukiwania.
  */
 void MainWindow::searchStations(const QString& searchText)
 {
-    if (searchText.isEmpty()) {
-        displayStations(allStations);
+    if (searchText.trimmed().isEmpty()) {
+        stationListModel->showAll();
         return;
     }
-    QJsonArray filteredStations;
-    for (const QJsonValue& value : allStations) {
-        QJsonObject station = value.toObject();
-        QString stationName = station["stationName"].toString().toLower();
-        QString city = station["city"].toObject()["name"].toString().toLower();
-        if (stationName.contains(searchText.toLower()) || city.contains(searchText.toLower())) {
-            filteredStations.append(station);
-        }
+    stationListModel->setFilterText(searchText);
+    const QVector<int> matches = stationSearchIndex.search(searchText);
+    QVector<int> stationIds;
+    stationIds.reserve(matches.size());
+    for (int i : matches) {
+        stationIds.append(allStations[i].toObject()["id"].toInt());
     }
-    displayStations(filteredStations);
+    stationListModel->showStations(stationIds);
 }
 
 /**
@@ -311,7 +560,48 @@ void MainWindow::searchStations(const QString& searchText)
  */
 void MainWindow::showAllStations()
 {
-    displayStations(allStations);
+    stationListModel->showAll();
+}
+
+/**
+ * @brief Zwraca stacje najbliższe podanemu punktowi.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param count Liczba stacji.
+ * @return Lista stacji {id, name, city, lat, lon, distance} posortowana od najbliższej.
+ */
+QVariantList MainWindow::nearestStations(double lat, double lon, int count)
+{
+    return stationHitsToList(stationSpatialIndex.nearest(lat, lon, count));
+}
+
+/**
+ * @brief Zwraca stacje w zadanym promieniu od punktu.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param radiusKm Promień w km.
+ * @return Lista stacji {id, name, city, lat, lon, distance} posortowana od najbliższej.
+ */
+QVariantList MainWindow::stationsWithinRadius(double lat, double lon, double radiusKm)
+{
+    return stationHitsToList(stationSpatialIndex.withinRadius(lat, lon, radiusKm));
+}
+
+/**
+ * @brief Zwraca stacje wewnątrz prostokąta współrzędnych.
+ * @param minLat Minimalna szerokość geograficzna.
+ * @param minLon Minimalna długość geograficzna.
+ * @param maxLat Maksymalna szerokość geograficzna.
+ * @param maxLon Maksymalna długość geograficzna.
+ * @return Lista stacji {id, name, city, lat, lon}.
+ */
+QVariantList MainWindow::stationsInBoundingBox(double minLat, double minLon, double maxLat, double maxLon)
+{
+    QVariantList stationsList;
+    for (int stationId : stationSpatialIndex.inBoundingBox(minLat, minLon, maxLat, maxLon)) {
+        stationsList.append(stationLocation(stationId));
+    }
+    return stationsList;
 }
 
 /**
@@ -325,11 +615,15 @@ void MainWindow::stationSelected(int stationId)
         return;
     }
     QJsonObject station = stationsMap[stationId];
-    QString lat = QString::number(station["gegrLat"].toDouble());
-    QString lon = QString::number(station["gegrLon"].toDouble());
+    QString lat = QString::number(StationSpatialIndex::coordinate(station["gegrLat"]));
+    QString lon = QString::number(StationSpatialIndex::coordinate(station["gegrLon"]));
     QString addressStreet = station.contains("addressStreet") ? station["addressStreet"].toString() : "Brak adresu";
     QString city = station["city"].toObject()["name"].toString();
     emit stationInfoUpdateRequested(stationId, station["stationName"].toString(), addressStreet, city, lat, lon);
+    currentStationId = stationId;
+    snapshotDirty = true;
+    /// Czujniki poprzedniej stacji czekające w kolejce nie są już potrzebne.
+    measurementPrefetcher->clearQueue();
     fetchSensors(stationId);
     fetchAirQualityIndex(stationId);
 }
@@ -345,6 +639,7 @@ void MainWindow::sensorSelected(int sensorId)
         return;
     }
     currentSensorId = sensorId;
+    snapshotDirty = true;
     qDebug() << "Wybrano czujnik, pobieranie pomiarów dla ID:" << sensorId;
     fetchMeasurements(sensorId);
 }
@@ -355,9 +650,10 @@ void MainWindow::sensorSelected(int sensorId)
  */
 void MainWindow::fetchSensors(int stationId)
 {
-    QNetworkRequest request(QUrl(API_BASE_URL + API_SENSORS_ENDPOINT + QString::number(stationId)));
-    QNetworkReply* reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &MainWindow::onSensorsReceived);
+    /// Żądanie zastępuje czujniki poprzednio wybranej stacji, jeśli jeszcze nie dotarły.
+    apiDispatcher->get(ApiEndpoint::Sensors, stationId, this, [this](const ApiReply& reply) {
+        onSensorsReceived(reply);
+    }, true);
 }
 
 /**
@@ -366,19 +662,16 @@ void MainWindow::fetchSensors(int stationId)
  */
 void MainWindow::fetchMeasurements(int sensorId)
 {
-    if (isCacheValid(sensorId)) {
-        QJsonObject cachedData = getFromCache(sensorId);
-        if (!cachedData.isEmpty()) {
-            qDebug() << "Używanie danych z pamięci podręcznej dla czujnika ID:" << sensorId;
-            processAndDisplayMeasurements(cachedData);
-            emit statisticsUpdated(computeStatistics(sensorId));
-            autoSaveMeasurements();
-            return;
-        }
+    MeasurementSeries cachedData = measurementCache->value(sensorId);
+    if (!cachedData.isEmpty()) {
+        qDebug() << "Używanie danych z pamięci podręcznej dla czujnika ID:" << sensorId;
+        processAndDisplayMeasurements(cachedData);
+        emit statisticsUpdated(computeStatistics(sensorId));
+        autoSaveMeasurements();
+        return;
     }
-    QNetworkRequest request(QUrl(API_BASE_URL + API_MEASUREMENTS_ENDPOINT + QString::number(sensorId)));
-    QNetworkReply* reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &MainWindow::onMeasurementsReceived);
+    /// Czujnik pobierany z wyprzedzeniem jest przenoszony na początek, poza limit równoległości.
+    measurementPrefetcher->fetchNow(sensorId);
 }
 
 /**
@@ -387,27 +680,43 @@ void MainWindow::fetchMeasurements(int sensorId)
  */
 void MainWindow::fetchAirQualityIndex(int stationId)
 {
-    QNetworkRequest request(QUrl(API_BASE_URL + API_AIR_QUALITY_ENDPOINT + QString::number(stationId)));
-    QNetworkReply* reply = networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, &MainWindow::onAirQualityIndexReceived);
+    apiDispatcher->get(ApiEndpoint::AirQualityIndex, stationId, this, [this](const ApiReply& reply) {
+        onAirQualityIndexReceived(reply);
+    }, true);
+}
+
+/**
+ * @brief Zwraca podstawowe dane stacji z położeniem.
+ * @param stationId ID stacji.
+ * @return Mapa {id, name, city, lat, lon}.
+ */
+QVariantMap MainWindow::stationLocation(int stationId) const
+{
+    const QJsonObject station = stationsMap.value(stationId);
+    QVariantMap stationData;
+    stationData["id"] = stationId;
+    stationData["name"] = station["stationName"].toString();
+    stationData["city"] = station["city"].toObject()["name"].toString();
+    stationData["lat"] = StationSpatialIndex::coordinate(station["gegrLat"]);
+    stationData["lon"] = StationSpatialIndex::coordinate(station["gegrLon"]);
+    return stationData;
 }
 
 /**
- * @brief Przygotowuje listę stacji do wyświetlenia w QML.
- * @param stations Tablica stacji w formacie JSON.
+ * @brief Zamienia wyniki indeksu przestrzennego na listę stacji dla QML.
+ * @param hits Wyniki zapytania (ID stacji i odległość).
+ * @return Lista map {id, name, city, lat, lon, distance}.
  */
-void MainWindow::displayStations(const QJsonArray& stations)
+QVariantList MainWindow::stationHitsToList(const QVector<StationSpatialIndex::Hit>& hits) const
 {
     QVariantList stationsList;
-    for (const QJsonValue& value : stations) {
-        QJsonObject station = value.toObject();
-        QVariantMap stationData;
-        stationData["id"] = station["id"].toInt();
-        stationData["name"] = station["stationName"].toString();
-        stationData["city"] = station["city"].toObject()["name"].toString();
+    stationsList.reserve(hits.size());
+    for (const StationSpatialIndex::Hit& hit : hits) {
+        QVariantMap stationData = stationLocation(hit.stationId);
+        stationData["distance"] = hit.distanceKm;
         stationsList.append(stationData);
     }
-    emit stationsUpdateRequested(stationsList);
+    return stationsList;
 }
 
 /**
@@ -442,425 +751,466 @@ QString MainWindow::getCachePath()
 }
 
 /**
- * @brief Zapisuje dane do pliku pamięci podręcznej.
- * @param cacheData Dane do zapisania.
- * @return True, jeśli zapis się powiódł; false w przeciwnym razie.
+ * @brief Wczytuje historyczne dane dla czujnika i klucza daty.
+ * @param sensorId ID czujnika.
+ * @param dateKey Klucz daty dla danych.
  */
-bool MainWindow::saveToCacheFile(const QJsonObject& cacheData)
+void MainWindow::loadHistoricalData(int sensorId, const QString& dateKey)
 {
-    QFile file(getCachePath());
-    if (!file.open(QIODevice::WriteOnly)) {
-        qDebug() << "Błąd otwierania pliku pamięci podręcznej do zapisu:" << file.errorString();
-        emit autoSaveStatus("Błąd zapisu pamięci podręcznej: " + getCachePath(), false);
-        emit dataPathInfo("Błąd zapisu pamięci podręcznej: " + getCachePath());
-        return false;
+    if (!sensorsMap.contains(sensorId)) {
+        qDebug() << "Nieprawidłowy ID czujnika:" << sensorId;
+        return;
     }
-    QJsonDocument doc(cacheData);
-    file.write(doc.toJson());
-    file.close();
-    qDebug() << "Zapisano pamięć podręczną do:" << getCachePath();
-    emit dataPathInfo("Zapisano pamięć podręczną: " + getCachePath());
-    return true;
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        showSeries("Brak danych historycznych", MeasurementSeries());
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
+        return;
+    }
+    if (!historyStore->contains(sensorId, dateKey)) {
+        qDebug() << "Brak danych historycznych dla czujnika ID:" << sensorId << "lub klucza:" << dateKey;
+        showSeries("Brak danych dla tej daty", MeasurementSeries());
+        return;
+    }
+    /// Rekordy różnic zawierają tylko nowe punkty, więc stan z danej chwili to ostatni punkt kontrolny i różnice po nim.
+    MeasurementSeries series = DeltaHistoryWriter::mergedSeries(historyStore, sensorId, dateKey);
+    if (series.isEmpty()) {
+        qDebug() << "Niekompletne dane historyczne dla klucza daty:" << dateKey;
+        showSeries("Niekompletne dane", MeasurementSeries());
+        return;
+    }
+    qDebug() << "Wczytano historyczne pomiary dla czujnika ID:" << sensorId << "klucz daty:" << dateKey;
+    showSeries(series.key() + " [HISTORYCZNY]", series);
+    emit statisticsUpdated(computeStatistics(sensorId));
 }
 
 /**
- * @brief Wczytuje dane z pliku pamięci podręcznej.
- * @return Obiekt JSON z danymi cache lub pusty obiekt w razie błędu.
+ * @brief Zwraca listę dostępnych danych historycznych dla czujnika.
+ * @param sensorId ID czujnika.
+ * @return Lista dat i kluczy historycznych.
  */
-QJsonObject MainWindow::loadFromCacheFile()
+QStringList MainWindow::getAvailableHistoricalData(int sensorId)
 {
-    QFile file(getCachePath());
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Błąd otwierania pliku pamięci podręcznej do odczytu:" << file.errorString();
-        return QJsonObject();
+    QStringList results;
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit historicalDataListUpdated(results);
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
+        return results;
+    }
+    /// Klucze dat są posortowane rosnąco, więc lista wynikowa jest chronologiczna.
+    const QStringList dateKeys = historyStore->dateKeys(sensorId);
+    for (const QString& dateKey : dateKeys) {
+        QDateTime dt = QDateTime::fromString(dateKey, "yyyyMMdd_HHmmss");
+        if (dt.isValid()) {
+            results.append(dt.toString("yyyy-MM-dd HH:mm:ss") + "|" + dateKey);
+        }
     }
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-    return doc.object();
+    qDebug() << "Znaleziono" << results.size() << "wpisów historycznych dla czujnika ID:" << sensorId;
+    emit historicalDataListUpdated(results);
+    return results;
 }
 
 /**
- * @brief Sprawdza, czy dane w pamięci podręcznej są aktualne (ważne 24h).
- * @param sensorId ID czujnika.
- * @return True, jeśli cache jest ważny; false w przeciwnym razie.
+ * @brief Wczytuje dane z pliku JSON.
+ * @param filename Ścieżka do pliku JSON.
+ * @return Obiekt JSON z danymi lub pusty obiekt w razie błędu.
  */
-bool MainWindow::isCacheValid(int sensorId)
+QJsonObject MainWindow::loadFromJson(const QString& filename)
 {
-    QJsonObject cache = loadFromCacheFile();
-    if (cache.isEmpty() || !cache.contains(QString::number(sensorId))) {
-        return false;
-    }
-    QJsonObject sensorCache = cache[QString::number(sensorId)].toObject();
-    if (!sensorCache.contains("timestamp")) {
-        return false;
+    QString error;
+    const QJsonObject data = HistoryImporter::loadJson(filename, &error);
+    if (!error.isEmpty()) {
+        qDebug() << error << filename;
+        emit dataPathInfo("Błąd: " + error + " " + filename);
     }
-    QDateTime cacheTime = QDateTime::fromString(sensorCache["timestamp"].toString(), Qt::ISODate);
-    return cacheTime.secsTo(QDateTime::currentDateTime()) < CACHE_VALIDITY_HOURS * 3600;
+    return data;
 }
 
 /**
- * @brief Aktualizuje pamięć podręczną dla czujnika.
+ * @brief Obsługuje pomiary pobrane dla czujnika.
+ * Każdy wynik trafia do cache; wyświetlany jest tylko wynik dla wybranego czujnika.
  * @param sensorId ID czujnika.
- * @param data Dane do zapisania.
+ * @param series Sparsowany szereg pomiarów.
  */
-void MainWindow::updateCache(int sensorId, const QJsonObject& data)
+void MainWindow::onMeasurementsFetched(int sensorId, const MeasurementSeries& series)
 {
-    QJsonObject cache = loadFromCacheFile();
-    QJsonObject sensorCache;
-    sensorCache["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-    sensorCache["data"] = data;
-    cache[QString::number(sensorId)] = sensorCache;
-    saveToCacheFile(cache);
-    cleanupOldCache();
+    qDebug() << "Odebrano pomiary dla czujnika ID:" << sensorId;
+    measurementCache->insert(sensorId, series);
+    if (sensorId != currentSensorId) {
+        return;
+    }
+    processAndDisplayMeasurements(series);
+    emit statisticsUpdated(computeStatistics(sensorId));
+    autoSaveMeasurements();
 }
 
 /**
- * @brief Pobiera dane z pamięci podręcznej dla czujnika.
+ * @brief Obsługuje błąd pobierania pomiarów.
  * @param sensorId ID czujnika.
- * @return Obiekt JSON z danymi lub pusty obiekt, jeśli brak danych.
+ * @param error Komunikat błędu do wyświetlenia.
  */
-QJsonObject MainWindow::getFromCache(int sensorId)
+void MainWindow::onMeasurementsFetchFailed(int sensorId, const QString& error)
 {
-    QJsonObject cache = loadFromCacheFile();
-    if (cache.isEmpty() || !cache.contains(QString::number(sensorId))) {
-        return QJsonObject();
+    if (sensorId == currentSensorId) {
+        showSeries(error, MeasurementSeries());
     }
-    return cache[QString::number(sensorId)].toObject()["data"].toObject();
 }
 
 /**
- * @brief Usuwa stare dane z pamięci podręcznej.
+ * @brief Przetwarza i wyświetla pomiary w QML.
+ * @param series Sparsowany szereg pomiarów.
  */
-void MainWindow::cleanupOldCache()
+void MainWindow::processAndDisplayMeasurements(const MeasurementSeries& series)
 {
-    QJsonObject cache = loadFromCacheFile();
-    QJsonObject newCache;
-    QDateTime now = QDateTime::currentDateTime();
-    for (auto it = cache.begin(); it != cache.end(); ++it) {
-        QJsonObject sensorCache = it.value().toObject();
-        if (sensorCache.contains("timestamp")) {
-            QDateTime cacheTime = QDateTime::fromString(sensorCache["timestamp"].toString(), Qt::ISODate);
-            if (cacheTime.secsTo(now) < CACHE_VALIDITY_HOURS * 3600) {
-                newCache[it.key()] = it.value();
-            }
-        }
+    currentSeries = series;
+    snapshotDirty = true;
+    if (series.key().isEmpty()) {
+        qDebug() << "Nieprawidłowe dane pomiarów: brak klucza lub wartości";
+        showSeries("Brak danych", MeasurementSeries());
+        return;
     }
-    saveToCacheFile(newCache);
+    qDebug() << "Przetworzono" << series.size() << "pomiarów," << series.validCount() << "ważnych, dla klucza:" << series.key();
+    showSeries(series.key(), series);
 }
 
 /**
- * @brief Wczytuje historyczne dane dla czujnika i klucza daty.
- * @param sensorId ID czujnika.
- * @param dateKey Klucz daty dla danych.
+ * @brief Ustawia wyświetlany szereg w tabeli i informuje QML o nowych danych.
+ * Wykres pobiera punkty jednym wywołaniem fillChartSeries() po odebraniu sygnału. Statystyki szeregu
+ * liczone są tu jednym przebiegiem, więc computeStatistics() nie przegląda pomiarów ponownie.
+ * @param key Opis danych (kod parametru).
+ * @param series Szereg pomiarów (pusty, jeśli brak danych).
  */
-void MainWindow::loadHistoricalData(int sensorId, const QString& dateKey)
+void MainWindow::showSeries(const QString& key, const MeasurementSeries& series)
 {
-    if (!sensorsMap.contains(sensorId)) {
-        qDebug() << "Nieprawidłowy ID czujnika:" << sensorId;
-        return;
-    }
-    QString historyPath = getDataDirectory() + "/air_quality_history.json";
-    QFile historyFile(historyPath);
-    if (!historyFile.exists() || !historyFile.open(QIODevice::ReadOnly)) {
-        qDebug() << "Brak pliku historii lub błąd otwarcia:" << historyFile.errorString();
-        emit measurementsUpdateRequested("Brak danych historycznych", QVariantList());
-        emit dataPathInfo("Brak pliku historii: " + historyPath);
-        return;
-    }
-    QJsonDocument doc = QJsonDocument::fromJson(historyFile.readAll());
-    historyFile.close();
-    if (doc.isNull()) {
-        qDebug() << "Nieprawidłowy JSON w pliku historii:" << historyPath;
-        emit measurementsUpdateRequested("Błąd danych historycznych", QVariantList());
-        emit dataPathInfo("Błąd: Nieprawidłowy JSON w pliku " + historyPath);
-        return;
-    }
-    QJsonObject history = doc.object();
-    QString sensorKey = QString::number(sensorId);
-    if (!history.contains(sensorKey) || !history[sensorKey].toObject().contains(dateKey)) {
-        qDebug() << "Brak danych historycznych dla czujnika ID:" << sensorId << "lub klucza:" << dateKey;
-        emit measurementsUpdateRequested("Brak danych dla tej daty", QVariantList());
-        return;
-    }
-    QJsonObject data = history[sensorKey].toObject()[dateKey].toObject();
-    if (!data.contains("key") || !data.contains("values")) {
-        qDebug() << "Niekompletne dane historyczne dla klucza daty:" << dateKey;
-        emit measurementsUpdateRequested("Niekompletne dane", QVariantList());
-        return;
-    }
-    QString key = data["key"].toString();
-    QJsonArray values = data["values"].toArray();
-    QVariantList valuesList;
-    for (const QJsonValue& value : values) {
-        QJsonObject measurement = value.toObject();
-        QVariantMap point;
-        point["date"] = measurement["date"].toString();
-        point["value"] = measurement["value"].isNull() ? QVariant() : measurement["value"].toDouble();
-        valuesList.append(point);
-    }
-    qDebug() << "Wczytano historyczne pomiary dla czujnika ID:" << sensorId << "klucz daty:" << dateKey;
-    emit measurementsUpdateRequested(key + " [HISTORYCZNY]", valuesList);
-    emit statisticsUpdated(computeStatistics(sensorId));
+    displayedSeries = series;
+    displayedStatistics = SeriesStatistics();
+    displayedStatistics.addSeries(displayedSeries);
+    chartPoints = ChartSeriesLoader::points(series);
+    measurementTableModel->setSeries(series);
+    emit measurementsUpdateRequested(key, series.validCount());
 }
 
 /**
- * @brief Zwraca listę dostępnych danych historycznych dla czujnika.
- * @param sensorId ID czujnika.
- * @return Lista dat i kluczy historycznych.
+ * @brief Wypełnia serię wykresu wyświetlanymi pomiarami.
+ * Na wykres trafia około jednego punktu na piksel (LTTB); zakres osi liczony jest z pełnych danych.
+ * @param chartSeries Seria wykresu z QML (LineSeries).
+ * @param widthPixels Szerokość obszaru wykresu w pikselach.
+ * @return Zakres osi {count, minValue, maxValue, mean, minTime, maxTime}; pusta mapa przy błędzie.
  */
-QStringList MainWindow::getAvailableHistoricalData(int sensorId)
+QVariantMap MainWindow::fillChartSeries(QObject* chartSeries, int widthPixels)
 {
-    QStringList results;
-    QString historyPath = getDataDirectory() + "/air_quality_history.json";
-    QFile historyFile(historyPath);
-    if (!historyFile.exists() || !historyFile.open(QIODevice::ReadOnly)) {
-        qDebug() << "Brak pliku historii lub błąd otwarcia:" << historyFile.errorString();
-        emit historicalDataListUpdated(results);
-        emit dataPathInfo("Brak pliku historii: " + historyPath);
-        return results;
+    if (!ChartSeriesLoader::replace(chartSeries, ChartSeriesLoader::downsample(chartPoints, widthPixels))) {
+        return QVariantMap();
     }
-    QJsonDocument doc = QJsonDocument::fromJson(historyFile.readAll());
-    historyFile.close();
-    if (doc.isNull()) {
-        qDebug() << "Nieprawidłowy JSON w pliku historii:" << historyPath;
-        emit historicalDataListUpdated(results);
-        emit dataPathInfo("Błąd: Nieprawidłowy JSON w pliku " + historyPath);
-        return results;
+    return ChartSeriesLoader::range(chartPoints);
+}
+
+/**
+ * @brief Ponownie decymuje widoczny przedział czasu po zmianie rozmiaru lub przybliżenia wykresu.
+ * @param chartSeries Seria wykresu z QML (LineSeries).
+ * @param widthPixels Szerokość obszaru wykresu w pikselach.
+ * @param fromTime Początek widocznego przedziału (ms od epoki).
+ * @param toTime Koniec widocznego przedziału (ms od epoki).
+ * @return Liczba punktów na wykresie lub -1 przy błędzie.
+ */
+int MainWindow::refreshChartSeries(QObject* chartSeries, int widthPixels, double fromTime, double toTime)
+{
+    const QVector<QPointF> points = ChartSeriesLoader::downsample(
+        ChartSeriesLoader::window(chartPoints, fromTime, toTime), widthPixels);
+    if (!ChartSeriesLoader::replace(chartSeries, points)) {
+        return -1;
     }
-    QJsonObject history = doc.object();
-    QString sensorKey = QString::number(sensorId);
-    if (history.contains(sensorKey)) {
-        QJsonObject sensorHistory = history[sensorKey].toObject();
-        for (auto it = sensorHistory.begin(); it != sensorHistory.end(); ++it) {
-            QString dateKey = it.key();
-            QDateTime dt = QDateTime::fromString(dateKey, "yyyyMMdd_HHmmss");
-            if (dt.isValid()) {
-                results.append(dt.toString("yyyy-MM-dd HH:mm:ss") + "|" + dateKey);
-            }
-        }
+    return points.size();
+}
+
+/**
+ * @brief Zwraca statystyki wyświetlanego szeregu (bieżącego lub historycznego).
+ * Obejmują dokładnie punkty z wykresu i tabeli, także uzupełnione wstecz przez API.
+ * @param sensorId ID czujnika (do komunikatu diagnostycznego).
+ * @return Mapa QVariant ze statystykami (min, max, mean, stdDev, count, p50, p95, p99, mean1h, mean8h, mean24h).
+ */
+QVariantMap MainWindow::computeStatistics(int sensorId)
+{
+    QVariantMap stats = displayedStatistics.toVariantMap();
+    if (stats["count"].toInt() > 0) {
+        qDebug() << "Obliczono statystyki dla czujnika ID:" << sensorId << ": min=" << stats["min"].toDouble() << ", max=" << stats["max"].toDouble() << ", średnia=" << stats["mean"].toDouble();
+    } else {
+        qDebug() << "Brak ważnych danych do statystyk";
     }
-    results.sort(Qt::CaseInsensitive);
-    qDebug() << "Znaleziono" << results.size() << "wpisów historycznych dla czujnika ID:" << sensorId;
-    emit historicalDataListUpdated(results);
-    return results;
+    return stats;
 }
 
 /**
- * @brief Wczytuje dane z pliku JSON.
- * @param filename Ścieżka do pliku JSON.
- * @return Obiekt JSON z danymi lub pusty obiekt w razie błędu.
+ * @brief Liczy w tle statystyki całej zapisanej historii czujnika.
+ * W wątku głównym kopiowane są tylko zakodowane treści rekordów; dekodowanie, scalanie i StatsKernels
+ * działają w puli wątków (summarizeHistory), a wynik trafia do historyStatisticsUpdated.
+ * @param sensorId ID czujnika.
+ * @param threshold Próg przekroczeń (np. norma dobowa).
  */
-QJsonObject MainWindow::loadFromJson(const QString& filename)
+void MainWindow::historyStatistics(int sensorId, double threshold)
 {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Błąd otwierania pliku do odczytu:" << file.errorString();
-        emit dataPathInfo("Błąd odczytu pliku: " + filename);
-        return QJsonObject();
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
+        emit historyStatisticsUpdated(sensorId, QVariantMap());
+        return;
     }
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    file.close();
-    if (doc.isNull()) {
-        qDebug() << "Nieprawidłowy JSON w pliku:" << filename;
-        emit dataPathInfo("Błąd: Nieprawidłowy JSON w pliku " + filename);
-        return QJsonObject();
+    HistoryRecords records;
+    records.threshold = threshold;
+    const QStringList dateKeys = historyStore->dateKeys(sensorId);
+    records.payloads.reserve(dateKeys.size());
+    for (const QString& dateKey : dateKeys) {
+        records.payloads.append(historyStore->payload(sensorId, dateKey));
     }
-    return doc.object();
+    ReplyParser::run(this, &MainWindow::summarizeHistory, records, [this, sensorId](const QVariantMap& stats) {
+        emit historyStatisticsUpdated(sensorId, stats);
+    });
 }
 
 /**
- * @brief Wczytuje dane z pliku XML.
- * @param filename Ścieżka do pliku XML.
- * @return Obiekt JSON z danymi lub pusty obiekt w razie błędu.
+ * @brief Scala rekordy czujnika w jeden ciągły szereg i podsumowuje go jednym wywołaniem StatsKernels.
+ * Punkty każdego rekordu są porządkowane według czasu, a rekordy scalane kopcem (k-way merge); przy
+ * powtórzonym znaczniku czasu obowiązuje punkt z najnowszego rekordu (także brak wartości), jak przy
+ * składaniu widoku historii. Kolumny wartości i braków scalonego szeregu trafiają wprost do StatsKernels
+ * (AVX2/SSE2/skalarnie, zależnie od procesora).
+ * @param records Treści rekordów w kolejności kluczy dat i próg przekroczeń.
+ * @return Mapa QVariant (count, min, max, mean, stdDev, exceedances, threshold, records); pusta, jeśli brak danych.
  */
-QJsonObject MainWindow::loadFromXml(const QString& filename)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Błąd otwierania pliku do odczytu:" << file.errorString();
-        emit dataPathInfo("Błąd odczytu pliku: " + filename);
-        return QJsonObject();
-    }
-    QXmlStreamReader reader(&file);
-    QJsonObject result;
-    QJsonArray values;
-    while (!reader.atEnd()) {
-        if (reader.readNextStartElement()) {
-            if (reader.name() == "Key") {
-                result["key"] = reader.readElementText();
-            } else if (reader.name() == "SaveDate") {
-                result["saveDate"] = reader.readElementText();
-            } else if (reader.name() == "SensorInfo") {
-                QJsonObject sensorInfo;
-                while (reader.readNextStartElement()) {
-                    sensorInfo[reader.name().toString()] = reader.readElementText();
-                }
-                result["sensorInfo"] = sensorInfo;
-            } else if (reader.name() == "Values") {
-                while (reader.readNextStartElement()) {
-                    if (reader.name() == "Measurement") {
-                        QJsonObject measurement;
-                        while (reader.readNextStartElement()) {
-                            if (reader.name() == "Date") {
-                                measurement["date"] = reader.readElementText();
-                            } else if (reader.name() == "Value") {
-                                QString valueStr = reader.readElementText();
-                                measurement["value"] = (valueStr == "null") ? QJsonValue::Null : valueStr.toDouble();
-                            } else {
-                                reader.skipCurrentElement();
-                            }
-                        }
-                        values.append(measurement);
-                    } else {
-                        reader.skipCurrentElement();
-                    }
-                }
+QVariantMap MainWindow::summarizeHistory(const HistoryRecords& records)
+{
+    QVector<MeasurementSeries> series;
+    QVector<QVector<int>> order;
+    int total = 0;
+    for (const QByteArray& payload : records.payloads) {
+        MeasurementSeries decoded;
+        if (!SeriesCodec::decodeRecordSeries(payload, &decoded) || decoded.isEmpty()) {
+            continue;
+        }
+        QVector<int> positions(decoded.size());
+        std::iota(positions.begin(), positions.end(), 0);
+        std::stable_sort(positions.begin(), positions.end(), [&decoded](int a, int b) {
+            return decoded.timestamp(a) < decoded.timestamp(b);
+        });
+        total += decoded.size();
+        series.append(decoded);
+        order.append(positions);
+    }
+
+    /// Kursor rekordu: znacznik czasu bieżącego punktu, numer rekordu i pozycja w jego porządku.
+    struct Cursor {
+        qint64 timestamp;
+        int record;
+        int position;
+    };
+    /// Na szczycie kopca jest najwcześniejszy punkt, a przy równym czasie punkt z najnowszego rekordu.
+    auto after = [](const Cursor& a, const Cursor& b) {
+        return a.timestamp != b.timestamp ? a.timestamp > b.timestamp : a.record < b.record;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(after)> heap(after);
+    for (int r = 0; r < series.size(); ++r) {
+        heap.push(Cursor{series[r].timestamp(order[r][0]), r, 0});
+    }
+    MeasurementSeries merged;
+    merged.reserve(total);
+    while (!heap.empty()) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        const MeasurementSeries& source = series[cursor.record];
+        const int i = order[cursor.record][cursor.position];
+        if (merged.isEmpty() || merged.timestamp(merged.size() - 1) != cursor.timestamp) {
+            if (source.isNull(i)) {
+                merged.appendNull(cursor.timestamp);
             } else {
-                reader.skipCurrentElement();
+                merged.append(cursor.timestamp, source.value(i));
             }
         }
+        if (++cursor.position < order[cursor.record].size()) {
+            cursor.timestamp = source.timestamp(order[cursor.record][cursor.position]);
+            heap.push(cursor);
+        }
     }
-    if (reader.hasError()) {
-        qDebug() << "Błąd parsowania XML:" << reader.errorString();
-        emit dataPathInfo("Błąd parsowania XML: " + filename);
+
+    QVariantMap stats;
+    const StatsKernels::Summary summary = StatsKernels::summarize(merged.values().constData(), merged.nulls().constData(),
+                                                                  merged.size(), float(records.threshold));
+    if (summary.count == 0) {
+        return stats;
     }
-    result["values"] = values;
-    file.close();
-    return result;
+    stats["count"] = summary.count;
+    stats["min"] = summary.min;
+    stats["max"] = summary.max;
+    stats["mean"] = summary.mean();
+    stats["stdDev"] = std::sqrt(summary.variance());
+    stats["exceedances"] = summary.exceedances;
+    stats["threshold"] = records.threshold;
+    stats["records"] = records.payloads.size();
+    return stats;
 }
 
 /**
- * @brief Obsługuje odpowiedź z pomiarami z API.
- * Aktualizuje cache, przetwarza dane i wywołuje autozapis.
+ * @brief Zwraca agregaty historii czujnika do wykresów i zestawień długoterminowych.
+ * Agregaty są utrzymywane przez magazyn historii przy każdym zapisie, więc zapytanie o rok danych
+ * czyta kilkaset wierszy zamiast wszystkich zapisanych rekordów.
+ * @param sensorId ID czujnika.
+ * @param tier Poziom agregacji: "hour", "day" lub "month".
+ * @param fromTime Początek przedziału (ms od epoki).
+ * @param toTime Koniec przedziału (ms od epoki).
+ * @return Lista map {time, min, max, mean, count} posortowana według czasu.
  */
-void MainWindow::onMeasurementsReceived()
+QVariantList MainWindow::historyTrend(int sensorId, const QString& tier, double fromTime, double toTime)
 {
-    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
-        if (jsonDoc.isNull()) {
-            qDebug() << "Nieprawidłowa odpowiedź JSON dla pomiarów";
-            emit measurementsUpdateRequested("Błąd danych", QVariantList());
-            return;
-        }
-        QJsonObject measurements = jsonDoc.object();
-        int sensorId = reply->request().url().toString().split('/').last().toInt();
-        qDebug() << "Odebrano pomiary dla czujnika ID:" << sensorId;
-        updateCache(sensorId, measurements);
-        processAndDisplayMeasurements(measurements);
-        emit statisticsUpdated(computeStatistics(sensorId));
-        autoSaveMeasurements();
-    } else {
-        qDebug() << "Błąd pobierania pomiarów:" << reply->errorString();
-        emit measurementsUpdateRequested("Błąd pobierania danych", QVariantList());
+    QVariantList rows;
+    const QVector<HistoryRollups::Bucket> buckets = trendBuckets(sensorId, tier, fromTime, toTime);
+    rows.reserve(buckets.size());
+    for (const HistoryRollups::Bucket& bucket : buckets) {
+        QVariantMap row;
+        row["time"] = double(bucket.start);
+        row["min"] = bucket.min;
+        row["max"] = bucket.max;
+        row["mean"] = bucket.mean();
+        row["count"] = bucket.count;
+        rows.append(row);
     }
-    reply->deleteLater();
+    qDebug() << "Trend historii czujnika ID:" << sensorId << "poziom:" << tier << "agregaty:" << rows.size();
+    return rows;
 }
 
 /**
- * @brief Przetwarza i wyświetla pomiary w QML.
- * @param measurements Obiekt JSON z danymi pomiarowymi.
+ * @brief Wypełnia serię wykresu średnimi z agregatów historii.
+ * @param chartSeries Seria wykresu z QML (LineSeries).
+ * @param sensorId ID czujnika.
+ * @param tier Poziom agregacji: "hour", "day" lub "month".
+ * @param fromTime Początek przedziału (ms od epoki).
+ * @param toTime Koniec przedziału (ms od epoki).
+ * @return Zakres osi {count, minValue, maxValue, mean, minTime, maxTime}; pusta mapa przy błędzie.
  */
-void MainWindow::processAndDisplayMeasurements(const QJsonObject& measurements)
+QVariantMap MainWindow::fillTrendSeries(QObject* chartSeries, int sensorId, const QString& tier, double fromTime, double toTime)
 {
-    currentMeasurements = measurements;
-    if (!measurements.contains("key") || !measurements.contains("values")) {
-        qDebug() << "Nieprawidłowe dane pomiarów: brak klucza lub wartości";
-        emit measurementsUpdateRequested("Brak danych", QVariantList());
-        return;
+    const QVector<HistoryRollups::Bucket> buckets = trendBuckets(sensorId, tier, fromTime, toTime);
+    QVector<QPointF> points;
+    points.reserve(buckets.size());
+    for (const HistoryRollups::Bucket& bucket : buckets) {
+        points.append(QPointF(double(bucket.start), bucket.mean()));
     }
-    QString key = measurements["key"].toString();
-    QJsonArray values = measurements["values"].toArray();
-    QVariantList valuesList;
-    int validCount = 0;
-    for (const QJsonValue& value : values) {
-        QJsonObject measurement = value.toObject();
-        QString dateStr = measurement["date"].toString();
-        QVariant valueVariant = measurement["value"].toVariant();
-        if (!valueVariant.isNull() && !dateStr.isEmpty()) {
-            validCount++;
-        }
-        QVariantMap point;
-        point["date"] = dateStr;
-        point["value"] = valueVariant.isNull() ? QVariant() : valueVariant.toDouble();
-        valuesList.append(point);
+    if (!ChartSeriesLoader::replace(chartSeries, points)) {
+        return QVariantMap();
     }
-    qDebug() << "Przetworzono" << valuesList.size() << "pomiarów," << validCount << "ważnych, dla klucza:" << key;
-    emit measurementsUpdateRequested(key, valuesList);
+    return ChartSeriesLoader::range(points);
 }
 
 /**
- * @brief Oblicza statystyki (min, max, średnia, odchylenie) dla pomiarów.
- * @param sensorId ID czujnika.
- * @return Mapa QVariant z obliczonymi statystykami.
+ * @brief Zestawia parametr dla wszystkich stacji regionu, które mają zapisaną historię.
+ * W wątku głównym kopiowane są tylko dane wejściowe: agregaty (kopia współdzielona), dane stacji i surowe
+ * najnowsze rekordy czujników, których stacji i parametru jeszcze nie znamy. Dekodowanie rekordów, wybór
+ * czujników i redukcja odbywają się w puli wątków (StationAggregator::run), a wynik trafia do
+ * stationsAggregated. Początek przedziału jest zaokrąglany w dół do pełnej godziny, żeby agregat
+ * pierwszej, niepełnej godziny nie wypadł z zakresu.
+ * @param paramCode Kod parametru (np. "PM2.5").
+ * @param regionField Pole regionu: "city", "commune", "district" lub "province".
+ * @param regionValue Nazwa regionu; pusta oznacza wszystkie stacje.
+ * @param fromTime Początek przedziału (ms od epoki).
+ * @param toTime Koniec przedziału (ms od epoki).
  */
-QVariantMap MainWindow::computeStatistics(int sensorId)
+void MainWindow::aggregateStations(const QString& paramCode, const QString& regionField,
+                                   const QString& regionValue, double fromTime, double toTime)
 {
-    QVariantMap stats;
-    stats["min"] = QVariant();
-    stats["max"] = QVariant();
-    stats["mean"] = QVariant();
-    stats["stdDev"] = QVariant();
-    stats["count"] = 0;
-    if (!currentMeasurements.contains("values")) {
-        qDebug() << "Brak wartości do obliczania statystyk";
-        return stats;
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
+        emit stationsAggregated(QVariantMap());
+        return;
     }
-    QJsonArray values = currentMeasurements["values"].toArray();
-    if (values.isEmpty()) {
-        qDebug() << "Pusta tablica wartości dla statystyk";
-        return stats;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto it = sensorsMap.constBegin(); it != sensorsMap.constEnd(); ++it) {
+        sensorCatalog.insert(it.key(), StationAggregator::sensorInfo(it.value()));
     }
-    double minVal = std::numeric_limits<double>::max();
-    double maxVal = std::numeric_limits<double>::lowest();
-    double sum = 0.0;
-    double sumSquares = 0.0;
-    int count = 0;
-    for (const QJsonValue& value : values) {
-        QJsonObject measurement = value.toObject();
-        if (measurement["value"].isNull()) {
-            continue;
+    StationAggregator::Query query;
+    query.paramCode = paramCode;
+    query.regionField = regionField;
+    query.regionValue = regionValue;
+    query.fromMs = HistoryRollups::hourStart(qint64(fromTime));
+    query.toMs = qint64(toTime);
+    query.sensorIds = historyStore->sensorIds();
+    query.known = sensorCatalog;
+    query.stations = stationsMap;
+    query.rollups = historyStore->rollupsSnapshot();
+    for (int sensorId : query.sensorIds) {
+        if (!sensorCatalog.contains(sensorId)) {
+            query.unknown.append(qMakePair(sensorId, historyStore->payload(sensorId, historyStore->dateKeys(sensorId).last())));
         }
-        double val = measurement["value"].toDouble();
-        if (std::isnan(val) || std::isinf(val)) {
-            continue;
+    }
+    ReplyParser::run(this, &StationAggregator::run, query,
+                     [this, paramCode, regionField, regionValue, timer](const StationAggregator::Answer& answer) {
+        /// Czujniki bez stacji nie są zapamiętywane: stacja może się znaleźć w liście czujników wybranej później stacji.
+        for (auto it = answer.resolved.constBegin(); it != answer.resolved.constEnd(); ++it) {
+            if (it->stationId != 0 && !sensorCatalog.contains(it.key())) {
+                sensorCatalog.insert(it.key(), it.value());
+            }
         }
-        minVal = std::min(minVal, val);
-        maxVal = std::max(maxVal, val);
-        sum += val;
-        sumSquares += val * val;
-        count++;
+        qDebug() << "Zestawienie" << paramCode << regionField << regionValue << ": czujniki:" << answer.targetCount
+                 << "z danymi:" << answer.resultCount << "nowe opisy czujników:" << answer.resolved.size()
+                 << "czas:" << timer.elapsed() << "ms";
+        emit stationsAggregated(answer.summary);
+    });
+}
+
+/**
+ * @brief Zamienia nazwę poziomu z QML na poziom agregatów i pobiera agregaty z magazynu historii.
+ * @param sensorId ID czujnika.
+ * @param tier Poziom agregacji: "hour", "day" lub "month".
+ * @param fromTime Początek przedziału (ms od epoki).
+ * @param toTime Koniec przedziału (ms od epoki).
+ * @return Agregaty posortowane według czasu; pusta lista dla nieznanego poziomu.
+ */
+QVector<HistoryRollups::Bucket> MainWindow::trendBuckets(int sensorId, const QString& tier, double fromTime, double toTime) const
+{
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        return QVector<HistoryRollups::Bucket>();
     }
-    if (count == 0) {
-        qDebug() << "Brak ważnych danych do statystyk";
-        return stats;
+    HistoryRollups::Tier rollupTier;
+    if (tier == "hour") {
+        rollupTier = HistoryRollups::Hourly;
+    } else if (tier == "day") {
+        rollupTier = HistoryRollups::Daily;
+    } else if (tier == "month") {
+        rollupTier = HistoryRollups::Monthly;
+    } else {
+        qDebug() << "Nieznany poziom agregacji:" << tier;
+        return QVector<HistoryRollups::Bucket>();
     }
-    double mean = sum / count;
-    double stdDev = count > 1 ? std::sqrt((sumSquares / count) - (mean * mean)) : 0.0;
-    stats["min"] = minVal;
-    stats["max"] = maxVal;
-    stats["mean"] = mean;
-    stats["stdDev"] = stdDev;
-    stats["count"] = count;
-    qDebug() << "Obliczono statystyki dla czujnika ID:" << sensorId << ": min=" << minVal << ", max=" << maxVal << ", średnia=" << mean;
-    return stats;
+    return historyStore->rollups(sensorId, rollupTier, qint64(fromTime), qint64(toTime));
 }
 
 /**
- * @brief Importuje dane z pliku JSON lub XML.
+ * @brief Importuje dane z pliku JSON, XML lub CSV.
+ * Plik JSON jest zapisywany od razu. Pliki XML i CSV są czytane strumieniowo w tle i zapisywane
+ * paczkami punktów (bez budowania drzewa JSON całego pliku); postęp przekazuje importProgress,
+ * a wynik importFinished. Pliki bez ID czujnika (CSV bez kolumny czujnika) trafiają do wybranego czujnika.
  * @param path Ścieżka do pliku.
- * @param format Format pliku (json lub xml).
- * @return True, jeśli import się powiódł; false w przeciwnym razie.
+ * @param format Format pliku (json, xml lub csv).
+ * @return True, jeśli zapisano plik JSON lub uruchomiono import strumieniowy; false w przeciwnym razie.
  */
 bool MainWindow::importDataFromFile(const QString& path, const QString& format)
 {
+    const QString type = format.toLower();
+    if (type == "xml" || type == "csv") {
+        if (isImportRunning()) {
+            return false;
+        }
+        if (!streamingImporter->start(path, currentSensorId, sensorsMap.value(currentSensorId))) {
+            qDebug() << "Nie można uruchomić importu pliku:" << path;
+            emit dataPathInfo("Błąd importu pliku: " + path);
+            return false;
+        }
+        qDebug() << "Import strumieniowy pliku:" << path;
+        return true;
+    }
     QJsonObject data;
-    if (format.toLower() == "json") {
+    if (type == "json") {
         data = loadFromJson(path);
-    } else if (format.toLower() == "xml") {
-        data = loadFromXml(path);
     } else {
         qDebug() << "Nieobsługiwany format importu:" << format;
         emit dataPathInfo("Nieobsługiwany format importu: " + path);
@@ -871,80 +1221,106 @@ bool MainWindow::importDataFromFile(const QString& path, const QString& format)
         emit dataPathInfo("Brak ważnych danych z pliku: " + path);
         return false;
     }
-    if (!data.contains("sensorInfo") || !data.contains("key") || !data.contains("values")) {
-        qDebug() << "Zaimportowane dane nie zawierają wymaganych pól";
-        emit dataPathInfo("Niekompletne dane w pliku: " + path);
+    QString error;
+    if (!HistoryImporter::validate(data, &error)) {
+        qDebug() << "Zaimportowane dane są niepoprawne:" << error;
+        emit dataPathInfo("Niekompletne dane w pliku: " + path + " (" + error + ")");
         return false;
     }
-    QJsonObject sensorInfo = data["sensorInfo"].toObject();
-    int sensorId = sensorInfo["id"].toInt();
-    QString dateKey = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    const int sensorId = HistoryImporter::sensorIdOf(data);
+    const QByteArray hash = HistoryImporter::payloadHash(SeriesCodec::encodeRecord(data, historyStore->codecSettings()));
+    if (HistoryImporter::isImported(historyStore, sensorId, HistoryImporter::preferredDateKey(data), hash, nullptr)) {
+        qDebug() << "Plik był już zaimportowany:" << path;
+        emit dataPathInfo("Plik był już zaimportowany: " + path);
+        return true;
+    }
+    /// Klucz z saveDate pliku, jak przy imporcie katalogu; zajęty klucz jest przesuwany, by nie nadpisać rekordu.
+    const QString dateKey = HistoryImporter::uniqueDateKey(historyStore, sensorId, data, nullptr);
     if (!saveToHistoryFile(sensorId, data, dateKey)) {
         qDebug() << "Błąd zapisu zaimportowanych danych do historii";
         return false;
     }
+    /// Zaimportowany rekord może zawierać punkty, których zapisany stan autozapisu nie zna.
+    historyWriter.reset();
     qDebug() << "Pomyślnie zaimportowano dane dla czujnika ID:" << sensorId;
     return true;
 }
 
 /**
- * @brief Usuwa dane historyczne dla podanego klucza daty.
- * @param dateKey Klucz daty do usunięcia.
- * @return True, jeśli usunięcie się powiodło; false w przeciwnym razie.
+ * @brief Importuje w tle pliki z katalogu.
+ * Pliki są parsowane i sprawdzane w puli wątków, a poprawne zapisywane w historii jedną paczką;
+ * postęp przekazuje sygnał importProgress, a wynik importFinished.
+ * @param path Katalog z plikami (lub pojedynczy plik).
+ * @param patterns Wzorce nazw oddzielone spacją, np. "*.json *.xml" (pusty = oba formaty).
+ * @param recursive Czy przeglądać podkatalogi.
+ * @return True, jeśli import wystartował.
  */
-bool MainWindow::deleteHistoricalData(const QString& dateKey)
+bool MainWindow::importDirectory(const QString& path, const QString& patterns, bool recursive)
 {
-    QString historyPath = getDataDirectory() + "/air_quality_history.json";
-    QFile historyFile(historyPath);
-    QJsonObject history;
-    if (!historyFile.exists() || !historyFile.open(QIODevice::ReadOnly)) {
-        qDebug() << "Brak pliku historii lub błąd otwarcia:" << historyFile.errorString();
-        emit dataPathInfo("Brak pliku historii: " + historyPath);
+    if (isImportRunning()) {
         return false;
     }
-    QJsonDocument doc = QJsonDocument::fromJson(historyFile.readAll());
-    historyFile.close();
-    if (doc.isNull()) {
-        qDebug() << "Nieprawidłowy JSON w pliku historii:" << historyPath;
-        emit dataPathInfo("Błąd: Nieprawidłowy JSON w pliku " + historyPath);
+    if (!historyStore->isOpen()) {
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
         return false;
     }
-    history = doc.object();
-    bool modified = false;
-    for (auto it = history.begin(); it != history.end(); ++it) {
-        QJsonObject sensorHistory = it.value().toObject();
-        if (sensorHistory.contains(dateKey)) {
-            sensorHistory.remove(dateKey);
-            history[it.key()] = sensorHistory;
-            modified = true;
-        }
+    QStringList nameFilters = patterns.split(' ', Qt::SkipEmptyParts);
+    if (nameFilters.isEmpty()) {
+        nameFilters << "*.json" << "*.xml";
     }
-    if (!modified) {
-        qDebug() << "Brak danych dla klucza daty:" << dateKey;
+    const QStringList files = HistoryImporter::findFiles(path, nameFilters, recursive);
+    if (files.isEmpty()) {
+        qDebug() << "Brak plików do importu w:" << path << nameFilters;
+        emit dataPathInfo("Brak plików do importu w: " + path);
         return false;
     }
-    QString tempPath = historyPath + ".tmp";
-    QFile tempFile(tempPath);
-    if (!tempFile.open(QIODevice::WriteOnly)) {
-        qDebug() << "Błąd otwierania pliku tymczasowego do zapisu:" << tempFile.errorString();
-        emit dataPathInfo("Błąd zapisu: Brak dostępu do pliku " + tempPath);
-        return false;
+    qDebug() << "Import" << files.size() << "plików z:" << path;
+    return historyImporter->start(files);
+}
+
+/**
+ * @brief Anuluje import w toku: z katalogu nic nie zostanie zapisane, z pliku strumieniowego
+ * zostają paczki zapisane przed anulowaniem.
+ */
+void MainWindow::cancelImport()
+{
+    historyImporter->cancel();
+    streamingImporter->cancel();
+}
+
+/**
+ * @brief Informuje, czy trwa import katalogu lub pliku.
+ * @return True, jeśli import jest w toku (wtedy emituje komunikat).
+ */
+bool MainWindow::isImportRunning()
+{
+    if (historyImporter->isRunning() || streamingImporter->isRunning()) {
+        emit dataPathInfo("Import jest już w toku");
+        return true;
     }
-    QJsonDocument newDoc(history);
-    tempFile.write(newDoc.toJson());
-    tempFile.close();
-    if (historyFile.exists() && !historyFile.remove()) {
-        qDebug() << "Błąd usuwania starego pliku historii:" << historyFile.errorString();
-        emit dataPathInfo("Błąd zapisu: Nie można usunąć starego pliku " + historyPath);
+    return false;
+}
+
+/**
+ * @brief Usuwa dane historyczne dla podanego klucza daty.
+ * @param dateKey Klucz daty do usunięcia.
+ * @return True, jeśli usunięcie się powiodło; false w przeciwnym razie.
+ */
+bool MainWindow::deleteHistoricalData(const QString& dateKey)
+{
+    if (!historyStore->isOpen()) {
+        qDebug() << "Magazyn historii nie jest otwarty:" << historyStore->directory();
+        emit dataPathInfo("Brak magazynu historii: " + historyStore->directory());
         return false;
     }
-    if (!tempFile.rename(historyPath)) {
-        qDebug() << "Błąd zmiany nazwy pliku tymczasowego:" << tempFile.errorString();
-        emit dataPathInfo("Błąd zapisu: Problem z zapisem pliku " + historyPath);
+    int removed = historyStore->removeDateKey(dateKey);
+    historyWriter.reset();
+    if (removed == 0) {
+        qDebug() << "Brak danych dla klucza daty:" << dateKey;
         return false;
     }
-    qDebug() << "Pomyślnie usunięto dane historyczne dla klucza daty:" << dateKey;
-    emit dataPathInfo("Usunięto dane historyczne: " + historyPath);
+    qDebug() << "Pomyślnie usunięto dane historyczne dla klucza daty:" << dateKey << "rekordy:" << removed;
+    emit dataPathInfo("Usunięto dane historyczne: " + historyStore->directory());
     return true;
 }
 
@@ -11,8 +11,8 @@
  * @brief Główna klasa aplikacji, odpowiedzialna za zarządzanie danymi, komunikację z API oraz interakcję z QML.
  */
 #include <QObject>
-#include <QNetworkAccessManager> ///< Do wysyłania żądań sieciowych.
-#include <QNetworkReply>        ///< Do obsługi odpowiedzi sieciowych.
+#include "apidispatcher.h"     ///< Do wysyłania żądań do API GIOŚ.
+#include "replyparser.h"       ///< Do parsowania odpowiedzi poza wątkiem GUI.
 #include <QJsonDocument>       ///< Do pracy z danymi JSON.
 #include <QJsonArray>          ///< Do przechowywania tablic JSON.
 #include <QJsonObject>         ///< Do przechowywania obiektów JSON.
@@ -23,10 +23,29 @@
 #include <QStandardPaths>      ///< Do znajdowania standardowych ścieżek.
 #include <QDateTime>           ///< Do obsługi dat i czasu.
 #include <QTimer>              ///< Do zadań cyklicznych, np. autosave.
+#include "historystore.h"      ///< Do segmentowego magazynu historii.
+#include "deltahistorywriter.h" ///< Do autozapisu tylko nowych pomiarów.
+#include "historyimporter.h"   ///< Do równoległego importu katalogu plików.
+#include "streamingimporter.h" ///< Do strumieniowego importu dużych plików XML i CSV.
+#include "measurementcache.h"  ///< Do pamięci podręcznej pomiarów.
+#include "measurementseries.h" ///< Do kolumnowego szeregu pomiarów.
+#include "stationsearchindex.h" ///< Do wyszukiwania stacji.
+#include "stationspatialindex.h" ///< Do wyszukiwania stacji w pobliżu punktu.
+#include "stationlistmodel.h"   ///< Do modelu listy stacji dla QML.
+#include "measurementtablemodel.h" ///< Do modelu tabeli pomiarów dla QML.
+#include "chartseriesloader.h"  ///< Do przenoszenia pomiarów na wykres.
+#include "measurementprefetcher.h" ///< Do równoległego pobierania pomiarów czujników.
+#include "jsonstreamparser.h" ///< Do wczytywania listy stacji w miarę nadchodzenia danych.
+#include "sessionsnapshot.h"   ///< Do szybkiego startu z migawki ostatniej sesji.
+#include "seriesstatistics.h"  ///< Do statystyk wyświetlanego szeregu.
+#include "statskernels.h"     ///< Do wektorowych statystyk długich szeregów historycznych.
+#include "stationaggregator.h" ///< Do zestawień zanieczyszczenia dla wielu stacji.
 
 class MainWindow : public QObject
 {
     Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+    Q_PROPERTY(StationListModel* stationModel READ stationModel CONSTANT) ///< Model listy stacji dla QML.
+    Q_PROPERTY(MeasurementTableModel* measurementModel READ measurementModel CONSTANT) ///< Model tabeli pomiarów dla QML.
 
 public:
     /// Konstruktor klasy, inicjalizuje obiekt z opcjonalnym rodzicem.
@@ -34,10 +53,21 @@ public:
     /// Destruktor, zwalnia zasoby obiektu.
     ~MainWindow();
 
+    /// Zwraca model listy stacji wyświetlanej w QML.
+    StationListModel* stationModel() const { return stationListModel; }
+    /// Zwraca model tabeli wyświetlanych pomiarów.
+    MeasurementTableModel* measurementModel() const { return measurementTableModel; }
+
     /// Wyszukuje stacje pomiarowe na podstawie tekstu (np. nazwa miasta).
     Q_INVOKABLE void searchStations(const QString& searchText);
     /// Wyświetla wszystkie dostępne stacje pomiarowe.
     Q_INVOKABLE void showAllStations();
+    /// Zwraca k stacji najbliższych punktowi, od najbliższej.
+    Q_INVOKABLE QVariantList nearestStations(double lat, double lon, int count);
+    /// Zwraca stacje w promieniu (km) od punktu, od najbliższej.
+    Q_INVOKABLE QVariantList stationsWithinRadius(double lat, double lon, double radiusKm);
+    /// Zwraca stacje wewnątrz prostokąta współrzędnych (np. widoczny fragment mapy).
+    Q_INVOKABLE QVariantList stationsInBoundingBox(double minLat, double minLon, double maxLat, double maxLon);
     /// Obsługuje wybór stacji na podstawie jej ID.
     Q_INVOKABLE void stationSelected(int stationId);
     /// Obsługuje wybór czujnika na podstawie jego ID.
@@ -46,118 +76,212 @@ public:
     Q_INVOKABLE void loadHistoricalData(int sensorId, const QString& dateKey);
     /// Zwraca listę dostępnych historycznych danych dla czujnika.
     Q_INVOKABLE QStringList getAvailableHistoricalData(int sensorId);
-    /// Oblicza statystyki dla danych z czujnika.
+    /// Zwraca statystyki wyświetlanego szeregu (policzone przy jego wyświetleniu).
     Q_INVOKABLE QVariantMap computeStatistics(int sensorId);
-    /// Importuje dane z pliku w podanym formacie (np. JSON, XML).
+    /// Liczy w tle statystyki całej zapisanej historii czujnika z przekroczeniami progu; wynik w historyStatisticsUpdated.
+    Q_INVOKABLE void historyStatistics(int sensorId, double threshold);
+    /// Zwraca agregaty historii czujnika ("hour", "day" lub "month") z przedziału czasu (ms od epoki).
+    Q_INVOKABLE QVariantList historyTrend(int sensorId, const QString& tier, double fromTime, double toTime);
+    /// Wypełnia serię wykresu średnimi z agregatów historii i zwraca zakres osi.
+    Q_INVOKABLE QVariantMap fillTrendSeries(QObject* chartSeries, int sensorId, const QString& tier, double fromTime, double toTime);
+    /// Zestawia w tle średnią, minimum i maksimum parametru (paramCode) dla stacji regionu; wynik w stationsAggregated.
+    Q_INVOKABLE void aggregateStations(const QString& paramCode, const QString& regionField,
+                                              const QString& regionValue, double fromTime, double toTime);
+    /// Wypełnia serię wykresu wyświetlanymi pomiarami (zdecymowanymi do szerokości) i zwraca zakres osi.
+    Q_INVOKABLE QVariantMap fillChartSeries(QObject* chartSeries, int widthPixels);
+    /// Ponownie decymuje widoczny przedział po zmianie rozmiaru lub przybliżenia; zwraca liczbę punktów.
+    Q_INVOKABLE int refreshChartSeries(QObject* chartSeries, int widthPixels, double fromTime, double toTime);
+    /// Importuje dane z pliku JSON; pliki XML i CSV są importowane strumieniowo w tle (wynik w importFinished).
     Q_INVOKABLE bool importDataFromFile(const QString& path, const QString& format);
+    /// Importuje w tle pliki JSON i XML z katalogu (wzorce oddzielone spacją); wynik w importFinished.
+    Q_INVOKABLE bool importDirectory(const QString& path, const QString& patterns, bool recursive);
+    /// Anuluje import katalogu lub pliku w toku.
+    Q_INVOKABLE void cancelImport();
     /// Usuwa historyczne dane dla podanego klucza daty.
     Q_INVOKABLE bool deleteHistoricalData(const QString& dateKey);
     /// Ponawia połączenie z API w razie problemów sieciowych.
     Q_INVOKABLE void retryConnection();
+    /// Pokazuje stację, czujniki i pomiary przywrócone z migawki; zwraca ID czujnika (0, jeśli brak).
+    Q_INVOKABLE int restoreSession();
 
 signals:
-    /// Informuje QML o aktualizacji listy stacji.
-    void stationsUpdateRequested(const QVariantList& stations);
     /// Przekazuje dane wybranej stacji (ID, nazwa, adres, miasto, współrzędne).
     void stationInfoUpdateRequested(int stationId, const QString& stationName, const QString& addressStreet, const QString& city, const QString& lat, const QString& lon);
     /// Informuje o aktualizacji listy czujników.
     void sensorsUpdateRequested(const QVariantList& sensors);
-    /// Przekazuje nowe pomiary dla czujnika.
-    void measurementsUpdateRequested(const QString& key, const QVariantList& values);
+    /// Informuje o nowych wyświetlanych pomiarach (klucz i liczba punktów z wartością).
+    void measurementsUpdateRequested(const QString& key, int count);
     /// Aktualizuje informacje o jakości powietrza (tekst i kolor).
     void airQualityUpdateRequested(const QString& text, const QString& color);
     /// Przekazuje listę dostępnych historycznych danych.
     void historicalDataListUpdated(const QStringList& dataList);
     /// Przekazuje obliczone statystyki.
     void statisticsUpdated(const QVariantMap& stats);
+    /// Przekazuje statystyki historii czujnika (pusta mapa, jeśli brak danych).
+    void historyStatisticsUpdated(int sensorId, const QVariantMap& stats);
     /// Informuje o statusie automatycznego zapisu.
     void autoSaveStatus(const QString& message, bool success);
     /// Przekazuje ścieżkę zapisu danych.
     void dataPathInfo(const QString& path);
+    /// Informuje o postępie importu katalogu (przetworzone pliki z wszystkich).
+    void importProgress(int done, int total);
+    /// Informuje o zakończeniu importu katalogu (zapisane i odrzucone pliki, opisy błędów).
+    void importFinished(int imported, int failed, const QStringList& errors);
+    /// Przekazuje zestawienie stacji (szczegóły w StationAggregator::toVariantMap; pusta mapa przy błędzie).
+    void stationsAggregated(const QVariantMap& summary);
 
 private slots:
+    /// Dopisuje stacje z kolejnego fragmentu odpowiedzi API.
+    void onStationsChunk(const ApiRequest& request, const QByteArray& chunk);
     /// Obsługuje odpowiedź API z listą stacji.
-    void onStationsReceived();
+    void onStationsReceived(const ApiReply& reply);
     /// Obsługuje odpowiedź API z listą czujników.
-    void onSensorsReceived();
-    /// Obsługuje odpowiedź API z pomiarami.
-    void onMeasurementsReceived();
+    void onSensorsReceived(const ApiReply& reply);
+    /// Obsługuje pobrane pomiary czujnika (wybranego lub pobranego z wyprzedzeniem).
+    void onMeasurementsFetched(int sensorId, const MeasurementSeries& series);
+    /// Obsługuje błąd pobierania pomiarów czujnika.
+    void onMeasurementsFetchFailed(int sensorId, const QString& error);
     /// Obsługuje odpowiedź API z indeksem jakości powietrza.
-    void onAirQualityIndexReceived();
+    void onAirQualityIndexReceived(const ApiReply& reply);
     /// Automatycznie zapisuje pomiary w tle.
     void autoSaveMeasurements();
 
 private:
-    /// Manager do żądań sieciowych.
-    QNetworkAccessManager* networkManager;
+    /// Dyspozytor żądań API (łączy identyczne żądania, pomija nieaktualne).
+    ApiDispatcher* apiDispatcher;
     /// Timer do cyklicznego zapisu danych.
     QTimer* autoSaveTimer;
+    /// Równoległe pobieranie pomiarów wszystkich czujników wybranej stacji.
+    MeasurementPrefetcher* measurementPrefetcher;
+    /// Maksymalna liczba równoległych żądań pobierania z wyprzedzeniem.
+    const int PREFETCH_MAX_CONCURRENT = 4;
+    /// Magazyn danych historycznych (segmenty tylko-do-dopisywania).
+    HistoryStore* historyStore;
+    /// Zapis do historii tylko nowych i zmienionych pomiarów.
+    DeltaHistoryWriter historyWriter;
+    /// Równoległy import plików do magazynu historii.
+    HistoryImporter* historyImporter;
+    /// Strumieniowy import dużych plików XML i CSV.
+    StreamingImporter* streamingImporter;
+    /// Timer do okresowego kompaktowania magazynu historii.
+    QTimer* compactionTimer;
+
+    /// Nazwa katalogu segmentów historii.
+    const QString HISTORY_DIRNAME = "history";
+    /// Nazwa starego pliku historii (JSON), przenoszonego do segmentów przy starcie.
+    const QString LEGACY_HISTORY_FILENAME = "air_quality_history.json";
+    /// Interwał sprawdzania potrzeby kompaktowania (minuty).
+    const int COMPACTION_INTERVAL_MINUTES = 10;
 
     /// Bazowy adres API GIOS.
     const QString API_BASE_URL = "https://api.gios.gov.pl/pjp-api/rest/";
-    /// Endpoint API dla listy stacji.
-    const QString API_STATIONS_ENDPOINT = "station/findAll";
-    /// Endpoint API dla czujników stacji.
-    const QString API_SENSORS_ENDPOINT = "station/sensors/";
-    /// Endpoint API dla pomiarów czujnika.
-    const QString API_MEASUREMENTS_ENDPOINT = "data/getData/";
-    /// Endpoint API dla indeksu jakości powietrza.
-    const QString API_AIR_QUALITY_ENDPOINT = "aqindex/getIndex/";
+    /// Nazwa katalogu pamięci podręcznej HTTP.
+    const QString HTTP_CACHE_DIRNAME = "http_cache";
+    /// Maksymalny rozmiar pamięci podręcznej HTTP (bajty).
+    const qint64 HTTP_CACHE_MAX_BYTES = 50 * 1024 * 1024;
 
     /// Lista wszystkich stacji (JSON).
     QJsonArray allStations;
     /// Mapa ID stacji na ich dane.
     QMap<int, QJsonObject> stationsMap;
+    /// Indeks wyszukiwania stacji, budowany po pobraniu listy stacji.
+    StationSearchIndex stationSearchIndex;
+    /// Indeks przestrzenny stacji (gegrLat/gegrLon), budowany razem z mapą stacji.
+    StationSpatialIndex stationSpatialIndex;
+    /// Model listy stacji; filtrowanie zmienia tylko różniące się wiersze.
+    StationListModel* stationListModel;
+    /// Parser odpowiedzi station/findAll w toku (stacje i indeksy powstają w puli wątków).
+    JsonStreamParser<StationsParseResult>* stationStream = nullptr;
+    /// Czy stacje są dopisywane do modelu na bieżąco (tylko gdy model był pusty).
+    bool streamStationsToModel = false;
     /// Mapa ID czujników na ich dane.
     QMap<int, QJsonObject> sensorsMap;
-    /// Aktualne pomiary dla wybranego czujnika.
-    QJsonObject currentMeasurements;
+    /// Aktualne pomiary dla wybranego czujnika (postać kolumnowa).
+    MeasurementSeries currentSeries;
+    /// Pomiary aktualnie wyświetlane na wykresie i w tabeli (bieżące lub historyczne); źródło displayedStatistics.
+    MeasurementSeries displayedSeries;
+    /// Statystyki wyświetlanego szeregu.
+    SeriesStatistics displayedStatistics;
+    /// Wszystkie punkty wyświetlanego szeregu (pełna rozdzielczość, rosnąco według czasu).
+    QVector<QPointF> chartPoints;
+    /// Model tabeli wyświetlanych pomiarów.
+    MeasurementTableModel* measurementTableModel;
     /// ID aktualnie wybranego czujnika.
     int currentSensorId;
+    /// ID aktualnie wybranej stacji (odpowiedzi dla innych stacji są pomijane).
+    int currentStationId;
 
     /// Zwraca katalog zapisu danych.
     QString getDataDirectory();
+    /// Otwiera magazyn historii i przenosi do niego stary plik JSON.
+    void openHistoryStore();
     /// Zapisuje dane pomiarowe do pliku historii.
     bool saveToHistoryFile(int sensorId, const QJsonObject& data, const QString& dateKey);
     /// Ładuje dane z pliku JSON.
     QJsonObject loadFromJson(const QString& filename);
-    /// Ładuje dane z pliku XML.
-    QJsonObject loadFromXml(const QString& filename);
+    /// Informuje, czy trwa import katalogu lub pliku (emituje komunikat, jeśli tak).
+    bool isImportRunning();
 
     /// Pobiera listę stacji z API.
     void fetchStations();
+    /// Przywraca w modelu ostatnią poprawną listę stacji po nieudanym strumieniu.
+    void discardStreamedStations();
+    /// Powtarza aktywne wyszukiwanie stacji po wczytaniu listy od nowa.
+    void reapplyStationFilter();
     /// Pobiera czujniki dla stacji z API.
     void fetchSensors(int stationId);
     /// Pobiera pomiary dla czujnika z API.
     void fetchMeasurements(int sensorId);
     /// Pobiera indeks jakości powietrza z API.
     void fetchAirQualityIndex(int stationId);
-    /// Wyświetla stacje w interfejsie QML.
-    void displayStations(const QJsonArray& stations);
+    /// Zwraca podstawowe dane stacji z położeniem dla QML.
+    QVariantMap stationLocation(int stationId) const;
+    /// Zamienia wyniki indeksu przestrzennego na listę stacji z odległością dla QML.
+    QVariantList stationHitsToList(const QVector<StationSpatialIndex::Hit>& hits) const;
     /// Generuje informacje o stacji.
     QString generateStationInfo(const QJsonObject& station);
 
     /// Czas ważności cache (godziny).
     const int CACHE_VALIDITY_HOURS = 24;
-    /// Nazwa pliku cache.
-    const QString CACHE_FILENAME = "air_quality_cache.json";
+    /// Maksymalna liczba czujników w pamięci podręcznej.
+    const int CACHE_MAX_ENTRIES = 256;
+    /// Opóźnienie zbiorczego zapisu cache na dysk (sekundy).
+    const int CACHE_FLUSH_INTERVAL_SECONDS = 30;
+    /// Nazwa pliku cache (binarny format SeriesCodec).
+    const QString CACHE_FILENAME = "air_quality_cache.dat";
+    /// Nazwa pliku cache zapisanego przez starsze wersje (JSON).
+    const QString LEGACY_CACHE_FILENAME = "air_quality_cache.json";
+    /// Pamięć podręczna pomiarów, wczytywana raz przy starcie.
+    MeasurementCache* measurementCache;
+
+    /// Nazwa pliku migawki sesji.
+    const QString SNAPSHOT_FILENAME = "session.snapshot";
+    /// Czy stan zmienił się od ostatniego zapisu migawki.
+    bool snapshotDirty = false;
+    /// Czy wybór stacji przywrócony z migawki czeka na pokazanie w QML.
+    bool sessionPending = false;
+    /// Wczytuje migawkę sesji: listę stacji, wybraną stację i czujnik oraz jego pomiary.
+    void loadSnapshot();
+    /// Zapisuje migawkę sesji, jeśli stan się zmienił.
+    bool saveSnapshot();
 
     /// Zwraca ścieżkę do pliku cache.
     QString getCachePath();
-    /// Zapisuje dane do cache.
-    bool saveToCacheFile(const QJsonObject& cacheData);
-    /// Ładuje dane z cache.
-    QJsonObject loadFromCacheFile();
-    /// Sprawdza ważność cache dla czujnika.
-    bool isCacheValid(int sensorId);
-    /// Aktualizuje cache dla czujnika.
-    void updateCache(int sensorId, const QJsonObject& data);
-    /// Pobiera dane z cache dla czujnika.
-    QJsonObject getFromCache(int sensorId);
-    /// Usuwa stare dane z cache.
-    void cleanupOldCache();
     /// Przetwarza i wyświetla pomiary w interfejsie.
-    void processAndDisplayMeasurements(const QJsonObject& measurements);
+    void processAndDisplayMeasurements(const MeasurementSeries& series);
+    /// Ustawia wyświetlany szereg w tabeli i informuje QML o nowych danych.
+    void showSeries(const QString& key, const MeasurementSeries& series);
+    /// Rekordy czujnika skopiowane do statystyk historii w puli wątków.
+    struct HistoryRecords {
+        QVector<QByteArray> payloads; ///< Treści rekordów w kolejności kluczy dat.
+        double threshold = 0.0;       ///< Próg przekroczeń.
+    };
+    /// Scala rekordy (najnowszy zapis punktu wygrywa) i podsumowuje wynik (pula wątków).
+    static QVariantMap summarizeHistory(const HistoryRecords& records);
+    /// Zwraca agregaty historii czujnika dla nazwy poziomu z QML.
+    QVector<HistoryRollups::Bucket> trendBuckets(int sensorId, const QString& tier, double fromTime, double toTime) const;
+    /// Stacje i parametry czujników (z list czujników stacji lub z zapisanej historii), według ID czujnika.
+    QHash<int, StationAggregator::SensorInfo> sensorCatalog;
 };
 
 #endif // MAINWINDOW_H
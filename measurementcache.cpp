@@ -0,0 +1,316 @@
+#include "measurementcache.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QFile>               ///< Biblioteka do odczytu pliku.
+#include <QSaveFile>           ///< Biblioteka do atomowego zapisu pliku.
+#include <QJsonDocument>       ///< Biblioteka do pracy z danymi JSON.
+#include <QDataStream>         ///< Biblioteka do binarnego zapisu wpisów.
+#include "seriescodec.h"       ///< Do kodowania szeregów w pliku.
+
+/**
+ * @file measurementcache.cpp
+ * @brief Implementacja klasy MeasurementCache, pamięci podręcznej pomiarów z opóźnionym zapisem.
+ *
+ * Format pliku: nagłówek SeriesCodec::pack() ze znacznikiem "AQCM", a w treści (QDataStream) liczba wpisów
+ * i dla każdego: ID czujnika, czas pobrania (ms od epoki) i szereg zakodowany przez SeriesCodec::encodeSeries().
+ */
+
+namespace {
+/// Znacznik pliku pamięci podręcznej ("AQCM").
+const quint32 CACHE_MAGIC = 0x4151434D;
+}
+
+/**
+ * @brief Konstruktor klasy MeasurementCache.
+ * @param filePath Ścieżka do pliku pamięci podręcznej.
+ * @param ttlSeconds Czas ważności wpisu w sekundach.
+ * @param capacity Maksymalna liczba wpisów w pamięci.
+ * @param parent Opcjonalny rodzic obiektu.
+ */
+MeasurementCache::MeasurementCache(const QString& filePath, int ttlSeconds, int capacity, QObject *parent)
+    : QObject(parent), cachePath(filePath), ttl(ttlSeconds), maxEntries(capacity), useCounter(0), dirty(false),
+      compressionLevel(6)
+{
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(30000);
+    connect(flushTimer, &QTimer::timeout, this, &MeasurementCache::flush);
+}
+
+/**
+ * @brief Destruktor klasy MeasurementCache.
+ * Zapisuje zmiany, które nie trafiły jeszcze na dysk.
+ */
+MeasurementCache::~MeasurementCache()
+{
+    flush();
+}
+
+/**
+ * @brief Wczytuje wpisy z pliku pamięci podręcznej.
+ * Przeterminowane wpisy są pomijane i znikną z pliku przy następnym zapisie. Plik JSON starszej wersji
+ * jest rozpoznawany po braku znacznika formatu.
+ * @return True, jeśli plik wczytano; false, jeśli go brak lub jest uszkodzony.
+ */
+bool MeasurementCache::load()
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Brak pliku pamięci podręcznej:" << cachePath;
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    entries.clear();
+    QByteArray body;
+    if (SeriesCodec::unpack(data, CACHE_MAGIC, &body)) {
+        if (!loadBinary(body)) {
+            qDebug() << "Uszkodzony plik pamięci podręcznej:" << cachePath;
+            entries.clear();
+            return false;
+        }
+    } else if (!loadJson(data)) {
+        qDebug() << "Nieprawidłowy JSON w pliku pamięci podręcznej:" << cachePath;
+        return false;
+    } else {
+        /// Plik w starym formacie zostanie przepisany przy najbliższym zapisie.
+        markDirty();
+    }
+    evictOverCapacity();
+    qDebug() << "Wczytano pamięć podręczną:" << entries.size() << "wpisów z" << cachePath;
+    return true;
+}
+
+/**
+ * @brief Zapisuje wszystkie ważne wpisy do pliku jednym zapisem.
+ * @return True, jeśli nie było zmian lub zapis się powiódł.
+ */
+bool MeasurementCache::flush()
+{
+    flushTimer->stop();
+    if (!dirty) {
+        return true;
+    }
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    quint32 count = 0;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        count += isFresh(it.value()) ? 1 : 0;
+    }
+    out << count;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        if (isFresh(it.value())) {
+            out << qint32(it.key()) << qint64(it->timestamp.toMSecsSinceEpoch())
+                << SeriesCodec::encodeSeries(it->series);
+        }
+    }
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Błąd otwierania pliku pamięci podręcznej do zapisu:" << file.errorString();
+        emit flushed(cachePath, false);
+        return false;
+    }
+    file.write(SeriesCodec::pack(body, CACHE_MAGIC, compressionLevel));
+    if (!file.commit()) {
+        qDebug() << "Błąd zapisu pamięci podręcznej:" << file.errorString();
+        emit flushed(cachePath, false);
+        return false;
+    }
+    dirty = false;
+    qDebug() << "Zapisano pamięć podręczną do:" << cachePath << "wpisów:" << count;
+    emit flushed(cachePath, true);
+    return true;
+}
+
+/**
+ * @brief Sprawdza, czy istnieje ważny wpis dla czujnika.
+ * @param sensorId ID czujnika.
+ * @return True, jeśli wpis istnieje i nie jest przeterminowany.
+ */
+bool MeasurementCache::contains(int sensorId) const
+{
+    auto it = entries.constFind(sensorId);
+    return it != entries.constEnd() && isFresh(it.value());
+}
+
+/**
+ * @brief Zwraca pomiary czujnika z pamięci bez dostępu do dysku.
+ * @param sensorId ID czujnika.
+ * @return Szereg pomiarów lub pusty szereg, jeśli brak ważnego wpisu.
+ */
+MeasurementSeries MeasurementCache::value(int sensorId)
+{
+    auto it = entries.find(sensorId);
+    if (it == entries.end()) {
+        return MeasurementSeries();
+    }
+    if (!isFresh(it.value())) {
+        entries.erase(it);
+        markDirty();
+        return MeasurementSeries();
+    }
+    it->lastUsed = ++useCounter;
+    return it->series;
+}
+
+/**
+ * @brief Dodaje lub zastępuje wpis dla czujnika i planuje zapis.
+ * @param sensorId ID czujnika.
+ * @param series Sparsowane pomiary.
+ */
+void MeasurementCache::insert(int sensorId, const MeasurementSeries& series)
+{
+    Entry entry;
+    entry.series = series;
+    entry.timestamp = QDateTime::currentDateTime();
+    entry.lastUsed = ++useCounter;
+    entries.insert(sensorId, entry);
+    evictOverCapacity();
+    markDirty();
+}
+
+/**
+ * @brief Zwraca liczbę wpisów w pamięci.
+ * @return Liczba wpisów.
+ */
+int MeasurementCache::size() const
+{
+    return entries.size();
+}
+
+/**
+ * @brief Informuje, czy są zmiany niezapisane na dysku.
+ * @return True, jeśli pamięć różni się od pliku.
+ */
+bool MeasurementCache::isDirty() const
+{
+    return dirty;
+}
+
+/**
+ * @brief Ustawia opóźnienie zbiorczego zapisu.
+ * @param msec Opóźnienie w milisekundach.
+ */
+void MeasurementCache::setFlushInterval(int msec)
+{
+    flushTimer->setInterval(msec);
+}
+
+/**
+ * @brief Ustawia poziom kompresji pliku; obowiązuje od następnego zapisu.
+ * @param level Poziom qCompress 0..9 (0 = bez kompresji).
+ */
+void MeasurementCache::setCompressionLevel(int level)
+{
+    compressionLevel = qBound(0, level, 9);
+}
+
+/**
+ * @brief Zwraca ścieżkę pliku pamięci podręcznej.
+ * @return Ścieżka do pliku.
+ */
+QString MeasurementCache::filePath() const
+{
+    return cachePath;
+}
+
+/**
+ * @brief Sprawdza, czy wpis mieści się w czasie ważności.
+ * @param entry Wpis pamięci podręcznej.
+ * @return True, jeśli wpis jest ważny.
+ */
+bool MeasurementCache::isFresh(const Entry& entry) const
+{
+    return entry.timestamp.isValid() && entry.timestamp.secsTo(QDateTime::currentDateTime()) < ttl;
+}
+
+/**
+ * @brief Usuwa najdawniej używane wpisy, dopóki liczba wpisów przekracza limit.
+ */
+void MeasurementCache::evictOverCapacity()
+{
+    while (entries.size() > maxEntries) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->lastUsed < oldest->lastUsed) {
+                oldest = it;
+            }
+        }
+        entries.erase(oldest);
+        dirty = true;
+    }
+}
+
+/**
+ * @brief Oznacza pamięć jako zmienioną i uruchamia timer zapisu, jeśli jeszcze nie działa.
+ */
+void MeasurementCache::markDirty()
+{
+    dirty = true;
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+/**
+ * @brief Wczytuje wpisy z treści pliku binarnego.
+ * @param body Treść pliku po SeriesCodec::unpack().
+ * @return True, jeśli wszystkie wpisy udało się odczytać.
+ */
+bool MeasurementCache::loadBinary(const QByteArray& body)
+{
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count; ++i) {
+        qint32 sensorId = 0;
+        qint64 timestamp = 0;
+        QByteArray encoded;
+        in >> sensorId >> timestamp >> encoded;
+        Entry entry;
+        if (in.status() != QDataStream::Ok || !SeriesCodec::decodeSeries(encoded, &entry.series)) {
+            return false;
+        }
+        entry.timestamp = QDateTime::fromMSecsSinceEpoch(timestamp);
+        addLoaded(sensorId, entry);
+    }
+    return true;
+}
+
+/**
+ * @brief Wczytuje wpisy z pliku JSON zapisanego przez starszą wersję programu.
+ * @param data Zawartość pliku.
+ * @return True, jeśli plik zawiera poprawny JSON.
+ */
+bool MeasurementCache::loadJson(const QByteArray& data)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(data);
+    if (doc.isNull()) {
+        return false;
+    }
+    const QJsonObject cache = doc.object();
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        const QJsonObject sensorCache = it.value().toObject();
+        Entry entry;
+        entry.timestamp = QDateTime::fromString(sensorCache["timestamp"].toString(), Qt::ISODate);
+        entry.series = MeasurementSeries::fromJson(sensorCache["data"].toObject());
+        addLoaded(it.key().toInt(), entry);
+    }
+    return true;
+}
+
+/**
+ * @brief Dodaje wczytany wpis; przeterminowany jest pomijany i zniknie z pliku przy następnym zapisie.
+ * @param sensorId ID czujnika.
+ * @param entry Wczytany wpis.
+ */
+void MeasurementCache::addLoaded(int sensorId, Entry entry)
+{
+    entry.lastUsed = ++useCounter;
+    if (isFresh(entry)) {
+        entries.insert(sensorId, entry);
+    } else {
+        dirty = true;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef MEASUREMENTCACHE_H
+#define MEASUREMENTCACHE_H
+
+/**
+ * @file measurementcache.h
+ * @brief Plik nagłówkowy dla klasy MeasurementCache, pamięci podręcznej pomiarów w pamięci operacyjnej.
+ */
+
+#include <QObject>
+#include <QHash>               ///< Do przechowywania wpisów według ID czujnika.
+#include "measurementseries.h" ///< Do przechowywania sparsowanych pomiarów.
+#include <QDateTime>           ///< Do obsługi czasu ważności wpisów.
+#include <QTimer>              ///< Do opóźnionego zapisu na dysk.
+
+/**
+ * @class MeasurementCache
+ * @brief Pamięć podręczna pomiarów trzymana w pamięci, z czasem ważności (TTL) i usuwaniem LRU.
+ *
+ * Plik jest wczytywany i parsowany raz przy starcie. Zmiany oznaczają pamięć jako zmienioną i są zapisywane
+ * na dysk zbiorczo po upływie interwału zapisu lub przy zamknięciu programu.
+ *
+ * Szeregi w pliku są kodowane przez SeriesCodec i kompresowane qCompress; plik JSON zapisany przez
+ * starszą wersję jest wczytywany bez zmian i zastępowany formatem binarnym przy następnym zapisie.
+ */
+class MeasurementCache : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Konstruktor, przyjmuje ścieżkę pliku, czas ważności wpisów (sekundy) i maksymalną liczbę wpisów.
+    MeasurementCache(const QString& filePath, int ttlSeconds, int capacity, QObject *parent = nullptr);
+    /// Destruktor, zapisuje niezapisane zmiany.
+    ~MeasurementCache();
+
+    /// Wczytuje wpisy z pliku (pomija przeterminowane).
+    bool load();
+    /// Zapisuje wszystkie ważne wpisy na dysk, jeśli są niezapisane zmiany.
+    bool flush();
+    /// Sprawdza, czy istnieje ważny wpis dla czujnika.
+    bool contains(int sensorId) const;
+    /// Zwraca pomiary czujnika (oznacza wpis jako ostatnio użyty); pusty szereg, jeśli brak.
+    MeasurementSeries value(int sensorId);
+    /// Dodaje lub zastępuje wpis dla czujnika.
+    void insert(int sensorId, const MeasurementSeries& series);
+    /// Zwraca liczbę wpisów w pamięci.
+    int size() const;
+    /// Informuje, czy są zmiany niezapisane na dysku.
+    bool isDirty() const;
+    /// Ustawia opóźnienie zbiorczego zapisu (milisekundy).
+    void setFlushInterval(int msec);
+    /// Ustawia poziom kompresji pliku (0..9, 0 = bez kompresji).
+    void setCompressionLevel(int level);
+    /// Zwraca ścieżkę pliku pamięci podręcznej.
+    QString filePath() const;
+
+signals:
+    /// Informuje o wyniku zapisu pliku pamięci podręcznej.
+    void flushed(const QString& path, bool success);
+
+private:
+    /// Wpis pamięci podręcznej.
+    struct Entry {
+        MeasurementSeries series; ///< Sparsowane pomiary.
+        QDateTime timestamp;   ///< Czas pobrania danych.
+        quint64 lastUsed = 0;  ///< Licznik ostatniego użycia (LRU).
+    };
+
+    /// Sprawdza, czy wpis nie jest przeterminowany.
+    bool isFresh(const Entry& entry) const;
+    /// Usuwa najdawniej używane wpisy ponad limit.
+    void evictOverCapacity();
+    /// Oznacza pamięć jako zmienioną i planuje zapis.
+    void markDirty();
+    /// Wczytuje wpisy z treści pliku binarnego; false, jeśli jest uszkodzona.
+    bool loadBinary(const QByteArray& body);
+    /// Wczytuje wpisy z pliku JSON starszej wersji; false, jeśli jest uszkodzony.
+    bool loadJson(const QByteArray& data);
+    /// Dodaje wczytany wpis, jeśli jest ważny.
+    void addLoaded(int sensorId, Entry entry);
+
+    /// Ścieżka pliku pamięci podręcznej.
+    QString cachePath;
+    /// Czas ważności wpisu (sekundy).
+    int ttl;
+    /// Maksymalna liczba wpisów.
+    int maxEntries;
+    /// Wpisy według ID czujnika.
+    QHash<int, Entry> entries;
+    /// Licznik użyć dla LRU.
+    quint64 useCounter;
+    /// Czy są niezapisane zmiany.
+    bool dirty;
+    /// Timer zbiorczego zapisu.
+    QTimer* flushTimer;
+    /// Poziom kompresji pliku.
+    int compressionLevel;
+};
+
+#endif // MEASUREMENTCACHE_H
@@ -0,0 +1,194 @@
+#include "measurementprefetcher.h"
+#include <QDebug>             ///< Biblioteka do logowania komunikatów debugowania.
+
+/**
+ * @file measurementprefetcher.cpp
+ * @brief Implementacja klasy MeasurementPrefetcher, równoległego pobierania pomiarów czujników.
+ */
+
+/**
+ * @brief Konstruktor klasy MeasurementPrefetcher.
+ * @param dispatcher Dyspozytor żądań współdzielony z resztą aplikacji.
+ * @param maxConcurrent Limit równoległych żądań z kolejki.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+MeasurementPrefetcher::MeasurementPrefetcher(ApiDispatcher* dispatcher, int maxConcurrent, QObject *parent)
+    : QObject(parent), dispatcher(dispatcher), concurrencyLimit(qMax(1, maxConcurrent))
+{
+}
+
+/**
+ * @brief Ustawia limit równoległych żądań i w razie potrzeby wysyła kolejne z kolejki.
+ * @param maxConcurrent Nowy limit (co najmniej 1).
+ */
+void MeasurementPrefetcher::setMaxConcurrent(int maxConcurrent)
+{
+    concurrencyLimit = qMax(1, maxConcurrent);
+    startQueued();
+}
+
+/**
+ * @brief Zastępuje kolejkę czujnikami nowej stacji.
+ * @param sensorIds Czujniki do pobrania.
+ * @param prioritySensorId Czujnik oglądany przez użytkownika (0, jeśli brak).
+ */
+void MeasurementPrefetcher::prefetch(const QList<int>& sensorIds, int prioritySensorId)
+{
+    queue.clear();
+    for (int sensorId : sensorIds) {
+        if (sensorId != prioritySensorId && !inFlight.contains(sensorId) && !queue.contains(sensorId)) {
+            queue.append(sensorId);
+        }
+    }
+    if (prioritySensorId > 0) {
+        fetchNow(prioritySensorId);
+    }
+    startQueued();
+}
+
+/**
+ * @brief Dopisuje czujniki na koniec kolejki (np. kolejne stacje w trybie zbierania danych).
+ * @param sensorIds Czujniki do pobrania.
+ */
+void MeasurementPrefetcher::enqueue(const QList<int>& sensorIds)
+{
+    for (int sensorId : sensorIds) {
+        if (!inFlight.contains(sensorId) && !queue.contains(sensorId)) {
+            queue.append(sensorId);
+        }
+    }
+    startQueued();
+}
+
+/**
+ * @brief Pobiera czujnik natychmiast, z pominięciem limitu równoległości.
+ * @param sensorId ID czujnika.
+ */
+void MeasurementPrefetcher::fetchNow(int sensorId)
+{
+    queue.removeAll(sensorId);
+    if (!inFlight.contains(sensorId)) {
+        start(sensorId);
+    }
+}
+
+/**
+ * @brief Informuje, czy czujnik czeka w kolejce lub jest w toku.
+ * @param sensorId ID czujnika.
+ * @return True, jeśli pomiary czujnika są w drodze.
+ */
+bool MeasurementPrefetcher::isPending(int sensorId) const
+{
+    return inFlight.contains(sensorId) || queue.contains(sensorId);
+}
+
+/**
+ * @brief Usuwa czekające żądania.
+ */
+void MeasurementPrefetcher::clearQueue()
+{
+    queue.clear();
+}
+
+/**
+ * @brief Wysyła żądania z kolejki do osiągnięcia limitu.
+ */
+void MeasurementPrefetcher::startQueued()
+{
+    while (!queue.isEmpty() && inFlight.size() < concurrencyLimit) {
+        start(queue.takeFirst());
+    }
+}
+
+/**
+ * @brief Wysyła żądanie getData dla czujnika.
+ * @param sensorId ID czujnika.
+ */
+void MeasurementPrefetcher::start(int sensorId)
+{
+    inFlight.insert(sensorId);
+    /// Elementy tablicy "values" trafiają do szeregu w puli wątków, a klucz pochodzi ze szkieletu odpowiedzi.
+    streams.insert(sensorId, new JsonStreamParser<MeasurementSeries>(2, [](MeasurementSeries* series, const QJsonObject& measurement) {
+        series->appendFromJson(measurement);
+    }, [](MeasurementSeries* series, const QJsonDocument& skeleton) {
+        if (!skeleton.isObject()) {
+            return false;
+        }
+        series->setKey(skeleton.object()["key"].toString());
+        return true;
+    }, this));
+    dispatcher->get(ApiEndpoint::Measurements, sensorId, this, [this](const ApiReply& reply) {
+        onReplyFinished(reply);
+    }, false, [this](const ApiRequest& request, const QByteArray& chunk) {
+        onReplyChunk(request, chunk);
+    });
+}
+
+/**
+ * @brief Przekazuje kolejny fragment odpowiedzi do parsowania w puli wątków.
+ * @param request Metadane żądania (ID czujnika).
+ * @param chunk Kolejne bajty treści.
+ */
+void MeasurementPrefetcher::onReplyChunk(const ApiRequest& request, const QByteArray& chunk)
+{
+    JsonStreamParser<MeasurementSeries>* stream = streams.value(request.id);
+    if (stream) {
+        stream->feed(chunk);
+    }
+}
+
+/**
+ * @brief Kończy parsowanie strumienia, a wynik przekazuje do odbiorców.
+ * Pełna treść (dostępna tylko, gdy żądanie dzielił oczekujący bez onChunk) jest parsowana, jeśli strumień
+ * okazał się niekompletny lub błędny.
+ * @param reply Odpowiedź z metadanymi żądania (ID czujnika).
+ */
+void MeasurementPrefetcher::onReplyFinished(const ApiReply& reply)
+{
+    const int sensorId = reply.request.id;
+    JsonStreamParser<MeasurementSeries>* stream = streams.take(sensorId);
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania pomiarów czujnika ID:" << sensorId << ":" << reply.errorString;
+        if (stream) {
+            stream->deleteLater();
+        }
+        inFlight.remove(sensorId);
+        emit fetchFailed(sensorId, "Błąd pobierania danych");
+        startQueued();
+        return;
+    }
+    if (!stream) {
+        parseBody(sensorId, reply.body);
+        return;
+    }
+    const QByteArray body = reply.body;
+    stream->finish([this, stream, sensorId, body](bool ok, const MeasurementSeries& series) {
+        stream->deleteLater();
+        if (ok) {
+            inFlight.remove(sensorId);
+            emit measurementsFetched(sensorId, series);
+            startQueued();
+        } else {
+            parseBody(sensorId, body);
+        }
+    });
+}
+
+/**
+ * @brief Parsuje pełną treść odpowiedzi w puli wątków, a wynik przekazuje do odbiorców.
+ * @param sensorId ID czujnika.
+ * @param body Treść odpowiedzi (pusta, jeśli była tylko przesyłana fragmentami).
+ */
+void MeasurementPrefetcher::parseBody(int sensorId, const QByteArray& body)
+{
+    ReplyParser::run(this, &ReplyParser::parseMeasurements, body, [this, sensorId](const MeasurementsParseResult& result) {
+        inFlight.remove(sensorId);
+        if (result.ok) {
+            emit measurementsFetched(sensorId, result.series);
+        } else {
+            qDebug() << "Nieprawidłowa odpowiedź JSON dla pomiarów czujnika ID:" << sensorId;
+            emit fetchFailed(sensorId, "Błąd danych");
+        }
+        startQueued();
+    });
+}
@@ -0,0 +1,86 @@
+#ifndef MEASUREMENTPREFETCHER_H
+#define MEASUREMENTPREFETCHER_H
+
+/**
+ * @file measurementprefetcher.h
+ * @brief Plik nagłówkowy dla klasy MeasurementPrefetcher, równoległego pobierania pomiarów czujników.
+ */
+
+#include <QObject>
+#include <QSet>                 ///< Do czujników w toku.
+#include <QList>                ///< Do kolejki czujników.
+#include <QHash>                ///< Do strumieni odpowiedzi w toku.
+#include "apidispatcher.h"      ///< Do wysyłania żądań getData.
+#include "replyparser.h"        ///< Do parsowania pomiarów poza wątkiem GUI.
+#include "measurementseries.h"  ///< Do sparsowanych pomiarów.
+#include "jsonstreamparser.h"  ///< Do parsowania pomiarów w miarę nadchodzenia danych.
+
+/**
+ * @class MeasurementPrefetcher
+ * @brief Kolejka żądań getData z limitem równoległości i priorytetem dla oglądanego czujnika.
+ *
+ * Po pobraniu listy czujników stacji wszystkie są kolejkowane i pobierane co najwyżej po maxConcurrent
+ * naraz. Czujnik wybrany przez użytkownika jest wysyłany od razu, z pominięciem limitu. Żądania
+ * przechodzą przez ApiDispatcher, więc identyczne żądania z innych miejsc są łączone w jedno.
+ * Fragmenty odpowiedzi są dzielone i parsowane w puli wątków (JsonStreamParser) w miarę nadchodzenia,
+ * bez buforowania całej treści i bez budowania dokumentu JSON całej odpowiedzi. Czujnik zajmuje miejsce
+ * w limicie do końca parsowania.
+ */
+class MeasurementPrefetcher : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Konstruktor, przyjmuje dyspozytora żądań i limit równoległych żądań.
+    MeasurementPrefetcher(ApiDispatcher* dispatcher, int maxConcurrent, QObject *parent = nullptr);
+
+    /// Ustawia limit równoległych żądań (co najmniej 1).
+    void setMaxConcurrent(int maxConcurrent);
+    /// Zwraca limit równoległych żądań.
+    int maxConcurrent() const { return concurrencyLimit; }
+
+    /// Zastępuje kolejkę czujnikami stacji; czujnik priorytetowy (jeśli > 0) jest wysyłany od razu.
+    void prefetch(const QList<int>& sensorIds, int prioritySensorId = 0);
+    /// Dopisuje czujniki na koniec kolejki (bez usuwania czekających).
+    void enqueue(const QList<int>& sensorIds);
+    /// Pobiera czujnik natychmiast (z pominięciem limitu), chyba że jest już w toku.
+    void fetchNow(int sensorId);
+    /// Informuje, czy czujnik czeka w kolejce lub jest w toku.
+    bool isPending(int sensorId) const;
+    /// Usuwa czekające żądania (żądania w toku kończą się normalnie).
+    void clearQueue();
+    /// Zwraca liczbę czujników czekających w kolejce lub w toku.
+    int pendingCount() const { return queue.size() + inFlight.size(); }
+
+signals:
+    /// Przekazuje pobrane i sparsowane pomiary czujnika.
+    void measurementsFetched(int sensorId, const MeasurementSeries& series);
+    /// Informuje o błędzie pobierania pomiarów czujnika (komunikat do wyświetlenia).
+    void fetchFailed(int sensorId, const QString& error);
+
+private:
+    /// Wysyła żądania z kolejki, dopóki nie osiągnięto limitu.
+    void startQueued();
+    /// Wysyła żądanie dla czujnika.
+    void start(int sensorId);
+    /// Przekazuje kolejny fragment odpowiedzi do parsowania.
+    void onReplyChunk(const ApiRequest& request, const QByteArray& chunk);
+    /// Obsługuje zakończone żądanie.
+    void onReplyFinished(const ApiReply& reply);
+    /// Parsuje pełną treść odpowiedzi (gdy strumień był niekompletny).
+    void parseBody(int sensorId, const QByteArray& body);
+
+    /// Dyspozytor żądań API.
+    ApiDispatcher* dispatcher;
+    /// Limit równoległych żądań z kolejki.
+    int concurrencyLimit;
+    /// Czujniki czekające na wysłanie.
+    QList<int> queue;
+    /// Czujniki, których żądania są w toku.
+    QSet<int> inFlight;
+
+    /// Parsery strumieni odpowiedzi w toku według ID czujnika.
+    QHash<int, JsonStreamParser<MeasurementSeries>*> streams;
+};
+
+#endif // MEASUREMENTPREFETCHER_H
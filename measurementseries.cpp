@@ -0,0 +1,227 @@
+#include "measurementseries.h"
+#include <QDateTime>          ///< Biblioteka do obsługi dat i czasu.
+#include <QJsonArray>         ///< Biblioteka do tablic JSON.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+
+/**
+ * @file measurementseries.cpp
+ * @brief Implementacja klasy MeasurementSeries, kolumnowego szeregu pomiarów.
+ */
+
+namespace {
+/// Format daty używany przez API GIOŚ.
+const QString API_DATE_FORMAT = "yyyy-MM-dd HH:mm:ss";
+
+/// Odczytuje liczbę z cyfr dziesiętnych napisu; -1, jeśli napotkano inny znak.
+int parseDigits(const QString& text, int from, int count)
+{
+    int result = 0;
+    for (int i = from; i < from + count; ++i) {
+        const ushort c = text.at(i).unicode();
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        result = result * 10 + (c - '0');
+    }
+    return result;
+}
+
+/// Zamienia float na double bez szumu rozszerzenia (np. 12.3f -> 12.3, a nie 12.300000190734863).
+double toJsonNumber(float value)
+{
+    return QString::number(value, 'g', 7).toDouble();
+}
+}
+
+/**
+ * @brief Tworzy pusty szereg.
+ */
+MeasurementSeries::MeasurementSeries()
+{
+}
+
+/**
+ * @brief Parsuje dane w formacie API do postaci kolumnowej.
+ * Punkty z nieprawidłową datą są pomijane, a brakujące wartości trafiają do mapy bitowej.
+ * @param measurements Obiekt JSON z kluczem i tablicą wartości.
+ * @return Szereg pomiarów (pusty, jeśli brak tablicy "values").
+ */
+MeasurementSeries MeasurementSeries::fromJson(const QJsonObject& measurements)
+{
+    MeasurementSeries series;
+    series.setKey(measurements["key"].toString());
+    const QJsonArray values = measurements["values"].toArray();
+    series.reserve(values.size());
+    for (const QJsonValue& item : values) {
+        series.appendFromJson(item.toObject());
+    }
+    return series;
+}
+
+/**
+ * @brief Dodaje pojedynczy punkt w formacie API (używane też przy parsowaniu strumieniowym).
+ * @param measurement Obiekt JSON z polami "date" i "value".
+ * @return True, jeśli punkt został dodany (false przy nieprawidłowej dacie).
+ */
+bool MeasurementSeries::appendFromJson(const QJsonObject& measurement)
+{
+    qint64 timestampMs = 0;
+    if (!parseDate(measurement["date"].toString(), &timestampMs)) {
+        return false;
+    }
+    const QJsonValue value = measurement["value"];
+    if (!value.isDouble() || std::isnan(value.toDouble()) || std::isinf(value.toDouble())) {
+        appendNull(timestampMs);
+    } else {
+        append(timestampMs, float(value.toDouble()));
+    }
+    return true;
+}
+
+/**
+ * @brief Zwraca szereg w formacie API, używanym w historii, cache i eksporcie.
+ * @return Obiekt JSON z kluczem i tablicą wartości.
+ */
+QJsonObject MeasurementSeries::toJson() const
+{
+    QJsonArray values;
+    for (int i = 0; i < size(); ++i) {
+        QJsonObject measurement;
+        measurement["date"] = dateString(i);
+        measurement["value"] = isNull(i) ? QJsonValue(QJsonValue::Null) : QJsonValue(toJsonNumber(valueColumn[i]));
+        values.append(measurement);
+    }
+    QJsonObject result;
+    result["key"] = seriesKey;
+    result["values"] = values;
+    return result;
+}
+
+/**
+ * @brief Zwraca klucz szeregu.
+ * @return Kod parametru, np. "PM10".
+ */
+QString MeasurementSeries::key() const
+{
+    return seriesKey;
+}
+
+/**
+ * @brief Ustawia klucz szeregu.
+ * @param key Kod parametru.
+ */
+void MeasurementSeries::setKey(const QString& key)
+{
+    seriesKey = key;
+}
+
+/**
+ * @brief Dodaje punkt z wartością.
+ * @param timestampMs Znacznik czasu (ms od epoki).
+ * @param value Wartość pomiaru.
+ */
+void MeasurementSeries::append(qint64 timestampMs, float value)
+{
+    appendPoint(timestampMs, value, false);
+}
+
+/**
+ * @brief Dodaje punkt bez wartości.
+ * @param timestampMs Znacznik czasu (ms od epoki).
+ */
+void MeasurementSeries::appendNull(qint64 timestampMs)
+{
+    appendPoint(timestampMs, 0.0f, true);
+}
+
+/**
+ * @brief Rezerwuje miejsce w kolumnach.
+ * @param size Oczekiwana liczba punktów.
+ */
+void MeasurementSeries::reserve(int size)
+{
+    timestampColumn.reserve(size);
+    valueColumn.reserve(size);
+    nullMask.reserve((size + 63) / 64);
+}
+
+/**
+ * @brief Usuwa wszystkie punkty i klucz.
+ */
+void MeasurementSeries::clear()
+{
+    seriesKey.clear();
+    timestampColumn.clear();
+    valueColumn.clear();
+    nullMask.clear();
+}
+
+/**
+ * @brief Zlicza punkty z wartością.
+ * @return Liczba punktów, dla których bit braku nie jest ustawiony.
+ */
+int MeasurementSeries::validCount() const
+{
+    int nullCount = 0;
+    for (quint64 word : nullMask) {
+        while (word) {
+            word &= word - 1;
+            ++nullCount;
+        }
+    }
+    return size() - nullCount;
+}
+
+/**
+ * @brief Zwraca datę punktu w formacie API.
+ * @param i Indeks punktu.
+ * @return Data w formacie "yyyy-MM-dd HH:mm:ss" (czas lokalny).
+ */
+QString MeasurementSeries::dateString(int i) const
+{
+    return QDateTime::fromMSecsSinceEpoch(timestampColumn[i]).toString(API_DATE_FORMAT);
+}
+
+/**
+ * @brief Parsuje datę w formacie API ("yyyy-MM-dd HH:mm:ss") lub ISO 8601.
+ * @param date Tekst daty.
+ * @param timestampMs Wynikowy znacznik czasu (ms od epoki, czas lokalny).
+ * @return True, jeśli datę udało się odczytać.
+ */
+bool MeasurementSeries::parseDate(const QString& date, qint64* timestampMs)
+{
+    if (date.length() == 19 && date.at(4) == '-' && date.at(7) == '-'
+        && (date.at(10) == ' ' || date.at(10) == 'T') && date.at(13) == ':' && date.at(16) == ':') {
+        const QDate day(parseDigits(date, 0, 4), parseDigits(date, 5, 2), parseDigits(date, 8, 2));
+        const QTime time(parseDigits(date, 11, 2), parseDigits(date, 14, 2), parseDigits(date, 17, 2));
+        if (day.isValid() && time.isValid()) {
+            *timestampMs = QDateTime(day, time).toMSecsSinceEpoch();
+            return true;
+        }
+    }
+    const QDateTime dateTime = QDateTime::fromString(date, Qt::ISODate);
+    if (!dateTime.isValid()) {
+        return false;
+    }
+    *timestampMs = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+/**
+ * @brief Dodaje punkt do kolumn i aktualizuje mapę bitową braków.
+ * @param timestampMs Znacznik czasu (ms od epoki).
+ * @param value Wartość pomiaru.
+ * @param null Czy punkt nie ma wartości.
+ */
+void MeasurementSeries::appendPoint(qint64 timestampMs, float value, bool null)
+{
+    const int i = timestampColumn.size();
+    if ((i & 63) == 0) {
+        nullMask.append(0);
+    }
+    if (null) {
+        nullMask[i >> 6] |= quint64(1) << (i & 63);
+    }
+    timestampColumn.append(timestampMs);
+    valueColumn.append(value);
+}
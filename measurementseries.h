@@ -0,0 +1,89 @@
+#ifndef MEASUREMENTSERIES_H
+#define MEASUREMENTSERIES_H
+
+/**
+ * @file measurementseries.h
+ * @brief Plik nagłówkowy dla klasy MeasurementSeries, kolumnowej reprezentacji szeregu pomiarów.
+ */
+
+#include <QString>
+#include <QVector>             ///< Do ciągłych kolumn znaczników czasu i wartości.
+#include <QJsonObject>         ///< Do konwersji z/do formatu API.
+#include <QMetaType>           ///< Do przekazywania szeregu w sygnałach.
+
+/**
+ * @class MeasurementSeries
+ * @brief Szereg czasowy pomiarów przechowywany kolumnowo.
+ *
+ * Znaczniki czasu (ms od epoki) i wartości (float) leżą w ciągłych tablicach, a brakujące wartości
+ * oznacza mapa bitowa. Dane z API, cache i historii są parsowane do tej postaci jeden raz.
+ */
+class MeasurementSeries
+{
+public:
+    /// Tworzy pusty szereg.
+    MeasurementSeries();
+
+    /// Parsuje obiekt w formacie API ({"key", "values": [{"date", "value"}]}).
+    static MeasurementSeries fromJson(const QJsonObject& measurements);
+    /// Zwraca szereg w formacie API.
+    QJsonObject toJson() const;
+
+    /// Zwraca klucz szeregu (kod parametru).
+    QString key() const;
+    /// Ustawia klucz szeregu.
+    void setKey(const QString& key);
+
+    /// Dodaje punkt z wartością.
+    void append(qint64 timestampMs, float value);
+    /// Dodaje punkt bez wartości.
+    void appendNull(qint64 timestampMs);
+    /// Dodaje punkt w formacie API ({"date", "value"}); false, jeśli data jest nieprawidłowa.
+    bool appendFromJson(const QJsonObject& measurement);
+    /// Rezerwuje miejsce na podaną liczbę punktów.
+    void reserve(int size);
+    /// Usuwa wszystkie punkty i klucz.
+    void clear();
+
+    /// Zwraca liczbę punktów.
+    int size() const { return timestampColumn.size(); }
+    /// Informuje, czy szereg nie ma punktów.
+    bool isEmpty() const { return timestampColumn.isEmpty(); }
+    /// Zwraca liczbę punktów z wartością.
+    int validCount() const;
+    /// Zwraca znacznik czasu punktu (ms od epoki).
+    qint64 timestamp(int i) const { return timestampColumn[i]; }
+    /// Zwraca wartość punktu (nieokreśloną dla punktu bez wartości).
+    float value(int i) const { return valueColumn[i]; }
+    /// Informuje, czy punkt nie ma wartości.
+    bool isNull(int i) const { return (nullMask[i >> 6] >> (i & 63)) & 1; }
+    /// Zwraca datę punktu w formacie API ("yyyy-MM-dd HH:mm:ss").
+    QString dateString(int i) const;
+
+    /// Zwraca kolumnę znaczników czasu.
+    const QVector<qint64>& timestamps() const { return timestampColumn; }
+    /// Zwraca kolumnę wartości.
+    const QVector<float>& values() const { return valueColumn; }
+    /// Zwraca mapę bitową braków (bit 1 = brak wartości), 64 punkty na słowo.
+    const QVector<quint64>& nulls() const { return nullMask; }
+
+    /// Parsuje datę w formacie API do ms od epoki; false, jeśli format jest nieprawidłowy.
+    static bool parseDate(const QString& date, qint64* timestampMs);
+
+private:
+    /// Dodaje punkt i ustawia bit braku.
+    void appendPoint(qint64 timestampMs, float value, bool null);
+
+    /// Klucz szeregu.
+    QString seriesKey;
+    /// Znaczniki czasu (ms od epoki).
+    QVector<qint64> timestampColumn;
+    /// Wartości pomiarów.
+    QVector<float> valueColumn;
+    /// Mapa bitowa braków wartości.
+    QVector<quint64> nullMask;
+};
+
+Q_DECLARE_METATYPE(MeasurementSeries)
+
+#endif // MEASUREMENTSERIES_H
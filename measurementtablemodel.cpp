@@ -0,0 +1,99 @@
+#include "measurementtablemodel.h"
+#include <QDateTime>          ///< Biblioteka do formatowania dat.
+
+/**
+ * @file measurementtablemodel.cpp
+ * @brief Implementacja klasy MeasurementTableModel, modelu tabeli pomiarów dla QML.
+ */
+
+namespace {
+/// Format daty wyświetlany w tabeli.
+const QString TABLE_DATE_FORMAT = "dd.MM.yyyy HH:mm";
+}
+
+/**
+ * @brief Konstruktor klasy MeasurementTableModel.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+MeasurementTableModel::MeasurementTableModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+/**
+ * @brief Zwraca liczbę wierszy.
+ * @param parent Indeks rodzica (model jest płaską listą).
+ * @return Liczba punktów z wartością.
+ */
+int MeasurementTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+/**
+ * @brief Zwraca dane punktu dla roli.
+ * @param index Indeks wiersza.
+ * @param role Rola danych.
+ * @return Wartość roli lub pusty QVariant.
+ */
+QVariant MeasurementTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rows.size()) {
+        return QVariant();
+    }
+    const int i = rows[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+    case DateRole:
+        return QDateTime::fromMSecsSinceEpoch(series.timestamp(i)).toString(TABLE_DATE_FORMAT);
+    case ValueRole:
+        return double(series.value(i));
+    case TimestampRole:
+        return double(series.timestamp(i));
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Zwraca nazwy ról używane w delegacie QML.
+ * @return Mapa roli na nazwę.
+ */
+QHash<int, QByteArray> MeasurementTableModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[DateRole] = "date";
+    roles[ValueRole] = "value";
+    roles[TimestampRole] = "timestamp";
+    return roles;
+}
+
+/**
+ * @brief Podmienia wyświetlany szereg jednym resetem modelu.
+ * @param newSeries Szereg pomiarów.
+ */
+void MeasurementTableModel::setSeries(const MeasurementSeries& newSeries)
+{
+    const int oldCount = rows.size();
+    beginResetModel();
+    series = newSeries;
+    rows.clear();
+    rows.reserve(series.validCount());
+    for (int i = 0; i < series.size(); ++i) {
+        if (!series.isNull(i)) {
+            rows.append(i);
+        }
+    }
+    endResetModel();
+    if (rows.size() != oldCount) {
+        emit countChanged();
+    }
+}
+
+/**
+ * @brief Czyści tabelę.
+ */
+void MeasurementTableModel::clear()
+{
+    setSeries(MeasurementSeries());
+}
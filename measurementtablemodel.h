@@ -0,0 +1,59 @@
+#ifndef MEASUREMENTTABLEMODEL_H
+#define MEASUREMENTTABLEMODEL_H
+
+/**
+ * @file measurementtablemodel.h
+ * @brief Plik nagłówkowy dla klasy MeasurementTableModel, modelu tabeli pomiarów dla QML.
+ */
+
+#include <QAbstractListModel>
+#include <QVector>             ///< Do indeksów wyświetlanych punktów.
+#include "measurementseries.h" ///< Do wyświetlanego szeregu pomiarów.
+
+/**
+ * @class MeasurementTableModel
+ * @brief Model tabeli "Dane surowe" (role: date, value, timestamp) oparty bezpośrednio na szeregu kolumnowym.
+ *
+ * Szereg jest podmieniany jednym resetem modelu; daty są formatowane dopiero przy odczycie wiersza,
+ * więc koszt zależy od liczby widocznych wierszy, a nie od długości szeregu.
+ */
+class MeasurementTableModel : public QAbstractListModel
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged) ///< Liczba wierszy (dla QML).
+
+public:
+    /// Role danych dostępne w delegacie QML.
+    enum Roles {
+        DateRole = Qt::UserRole + 1, ///< Data w formacie "dd.MM.yyyy HH:mm".
+        ValueRole,                   ///< Wartość pomiaru.
+        TimestampRole                ///< Znacznik czasu (ms od epoki).
+    };
+
+    /// Konstruktor, tworzy pusty model.
+    explicit MeasurementTableModel(QObject *parent = nullptr);
+
+    /// Zwraca liczbę wierszy.
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    /// Zwraca dane wiersza dla roli.
+    QVariant data(const QModelIndex& index, int role) const override;
+    /// Zwraca nazwy ról używane w QML.
+    QHash<int, QByteArray> roleNames() const override;
+
+    /// Podmienia wyświetlany szereg (pokazywane są tylko punkty z wartością).
+    void setSeries(const MeasurementSeries& series);
+    /// Czyści tabelę.
+    void clear();
+
+signals:
+    /// Informuje o zmianie liczby wierszy.
+    void countChanged();
+
+private:
+    /// Wyświetlany szereg.
+    MeasurementSeries series;
+    /// Indeksy punktów z wartością, w kolejności szeregu.
+    QVector<int> rows;
+};
+
+#endif // MEASUREMENTTABLEMODEL_H
@@ -1,8 +1,8 @@
 ## @file project.pro
 ## @brief Konfiguracja projektu Qt dla aplikacji QML z modułami sieciowymi i wykresami.
 
-## @brief Moduły Qt: Quick, QML, Network, Charts.
-QT += quick qml network charts
+## @brief Moduły Qt: Quick, QML, Network, Charts, Concurrent.
+QT += quick qml network charts concurrent
 
 ## @brief Standard C++17 dla kompilacji.
 CONFIG += c++17
@@ -10,11 +10,60 @@ CONFIG += c++17
 ## @brief Pliki źródłowe C++.
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    historystore.cpp \
+    measurementcache.cpp \
+    measurementseries.cpp \
+    stationsearchindex.cpp \
+    stationspatialindex.cpp \
+    stationlistmodel.cpp \
+    measurementtablemodel.cpp \
+    chartseriesloader.cpp \
+    measurementprefetcher.cpp \
+    apidispatcher.cpp \
+    apicache.cpp \
+    replyparser.cpp \
+    jsonstreamsplitter.cpp \
+    sessionsnapshot.cpp \
+    stationcollector.cpp \
+    quantiledigest.cpp \
+    seriesstatistics.cpp \
+    statskernels.cpp \
+    historyrollups.cpp \
+    stationaggregator.cpp \
+    deltahistorywriter.cpp \
+    seriescodec.cpp \
+    historyimporter.cpp \
+    streamingimporter.cpp
 
 ## @brief Pliki nagłówkowe.
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    historystore.h \
+    measurementcache.h \
+    measurementseries.h \
+    stationsearchindex.h \
+    stationspatialindex.h \
+    stationlistmodel.h \
+    measurementtablemodel.h \
+    chartseriesloader.h \
+    measurementprefetcher.h \
+    apidispatcher.h \
+    apicache.h \
+    replyparser.h \
+    jsonstreamsplitter.h \
+    jsonstreamparser.h \
+    sessionsnapshot.h \
+    stationcollector.h \
+    quantiledigest.h \
+    seriesstatistics.h \
+    statskernels.h \
+    historyrollups.h \
+    stationaggregator.h \
+    deltahistorywriter.h \
+    seriescodec.h \
+    historyimporter.h \
+    streamingimporter.h
 
 ## @brief Zasoby QML projektu.
 RESOURCES += qml.qrc
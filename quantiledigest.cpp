@@ -0,0 +1,136 @@
+#include "quantiledigest.h"
+#include <algorithm>          ///< Biblioteka do sortowania.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+#include <limits>             ///< Biblioteka do wartości granicznych typów.
+
+/**
+ * @file quantiledigest.cpp
+ * @brief Implementacja klasy QuantileDigest, przybliżonych kwantyli w stałej pamięci.
+ */
+
+namespace {
+/// Stała pi.
+const double PI = 3.14159265358979323846;
+/// Liczba wartości w buforze, po której następuje scalenie.
+const int BUFFER_SIZE = 256;
+}
+
+/**
+ * @brief Konstruktor klasy QuantileDigest.
+ * @param compression Współczynnik kompresji (większy = dokładniej, więcej centroidów).
+ */
+QuantileDigest::QuantileDigest(double compression)
+    : compression(compression), totalWeight(0.0),
+      minValue(std::numeric_limits<double>::max()), maxValue(std::numeric_limits<double>::lowest())
+{
+}
+
+/**
+ * @brief Dodaje wartość do bufora; pełny bufor jest scalany z centroidami.
+ * @param value Wartość pomiaru.
+ */
+void QuantileDigest::add(double value)
+{
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    buffer.append(value);
+    if (buffer.size() >= BUFFER_SIZE) {
+        compress();
+    }
+}
+
+/**
+ * @brief Scala bufor z centroidami jednym przebiegiem po posortowanych danych.
+ * Sąsiednie centroidy są łączone, dopóki przyrost funkcji skali nie przekroczy 1.
+ */
+void QuantileDigest::compress()
+{
+    if (buffer.isEmpty()) {
+        return;
+    }
+    QVector<Centroid> all = centroids;
+    all.reserve(centroids.size() + buffer.size());
+    for (double value : buffer) {
+        all.append({value, 1.0});
+    }
+    buffer.clear();
+    std::sort(all.begin(), all.end(), [](const Centroid& a, const Centroid& b) { return a.mean < b.mean; });
+
+    const double total = totalWeight + (all.size() - centroids.size());
+    QVector<Centroid> merged;
+    merged.reserve(int(compression));
+    Centroid current = all.first();
+    double weightSoFar = 0.0;
+    double qLimit = scaleQ(scaleK(0.0) + 1.0);
+    for (int i = 1; i < all.size(); ++i) {
+        const double proposed = current.weight + all[i].weight;
+        if ((weightSoFar + proposed) / total <= qLimit) {
+            current.mean += (all[i].mean - current.mean) * all[i].weight / proposed;
+            current.weight = proposed;
+        } else {
+            weightSoFar += current.weight;
+            merged.append(current);
+            qLimit = scaleQ(scaleK(weightSoFar / total) + 1.0);
+            current = all[i];
+        }
+    }
+    merged.append(current);
+    centroids = merged;
+    totalWeight = total;
+}
+
+/**
+ * @brief Zwraca przybliżony kwantyl przez interpolację między środkami centroidów.
+ * @param q Kwantyl (0..1).
+ * @return Wartość kwantyla lub NaN dla pustego szkicu.
+ */
+double QuantileDigest::quantile(double q) const
+{
+    if (!buffer.isEmpty()) {
+        QuantileDigest merged = *this;
+        merged.compress();
+        return merged.quantile(q);
+    }
+    if (centroids.isEmpty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (centroids.size() == 1) {
+        return centroids.first().mean;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    const double target = q * totalWeight;
+    /// Pierwsza połowa pierwszego centroidu leży między minimum a jego średnią (analogicznie na końcu).
+    double cumulative = centroids.first().weight / 2.0;
+    if (target < cumulative) {
+        return minValue + (centroids.first().mean - minValue) * target / cumulative;
+    }
+    for (int i = 1; i < centroids.size(); ++i) {
+        const double step = (centroids[i - 1].weight + centroids[i].weight) / 2.0;
+        if (target < cumulative + step) {
+            const double t = (target - cumulative) / step;
+            return centroids[i - 1].mean + (centroids[i].mean - centroids[i - 1].mean) * t;
+        }
+        cumulative += step;
+    }
+    const double tail = centroids.last().weight / 2.0;
+    const double t = tail > 0.0 ? std::min(1.0, (target - cumulative) / tail) : 1.0;
+    return centroids.last().mean + (maxValue - centroids.last().mean) * t;
+}
+
+/**
+ * @brief Funkcja skali k1: gęstsze centroidy przy skrajnych kwantylach.
+ */
+double QuantileDigest::scaleK(double q) const
+{
+    return compression / (2.0 * PI) * std::asin(2.0 * q - 1.0);
+}
+
+/**
+ * @brief Odwrotność funkcji skali k1.
+ */
+double QuantileDigest::scaleQ(double k) const
+{
+    const double limit = compression / 4.0;
+    k = std::min(limit, std::max(-limit, k));
+    return (std::sin(k * 2.0 * PI / compression) + 1.0) / 2.0;
+}
@@ -0,0 +1,60 @@
+#ifndef QUANTILEDIGEST_H
+#define QUANTILEDIGEST_H
+
+/**
+ * @file quantiledigest.h
+ * @brief Plik nagłówkowy dla klasy QuantileDigest, przybliżonych kwantyli w stałej pamięci.
+ */
+
+#include <QVector>             ///< Do centroidów i bufora nowych wartości.
+
+/**
+ * @class QuantileDigest
+ * @brief Szkic kwantyli w stylu t-digest (wariant scalający) o ograniczonej liczbie centroidów.
+ *
+ * Nowe wartości trafiają do bufora; po jego zapełnieniu bufor jest scalany z centroidami tak, aby centroidy
+ * przy skrajnych kwantylach były małe (funkcja skali k1 = delta/(2 pi) * asin(2q - 1)). Dzięki temu
+ * p95/p99 są dokładne także dla długich szeregów, a pamięć nie zależy od liczby punktów.
+ */
+class QuantileDigest
+{
+public:
+    /// Konstruktor, przyjmuje współczynnik kompresji (około liczby centroidów).
+    explicit QuantileDigest(double compression = 100.0);
+
+    /// Dodaje wartość (zamortyzowane O(1)).
+    void add(double value);
+    /// Scala bufor z centroidami.
+    void compress();
+    /// Zwraca przybliżony kwantyl q (0..1); NaN, jeśli szkic jest pusty.
+    double quantile(double q) const;
+    /// Zwraca liczbę dodanych wartości.
+    double count() const { return totalWeight + buffer.size(); }
+
+private:
+    /// Centroid: średnia i liczba wartości, które reprezentuje.
+    struct Centroid {
+        double mean;    ///< Średnia wartości centroidu.
+        double weight;  ///< Liczba wartości.
+    };
+
+    /// Zamienia kwantyl na wartość funkcji skali.
+    double scaleK(double q) const;
+    /// Zamienia wartość funkcji skali na kwantyl.
+    double scaleQ(double k) const;
+
+    /// Współczynnik kompresji.
+    double compression;
+    /// Centroidy posortowane według średniej.
+    QVector<Centroid> centroids;
+    /// Wartości jeszcze nie scalone.
+    QVector<double> buffer;
+    /// Łączna waga centroidów.
+    double totalWeight;
+    /// Najmniejsza dodana wartość.
+    double minValue;
+    /// Największa dodana wartość.
+    double maxValue;
+};
+
+#endif // QUANTILEDIGEST_H
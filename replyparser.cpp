@@ -0,0 +1,116 @@
+#include "replyparser.h"
+#include <QJsonDocument>      ///< Biblioteka do pracy z danymi JSON.
+
+/**
+ * @file replyparser.cpp
+ * @brief Implementacja klasy ReplyParser, parsowania odpowiedzi API poza wątkiem GUI.
+ */
+
+/**
+ * @brief Parsuje listę stacji i buduje indeksy (wywoływane w puli wątków).
+ * @param body Treść odpowiedzi station/findAll.
+ * @return Stacje, mapa stacji i indeksy wyszukiwania.
+ */
+StationsParseResult ReplyParser::parseStations(const QByteArray& body)
+{
+    StationsParseResult result;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(body);
+    if (!jsonDoc.isArray()) {
+        return result;
+    }
+    return indexStations(jsonDoc.array());
+}
+
+/**
+ * @brief Buduje mapę stacji i indeksy dla gotowej listy (wywoływane w puli wątków).
+ * @param stations Stacje sparsowane strumieniowo.
+ * @return Stacje, mapa stacji i indeksy wyszukiwania.
+ */
+StationsParseResult ReplyParser::indexStations(const QJsonArray& stations)
+{
+    StationsParseResult result;
+    result.ok = true;
+    result.stations = stations;
+    for (const QJsonValue& value : result.stations) {
+        QJsonObject station = value.toObject();
+        result.stationsMap[station["id"].toInt()] = station;
+    }
+    result.searchIndex.build(result.stations);
+    result.spatialIndex.build(result.stationsMap);
+    return result;
+}
+
+/**
+ * @brief Parsuje listę czujników stacji (wywoływane w puli wątków).
+ * @param body Treść odpowiedzi station/sensors.
+ * @return Mapa czujników i lista dla QML.
+ */
+SensorsParseResult ReplyParser::parseSensors(const QByteArray& body)
+{
+    SensorsParseResult result;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(body);
+    if (!jsonDoc.isArray()) {
+        return result;
+    }
+    return indexSensors(jsonDoc.array());
+}
+
+/**
+ * @brief Buduje mapę czujników i listę dla QML z gotowej tablicy (np. z migawki sesji).
+ * @param sensors Czujniki stacji w formacie API.
+ * @return Mapa czujników i lista dla QML.
+ */
+SensorsParseResult ReplyParser::indexSensors(const QJsonArray& sensors)
+{
+    SensorsParseResult result;
+    result.ok = true;
+    for (const QJsonValue& value : sensors) {
+        QJsonObject sensor = value.toObject();
+        int sensorId = sensor["id"].toInt();
+        result.sensorsMap[sensorId] = sensor;
+        QVariantMap sensorData;
+        sensorData["id"] = sensorId;
+        sensorData["param"] = sensor["param"].toObject()["paramName"].toString();
+        sensorData["code"] = sensor["param"].toObject()["paramCode"].toString();
+        result.sensorsList.append(sensorData);
+    }
+    return result;
+}
+
+/**
+ * @brief Parsuje pomiary czujnika (wywoływane w puli wątków).
+ * @param body Treść odpowiedzi data/getData.
+ * @return Szereg pomiarów.
+ */
+MeasurementsParseResult ReplyParser::parseMeasurements(const QByteArray& body)
+{
+    MeasurementsParseResult result;
+    const QJsonDocument jsonDoc = QJsonDocument::fromJson(body);
+    if (jsonDoc.isNull()) {
+        return result;
+    }
+    result.ok = true;
+    result.series = MeasurementSeries::fromJson(jsonDoc.object());
+    return result;
+}
+
+/**
+ * @brief Parsuje indeks jakości powietrza i dobiera kolor poziomu (wywoływane w puli wątków).
+ * @param body Treść odpowiedzi aqindex/getIndex.
+ * @return Nazwa poziomu i kolor.
+ */
+AirQualityParseResult ReplyParser::parseAirQuality(const QByteArray& body)
+{
+    AirQualityParseResult result;
+    const QJsonObject airQuality = QJsonDocument::fromJson(body).object();
+    if (!airQuality.isEmpty() && airQuality.contains("stIndexLevel") && !airQuality["stIndexLevel"].isNull()) {
+        result.indexLevel = airQuality["stIndexLevel"].toObject()["indexLevelName"].toString();
+        if (result.indexLevel == "Bardzo dobry") result.color = "#00FF00";
+        else if (result.indexLevel == "Dobry") result.color = "#97FF00";
+        else if (result.indexLevel == "Umiarkowany") result.color = "#FFFF00";
+        else if (result.indexLevel == "Dostateczny") result.color = "#FFBB00";
+        else if (result.indexLevel == "Zły") result.color = "#FF0000";
+        else if (result.indexLevel == "Bardzo zły") result.color = "#990000";
+    }
+    return result;
+}
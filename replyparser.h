@@ -0,0 +1,85 @@
+#ifndef REPLYPARSER_H
+#define REPLYPARSER_H
+
+/**
+ * @file replyparser.h
+ * @brief Plik nagłówkowy dla klasy ReplyParser, parsowania odpowiedzi API poza wątkiem GUI.
+ */
+
+#include <QObject>
+#include <QFutureWatcher>      ///< Do odbioru wyników w wątku głównym.
+#include <QtConcurrent>        ///< Do uruchamiania parsowania w puli wątków.
+#include <QJsonArray>          ///< Do listy stacji.
+#include <QJsonObject>         ///< Do danych stacji i czujników.
+#include <QVariantList>        ///< Do listy czujników dla QML.
+#include <QMap>                ///< Do map ID na dane.
+#include "measurementseries.h" ///< Do sparsowanych pomiarów.
+#include "stationsearchindex.h" ///< Do indeksu wyszukiwania stacji.
+#include "stationspatialindex.h" ///< Do indeksu przestrzennego stacji.
+
+/// Sparsowana lista stacji wraz z gotowymi indeksami.
+struct StationsParseResult {
+    bool ok = false;                       ///< Czy odpowiedź była poprawną tablicą JSON.
+    QJsonArray stations;                   ///< Stacje w kolejności z API.
+    QMap<int, QJsonObject> stationsMap;    ///< Mapa ID stacji na dane.
+    StationSearchIndex searchIndex;        ///< Indeks wyszukiwania tekstowego.
+    StationSpatialIndex spatialIndex;      ///< Indeks przestrzenny.
+};
+
+/// Sparsowana lista czujników stacji.
+struct SensorsParseResult {
+    bool ok = false;                       ///< Czy odpowiedź była poprawną tablicą JSON.
+    QMap<int, QJsonObject> sensorsMap;     ///< Mapa ID czujnika na dane.
+    QVariantList sensorsList;              ///< Lista {id, param, code} dla QML.
+};
+
+/// Sparsowane pomiary czujnika.
+struct MeasurementsParseResult {
+    bool ok = false;                       ///< Czy odpowiedź była poprawnym obiektem JSON.
+    MeasurementSeries series;              ///< Szereg pomiarów.
+};
+
+/// Sparsowany indeks jakości powietrza.
+struct AirQualityParseResult {
+    QString indexLevel = "Brak danych";    ///< Nazwa poziomu indeksu.
+    QString color = "#808080";             ///< Kolor poziomu.
+};
+
+/**
+ * @class ReplyParser
+ * @brief Funkcje parsujące odpowiedzi API w puli wątków i przekazujące wynik do wątku głównego.
+ *
+ * Wątek GUI przekazuje surową treść odpowiedzi; JSON, mapy, indeksy i listy dla QML powstają w puli
+ * QtConcurrent. Wynik wraca przez QFutureWatcher (sygnał kolejkowany do wątku obiektu kontekstu),
+ * więc w wątku GUI zostaje jedynie podmiana gotowych danych.
+ */
+class ReplyParser
+{
+public:
+    /// Parsuje listę stacji i buduje indeksy wyszukiwania.
+    static StationsParseResult parseStations(const QByteArray& body);
+    /// Buduje mapę i indeksy dla listy stacji sparsowanej już strumieniowo.
+    static StationsParseResult indexStations(const QJsonArray& stations);
+    /// Parsuje listę czujników stacji.
+    static SensorsParseResult parseSensors(const QByteArray& body);
+    /// Buduje mapę czujników i listę dla QML z gotowej tablicy czujników.
+    static SensorsParseResult indexSensors(const QJsonArray& sensors);
+    /// Parsuje pomiary czujnika.
+    static MeasurementsParseResult parseMeasurements(const QByteArray& body);
+    /// Parsuje indeks jakości powietrza.
+    static AirQualityParseResult parseAirQuality(const QByteArray& body);
+
+    /// Uruchamia parser w puli wątków i wywołuje onParsed z wynikiem w wątku obiektu context.
+    template <typename Result, typename Input, typename Handler>
+    static void run(QObject* context, Result (*parser)(const Input&), const Input& body, Handler onParsed)
+    {
+        QFutureWatcher<Result>* watcher = new QFutureWatcher<Result>(context);
+        QObject::connect(watcher, &QFutureWatcher<Result>::finished, context, [watcher, onParsed]() {
+            onParsed(watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(QtConcurrent::run([parser, body]() { return parser(body); }));
+    }
+};
+
+#endif // REPLYPARSER_H
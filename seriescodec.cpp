@@ -0,0 +1,480 @@
+#include "seriescodec.h"
+#include <QDataStream>        ///< Biblioteka do binarnego kodowania pól.
+#include <QJsonArray>         ///< Biblioteka do tablicy pomiarów.
+#include <QJsonDocument>      ///< Biblioteka do pracy z danymi JSON.
+#include <QtAlgorithms>       ///< Biblioteka do zliczania zer wiodących i końcowych.
+#include <QtEndian>           ///< Biblioteka do konwersji kolejności bajtów.
+#include <cstring>            ///< Biblioteka do kopiowania bitów float.
+
+/**
+ * @file seriescodec.cpp
+ * @brief Implementacja klasy SeriesCodec, zwartego kodowania szeregów i rekordów historii.
+ *
+ * Nagłówek pack(): magic (quint32, big-endian), wersja (quint8), flagi (quint8; bit 0 = qCompress).
+ *
+ * Szereg (QDataStream): klucz, liczba punktów, mapa braków, strumień bitów czasu, strumień bitów wartości.
+ * Czas: pierwszy znacznik (64 bity), pierwsza różnica (64 bity, zigzag), dalej delta-of-delta w zigzag:
+ * '0' = 0, '10' + 7 bitów, '110' + 12 bitów, '1110' + 20 bitów, '1111' + 64 bity.
+ * Wartości (tylko punkty bez braku): pierwsza (32 bity), dalej XOR z poprzednią: '0' = bez zmian,
+ * '10' + bity znaczące w poprzednim oknie, '11' + 5 bitów zer wiodących + 5 bitów (długość - 1) + bity.
+ */
+
+namespace {
+/// Znacznik rekordu historii ("AQSC").
+const quint32 RECORD_MAGIC = 0x41515343;
+/// Wersja formatu.
+const quint8 CODEC_VERSION = 1;
+/// Rozmiar nagłówka (bajty).
+const int CODEC_HEADER_SIZE = 6;
+/// Flaga treści skompresowanej qCompress.
+const quint8 COMPRESSED = 0x01;
+
+/// Zapis strumienia bitów (od najstarszego bitu).
+class BitWriter
+{
+public:
+    /// Dopisuje `bits` najmłodszych bitów wartości (1..64).
+    void write(quint64 value, int bits)
+    {
+        while (bits > 0) {
+            const int take = qMin(bits, 8 - used);
+            const quint32 chunk = quint32(value >> (bits - take)) & ((1u << take) - 1);
+            current = (current << take) | chunk;
+            used += take;
+            bits -= take;
+            if (used == 8) {
+                bytes.append(char(current));
+                current = 0;
+                used = 0;
+            }
+        }
+    }
+    /// Zwraca bajty, dopełniając ostatni zerami.
+    QByteArray finish()
+    {
+        if (used > 0) {
+            bytes.append(char(current << (8 - used)));
+            current = 0;
+            used = 0;
+        }
+        return bytes;
+    }
+
+private:
+    QByteArray bytes;     ///< Pełne bajty.
+    quint32 current = 0;  ///< Niepełny bajt.
+    int used = 0;         ///< Liczba bitów w niepełnym bajcie.
+};
+
+/// Odczyt strumienia bitów zapisanego przez BitWriter.
+class BitReader
+{
+public:
+    explicit BitReader(const QByteArray& data) : data(data) {}
+    /// Odczytuje `bits` bitów (1..64); false po końcu danych.
+    bool read(int bits, quint64* value)
+    {
+        quint64 result = 0;
+        while (bits > 0) {
+            if (bytePos >= data.size()) {
+                return false;
+            }
+            const int available = 8 - bitPos;
+            const int take = qMin(bits, available);
+            const quint32 byte = quint8(data[bytePos]);
+            result = (result << take) | ((byte >> (available - take)) & ((1u << take) - 1));
+            bitPos += take;
+            bits -= take;
+            if (bitPos == 8) {
+                bitPos = 0;
+                ++bytePos;
+            }
+        }
+        *value = result;
+        return true;
+    }
+
+private:
+    const QByteArray& data;  ///< Dane.
+    int bytePos = 0;         ///< Bieżący bajt.
+    int bitPos = 0;          ///< Bieżący bit w bajcie.
+};
+
+/// Koduje liczbę ze znakiem tak, aby małe wartości bezwzględne miały mało bitów.
+quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+/// Odwraca zigzag().
+qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+/// Zwraca bity wartości float.
+quint32 floatBits(float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/// Zwraca float o podanych bitach.
+float bitsFloat(quint32 bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+}
+
+/**
+ * @brief Koduje szereg: czas jako delta-of-delta, wartości jako XOR z poprzednią.
+ * @param series Szereg pomiarów.
+ * @return Zakodowany szereg.
+ */
+QByteArray SeriesCodec::encodeSeries(const MeasurementSeries& series)
+{
+    BitWriter times;
+    qint64 previousDelta = 0;
+    for (int i = 0; i < series.size(); ++i) {
+        const qint64 timestamp = series.timestamp(i);
+        if (i == 0) {
+            times.write(quint64(timestamp), 64);
+            continue;
+        }
+        const qint64 delta = timestamp - series.timestamp(i - 1);
+        if (i == 1) {
+            times.write(zigzag(delta), 64);
+        } else {
+            const quint64 dod = zigzag(delta - previousDelta);
+            if (dod == 0) {
+                times.write(0, 1);
+            } else if (dod < (quint64(1) << 7)) {
+                times.write(0x2, 2);
+                times.write(dod, 7);
+            } else if (dod < (quint64(1) << 12)) {
+                times.write(0x6, 3);
+                times.write(dod, 12);
+            } else if (dod < (quint64(1) << 20)) {
+                times.write(0xE, 4);
+                times.write(dod, 20);
+            } else {
+                times.write(0xF, 4);
+                times.write(dod, 64);
+            }
+        }
+        previousDelta = delta;
+    }
+
+    BitWriter values;
+    bool first = true;
+    quint32 previous = 0;
+    int previousLeading = -1;
+    int previousTrailing = 0;
+    for (int i = 0; i < series.size(); ++i) {
+        if (series.isNull(i)) {
+            continue;
+        }
+        const quint32 bits = floatBits(series.value(i));
+        if (first) {
+            values.write(bits, 32);
+            first = false;
+        } else {
+            const quint32 xored = bits ^ previous;
+            if (xored == 0) {
+                values.write(0, 1);
+            } else {
+                const int leading = int(qCountLeadingZeroBits(xored));
+                const int trailing = int(qCountTrailingZeroBits(xored));
+                if (previousLeading >= 0 && leading >= previousLeading && trailing >= previousTrailing) {
+                    values.write(0x2, 2);
+                    values.write(xored >> previousTrailing, 32 - previousLeading - previousTrailing);
+                } else {
+                    const int meaningful = 32 - leading - trailing;
+                    values.write(0x3, 2);
+                    values.write(quint64(leading), 5);
+                    values.write(quint64(meaningful - 1), 5);
+                    values.write(xored >> trailing, meaningful);
+                    previousLeading = leading;
+                    previousTrailing = trailing;
+                }
+            }
+        }
+        previous = bits;
+    }
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << series.key() << quint32(series.size()) << series.nulls() << times.finish() << values.finish();
+    return data;
+}
+
+/**
+ * @brief Dekoduje szereg zakodowany przez encodeSeries().
+ * @param data Zakodowany szereg.
+ * @param series Zdekodowany szereg.
+ * @return True, jeśli dane były kompletne.
+ */
+bool SeriesCodec::decodeSeries(const QByteArray& data, MeasurementSeries* series)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_5_12);
+    QString key;
+    quint32 size = 0;
+    QVector<quint64> nulls;
+    QByteArray timeBits;
+    QByteArray valueBits;
+    in >> key >> size >> nulls >> timeBits >> valueBits;
+    if (in.status() != QDataStream::Ok || quint64(nulls.size()) != (quint64(size) + 63) / 64) {
+        return false;
+    }
+
+    series->clear();
+    series->setKey(key);
+    series->reserve(int(size));
+    BitReader times(timeBits);
+    BitReader values(valueBits);
+    qint64 timestamp = 0;
+    qint64 delta = 0;
+    bool firstValue = true;
+    quint32 previous = 0;
+    int leading = 0;
+    int trailing = 0;
+    for (quint32 i = 0; i < size; ++i) {
+        quint64 word = 0;
+        if (i == 0) {
+            if (!times.read(64, &word)) {
+                return false;
+            }
+            timestamp = qint64(word);
+        } else if (i == 1) {
+            if (!times.read(64, &word)) {
+                return false;
+            }
+            delta = unzigzag(word);
+            timestamp += delta;
+        } else {
+            /// Liczba jedynek przed zerem (do 4) wybiera szerokość pola.
+            int ones = 0;
+            quint64 bit = 0;
+            while (ones < 4) {
+                if (!times.read(1, &bit)) {
+                    return false;
+                }
+                if (bit == 0) {
+                    break;
+                }
+                ++ones;
+            }
+            if (ones > 0) {
+                static const int WIDTHS[] = {0, 7, 12, 20, 64};
+                if (!times.read(WIDTHS[ones], &word)) {
+                    return false;
+                }
+                delta += unzigzag(word);
+            }
+            timestamp += delta;
+        }
+
+        if ((nulls[int(i >> 6)] >> (i & 63)) & 1) {
+            series->appendNull(timestamp);
+            continue;
+        }
+        if (firstValue) {
+            if (!values.read(32, &word)) {
+                return false;
+            }
+            previous = quint32(word);
+            firstValue = false;
+        } else {
+            quint64 control = 0;
+            if (!values.read(1, &control)) {
+                return false;
+            }
+            if (control == 1) {
+                quint64 newWindow = 0;
+                if (!values.read(1, &newWindow)) {
+                    return false;
+                }
+                if (newWindow == 1) {
+                    quint64 leadingBits = 0;
+                    quint64 lengthBits = 0;
+                    if (!values.read(5, &leadingBits) || !values.read(5, &lengthBits)) {
+                        return false;
+                    }
+                    leading = int(leadingBits);
+                    trailing = 32 - leading - int(lengthBits + 1);
+                    if (trailing < 0) {
+                        return false;
+                    }
+                }
+                if (!values.read(32 - leading - trailing, &word)) {
+                    return false;
+                }
+                previous ^= quint32(word) << trailing;
+            }
+        }
+        series->append(timestamp, bitsFloat(previous));
+    }
+    return true;
+}
+
+/**
+ * @brief Koduje rekord historii.
+ * Jeśli szereg nie odtwarza wszystkich punktów rekordu (np. nieznany format daty), rekord zostaje
+ * zapisany jako zwarty JSON, więc kodowanie nie gubi punktów. Kodowanie nie jest jednak bezstratne:
+ * wartości są zaokrąglane do pojedynczej precyzji (float, ok. 7 cyfr znaczących), jak w MeasurementSeries.
+ * @param record Rekord w formacie API z metadanymi (sensorInfo, saveDate, ...).
+ * @param options Ustawienia kodowania.
+ * @return Zakodowany rekord.
+ */
+QByteArray SeriesCodec::encodeRecord(const QJsonObject& record, const Options& options)
+{
+    const MeasurementSeries series = MeasurementSeries::fromJson(record);
+    if (!options.columnar || !record["values"].isArray() || series.size() != record["values"].toArray().size()) {
+        return QJsonDocument(record).toJson(QJsonDocument::Compact);
+    }
+    QJsonObject metadata = record;
+    metadata.remove("key");
+    metadata.remove("values");
+    return encodeSeriesRecord(series, metadata, options);
+}
+
+/**
+ * @brief Koduje rekord historii z gotowego szeregu (import strumieniowy, bez pośredniej tablicy JSON).
+ * @param series Szereg pomiarów.
+ * @param metadata Pola rekordu inne niż "key" i "values" (sensorInfo, saveDate, ...).
+ * @param options Ustawienia kodowania; bez kodowania kolumnowego rekord jest zapisywany jako zwarty JSON.
+ * @return Zakodowany rekord.
+ */
+QByteArray SeriesCodec::encodeSeriesRecord(const MeasurementSeries& series, const QJsonObject& metadata, const Options& options)
+{
+    if (!options.columnar) {
+        QJsonObject record = series.toJson();
+        for (auto it = metadata.constBegin(); it != metadata.constEnd(); ++it) {
+            record.insert(it.key(), it.value());
+        }
+        return QJsonDocument(record).toJson(QJsonDocument::Compact);
+    }
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << QJsonDocument(metadata).toJson(QJsonDocument::Compact) << encodeSeries(series);
+    return pack(body, RECORD_MAGIC, options.compressionLevel);
+}
+
+/**
+ * @brief Dekoduje rekord do formatu API.
+ * @param data Zakodowany rekord lub zwykły JSON.
+ * @return Rekord ({"key", "values", ...metadane}) lub pusty obiekt przy błędzie.
+ */
+QJsonObject SeriesCodec::decodeRecord(const QByteArray& data)
+{
+    if (!isEncoded(data)) {
+        return QJsonDocument::fromJson(data).object();
+    }
+    MeasurementSeries series;
+    QJsonObject record;
+    if (!decodeRecordSeries(data, &series, &record)) {
+        return QJsonObject();
+    }
+    const QJsonObject values = series.toJson();
+    record["key"] = values["key"];
+    record["values"] = values["values"];
+    return record;
+}
+
+/**
+ * @brief Dekoduje szereg rekordu bez budowania tablicy JSON.
+ * @param data Zakodowany rekord lub zwykły JSON.
+ * @param series Szereg rekordu (nullptr = tylko metadane).
+ * @param metadata Pola rekordu inne niż "key" i "values" (opcjonalnie).
+ * @return True, jeśli rekord był poprawny.
+ */
+bool SeriesCodec::decodeRecordSeries(const QByteArray& data, MeasurementSeries* series, QJsonObject* metadata)
+{
+    if (!isEncoded(data)) {
+        QJsonObject record = QJsonDocument::fromJson(data).object();
+        if (record.isEmpty()) {
+            return false;
+        }
+        if (series) {
+            *series = MeasurementSeries::fromJson(record);
+        }
+        if (metadata) {
+            record.remove("key");
+            record.remove("values");
+            *metadata = record;
+        }
+        return true;
+    }
+    QByteArray body;
+    if (!unpack(data, RECORD_MAGIC, &body)) {
+        return false;
+    }
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    QByteArray metadataJson;
+    QByteArray seriesData;
+    in >> metadataJson >> seriesData;
+    if (in.status() != QDataStream::Ok || (series && !decodeSeries(seriesData, series))) {
+        return false;
+    }
+    if (metadata) {
+        *metadata = QJsonDocument::fromJson(metadataJson).object();
+    }
+    return true;
+}
+
+/**
+ * @brief Informuje, czy dane są rekordem zakodowanym przez SeriesCodec.
+ * @param data Dane rekordu.
+ * @return True, jeśli dane zaczynają się znacznikiem formatu.
+ */
+bool SeriesCodec::isEncoded(const QByteArray& data)
+{
+    return data.size() >= CODEC_HEADER_SIZE && qFromBigEndian<quint32>(data.constData()) == RECORD_MAGIC;
+}
+
+/**
+ * @brief Dodaje nagłówek formatu i kompresuje treść.
+ * @param body Treść.
+ * @param magic Znacznik formatu.
+ * @param compressionLevel Poziom qCompress 0..9 (0 = bez kompresji).
+ * @return Dane z nagłówkiem.
+ */
+QByteArray SeriesCodec::pack(const QByteArray& body, quint32 magic, int compressionLevel)
+{
+    const bool compressed = compressionLevel > 0;
+    QByteArray data(CODEC_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(magic, data.data());
+    data[4] = char(CODEC_VERSION);
+    data[5] = char(compressed ? COMPRESSED : 0);
+    data.append(compressed ? qCompress(body, qMin(compressionLevel, 9)) : body);
+    return data;
+}
+
+/**
+ * @brief Sprawdza nagłówek formatu i rozpakowuje treść.
+ * @param data Dane z nagłówkiem.
+ * @param magic Oczekiwany znacznik formatu.
+ * @param body Rozpakowana treść.
+ * @return True, jeśli nagłówek się zgadza i treść udało się rozpakować.
+ */
+bool SeriesCodec::unpack(const QByteArray& data, quint32 magic, QByteArray* body)
+{
+    if (data.size() < CODEC_HEADER_SIZE || qFromBigEndian<quint32>(data.constData()) != magic
+        || quint8(data[4]) != CODEC_VERSION) {
+        return false;
+    }
+    const QByteArray payload = data.mid(CODEC_HEADER_SIZE);
+    if (!(quint8(data[5]) & COMPRESSED)) {
+        *body = payload;
+        return true;
+    }
+    *body = qUncompress(payload);
+    return !body->isEmpty();
+}
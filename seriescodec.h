@@ -0,0 +1,58 @@
+#ifndef SERIESCODEC_H
+#define SERIESCODEC_H
+
+/**
+ * @file seriescodec.h
+ * @brief Plik nagłówkowy dla klasy SeriesCodec, zwartego kodowania szeregów i rekordów historii.
+ */
+
+#include <QByteArray>          ///< Do zakodowanych danych.
+#include <QJsonObject>         ///< Do rekordów historii.
+#include "measurementseries.h" ///< Do kodowanych szeregów.
+
+/**
+ * @class SeriesCodec
+ * @brief Kodowanie szeregów pomiarów w stylu Gorilla z kompresją zlib (qCompress) na wierzchu.
+ *
+ * Znaczniki czasu zapisywane są jako różnice drugiego rzędu (delta-of-delta): dla pomiarów godzinowych
+ * każdy punkt zajmuje 1 bit. Wartości float kodowane są przez XOR z poprzednią wartością (zapisywane są
+ * tylko bity znaczące), braki trafiają do osobnej mapy bitowej. Całość jest dodatkowo kompresowana
+ * qCompress z regulowanym poziomem.
+ *
+ * Rekord historii to metadane (pola inne niż "key" i "values", jako zwarty JSON) i zakodowany szereg.
+ * Wartości rekordu są przy tym zaokrąglane do float (ok. 7 cyfr znaczących); pomiary API mają ich mniej.
+ * Dekodowanie jest przezroczyste: dane bez znacznika formatu są traktowane jako JSON, więc rekordy
+ * zapisane wcześniej są czytane bez zmian.
+ */
+class SeriesCodec
+{
+public:
+    /// Ustawienia kodowania.
+    struct Options {
+        bool columnar = true;       ///< Kodowanie Gorilla (false = zwarty JSON, jak dawniej).
+        int compressionLevel = 6;   ///< Poziom qCompress 0..9 (0 = bez kompresji).
+    };
+
+    /// Koduje szereg (bez kompresji ogólnej).
+    static QByteArray encodeSeries(const MeasurementSeries& series);
+    /// Dekoduje szereg zakodowany przez encodeSeries; false, jeśli dane są uszkodzone.
+    static bool decodeSeries(const QByteArray& data, MeasurementSeries* series);
+
+    /// Koduje rekord historii w formacie API ({"key", "values", ...metadane}).
+    static QByteArray encodeRecord(const QJsonObject& record, const Options& options);
+    /// Koduje rekord historii z gotowego szeregu i metadanych (bez budowania tablicy JSON).
+    static QByteArray encodeSeriesRecord(const MeasurementSeries& series, const QJsonObject& metadata, const Options& options);
+    /// Dekoduje rekord do formatu API (obsługuje też zwykły JSON); pusty obiekt przy błędzie.
+    static QJsonObject decodeRecord(const QByteArray& data);
+    /// Dekoduje szereg rekordu bez budowania tablicy JSON; metadata otrzymuje pozostałe pola.
+    static bool decodeRecordSeries(const QByteArray& data, MeasurementSeries* series, QJsonObject* metadata = nullptr);
+    /// Informuje, czy dane mają znacznik formatu SeriesCodec.
+    static bool isEncoded(const QByteArray& data);
+
+    /// Dodaje nagłówek formatu i kompresuje treść.
+    static QByteArray pack(const QByteArray& body, quint32 magic, int compressionLevel);
+    /// Sprawdza nagłówek formatu i rozpakowuje treść; false, jeśli to nie ten format lub dane są uszkodzone.
+    static bool unpack(const QByteArray& data, quint32 magic, QByteArray* body);
+};
+
+#endif // SERIESCODEC_H
@@ -0,0 +1,147 @@
+#include "seriesstatistics.h"
+#include <algorithm>          ///< Biblioteka do min/max.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+#include <limits>             ///< Biblioteka do wartości granicznych typów.
+
+/**
+ * @file seriesstatistics.cpp
+ * @brief Implementacja klasy SeriesStatistics, przyrostowych statystyk pomiarów czujnika.
+ */
+
+namespace {
+/// Zwraca wartość dla QML lub pusty QVariant, jeśli nie jest liczbą.
+QVariant numberOrNull(double value)
+{
+    return std::isnan(value) ? QVariant() : QVariant(value);
+}
+}
+
+/**
+ * @brief Tworzy pusty akumulator.
+ */
+SeriesStatistics::SeriesStatistics()
+    : n(0), meanValue(0.0), m2(0.0),
+      minValue(std::numeric_limits<double>::max()), maxValue(std::numeric_limits<double>::lowest()),
+      newest(std::numeric_limits<qint64>::min()), newestHour(std::numeric_limits<qint64>::min())
+{
+    for (int i = 0; i < ROLLING_HOURS; ++i) {
+        hourSum[i] = 0.0;
+        hourCount[i] = 0;
+    }
+}
+
+/**
+ * @brief Dodaje punkt (kolejność czasowa nie jest wymagana).
+ * @param timestampMs Znacznik czasu (ms od epoki).
+ * @param value Wartość pomiaru.
+ */
+void SeriesStatistics::add(qint64 timestampMs, double value)
+{
+    ++n;
+    const double delta = value - meanValue;
+    meanValue += delta / n;
+    m2 += delta * (value - meanValue);
+    minValue = std::min(minValue, value);
+    maxValue = std::max(maxValue, value);
+    digest.add(value);
+    newest = std::max(newest, timestampMs);
+
+    /// Nowsza godzina przesuwa pierścień; kubełki, które wypadły z okna, są zerowane.
+    const qint64 hour = timestampMs / HOUR_MS;
+    if (newestHour == std::numeric_limits<qint64>::min() || hour > newestHour) {
+        const qint64 steps = newestHour == std::numeric_limits<qint64>::min()
+            ? ROLLING_HOURS : std::min<qint64>(hour - newestHour, ROLLING_HOURS);
+        for (qint64 step = 0; step < steps; ++step) {
+            const int slot = int((hour - step) % ROLLING_HOURS);
+            hourSum[slot] = 0.0;
+            hourCount[slot] = 0;
+        }
+        newestHour = hour;
+    }
+    if (hour <= newestHour - ROLLING_HOURS) {
+        return;
+    }
+    const int slot = int(hour % ROLLING_HOURS);
+    hourSum[slot] += value;
+    ++hourCount[slot];
+}
+
+/**
+ * @brief Dodaje punkty szeregu, których jeszcze nie było.
+ * Odświeżone dane z API zawierają poprzednie godziny, więc dodawane są tylko punkty nowsze od najnowszego
+ * dodanego. Braki są pomijane; godziny bez wartości (np. jeszcze nieopublikowane) zostaną dodane później.
+ * @param series Szereg pomiarów (dowolna kolejność punktów).
+ */
+void SeriesStatistics::addSeries(const MeasurementSeries& series)
+{
+    const qint64 after = newest;
+    const float* values = series.values().constData();
+    const qint64* timestamps = series.timestamps().constData();
+    for (int i = 0; i < series.size(); ++i) {
+        if (!series.isNull(i) && timestamps[i] > after) {
+            add(timestamps[i], values[i]);
+        }
+    }
+    digest.compress();
+}
+
+/**
+ * @brief Zwraca odchylenie standardowe (populacyjne, jak dotychczas w statystykach).
+ * @return Odchylenie standardowe lub 0 dla mniej niż dwóch wartości.
+ */
+double SeriesStatistics::stdDev() const
+{
+    return n > 1 ? std::sqrt(m2 / n) : 0.0;
+}
+
+/**
+ * @brief Zwraca średnią kroczącą z ostatnich godzin.
+ * @param hours Długość okna (1..24 godzin), kończącego się na najnowszej godzinie z danymi.
+ * @return Średnia lub NaN, jeśli mniej niż 75% godzin okna ma wartość.
+ */
+double SeriesStatistics::rollingMean(int hours) const
+{
+    if (n == 0 || hours < 1 || hours > ROLLING_HOURS) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double sum = 0.0;
+    int count = 0;
+    int hoursWithData = 0;
+    for (int h = 0; h < hours; ++h) {
+        const int slot = int((newestHour - h) % ROLLING_HOURS);
+        sum += hourSum[slot];
+        count += hourCount[slot];
+        hoursWithData += hourCount[slot] > 0 ? 1 : 0;
+    }
+    if (count == 0 || hoursWithData * 4 < hours * 3) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return sum / count;
+}
+
+/**
+ * @brief Zwraca statystyki w postaci mapy dla QML.
+ * @return Mapa z min, max, mean, stdDev, count, p50, p95, p99, mean1h, mean8h, mean24h (puste, jeśli brak).
+ */
+QVariantMap SeriesStatistics::toVariantMap() const
+{
+    QVariantMap stats;
+    stats["count"] = int(n);
+    if (n == 0) {
+        for (const char* key : {"min", "max", "mean", "stdDev", "p50", "p95", "p99", "mean1h", "mean8h", "mean24h"}) {
+            stats[key] = QVariant();
+        }
+        return stats;
+    }
+    stats["min"] = minValue;
+    stats["max"] = maxValue;
+    stats["mean"] = meanValue;
+    stats["stdDev"] = stdDev();
+    stats["p50"] = numberOrNull(quantile(0.50));
+    stats["p95"] = numberOrNull(quantile(0.95));
+    stats["p99"] = numberOrNull(quantile(0.99));
+    stats["mean1h"] = numberOrNull(rollingMean(1));
+    stats["mean8h"] = numberOrNull(rollingMean(8));
+    stats["mean24h"] = numberOrNull(rollingMean(24));
+    return stats;
+}
@@ -0,0 +1,76 @@
+#ifndef SERIESSTATISTICS_H
+#define SERIESSTATISTICS_H
+
+/**
+ * @file seriesstatistics.h
+ * @brief Plik nagłówkowy dla klasy SeriesStatistics, przyrostowych statystyk pomiarów czujnika.
+ */
+
+#include <QVariantMap>         ///< Do przekazywania statystyk do QML.
+#include "measurementseries.h" ///< Do dodawania całych szeregów.
+#include "quantiledigest.h"    ///< Do percentyli p50/p95/p99.
+
+/**
+ * @class SeriesStatistics
+ * @brief Akumulator statystyk czujnika aktualizowany w O(1) na punkt.
+ *
+ * Średnia i wariancja liczone są algorytmem Welforda (stabilnym numerycznie), percentyle szkicem
+ * QuantileDigest, a średnie kroczące 1 h / 8 h / 24 h z pierścienia 24 godzinnych kubełków kończącego się
+ * na najnowszej godzinie z danymi. Średnia krocząca jest podawana, gdy co najmniej 75% godzin okna ma
+ * wartość (jak przy ocenie zgodności z normami jakości powietrza).
+ */
+class SeriesStatistics
+{
+public:
+    /// Tworzy pusty akumulator.
+    SeriesStatistics();
+
+    /// Dodaje punkt z wartością.
+    void add(qint64 timestampMs, double value);
+    /// Dodaje punkty szeregu nowsze od najnowszego już dodanego (wszystkie, jeśli akumulator jest pusty).
+    void addSeries(const MeasurementSeries& series);
+
+    /// Zwraca liczbę dodanych wartości.
+    qint64 count() const { return n; }
+    /// Zwraca średnią.
+    double mean() const { return meanValue; }
+    /// Zwraca odchylenie standardowe (populacyjne).
+    double stdDev() const;
+    /// Zwraca przybliżony kwantyl q (0..1).
+    double quantile(double q) const { return digest.quantile(q); }
+    /// Zwraca średnią z ostatnich godzin (1..24); NaN, jeśli za mało godzin ma dane.
+    double rollingMean(int hours) const;
+    /// Zwraca znacznik czasu najnowszego dodanego punktu (ms od epoki).
+    qint64 newestTimestamp() const { return newest; }
+    /// Zwraca statystyki dla QML (min, max, mean, stdDev, count, p50, p95, p99, mean1h, mean8h, mean24h).
+    QVariantMap toVariantMap() const;
+
+private:
+    /// Liczba godzinnych kubełków średnich kroczących.
+    static constexpr int ROLLING_HOURS = 24;
+    /// Długość godziny (ms).
+    static constexpr qint64 HOUR_MS = 3600000;
+
+    /// Liczba wartości.
+    qint64 n;
+    /// Średnia (Welford).
+    double meanValue;
+    /// Suma kwadratów odchyleń od średniej (Welford).
+    double m2;
+    /// Najmniejsza wartość.
+    double minValue;
+    /// Największa wartość.
+    double maxValue;
+    /// Szkic percentyli.
+    QuantileDigest digest;
+    /// Najnowszy znacznik czasu (ms od epoki).
+    qint64 newest;
+    /// Numer najnowszej godziny w kubełkach.
+    qint64 newestHour;
+    /// Suma wartości w kubełku godziny (indeks: godzina mod 24).
+    double hourSum[ROLLING_HOURS];
+    /// Liczba wartości w kubełku godziny.
+    int hourCount[ROLLING_HOURS];
+};
+
+#endif // SERIESSTATISTICS_H
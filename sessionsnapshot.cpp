@@ -0,0 +1,134 @@
+#include "sessionsnapshot.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QFile>               ///< Biblioteka do operacji na plikach.
+#include <QSaveFile>           ///< Biblioteka do atomowego zapisu pliku.
+#include <QDataStream>         ///< Biblioteka do binarnego kodowania danych.
+#include <QCborArray>          ///< Biblioteka do zwartego zapisu JSON w CBOR.
+#include <QCborValue>          ///< Biblioteka do odczytu CBOR.
+#include <QtEndian>            ///< Biblioteka do konwersji kolejności bajtów.
+
+/**
+ * @file sessionsnapshot.cpp
+ * @brief Implementacja klasy SessionSnapshot, binarnej migawki stanu aplikacji do szybkiego startu.
+ */
+
+namespace {
+/// Znacznik początku pliku migawki ("AQSS").
+const quint32 SNAPSHOT_MAGIC = 0x41515353;
+/// Wersja formatu migawki.
+const quint16 SNAPSHOT_VERSION = 1;
+/// Rozmiar nagłówka pliku migawki (bajty).
+const int SNAPSHOT_HEADER_SIZE = 8;
+
+/// Oblicza sumę kontrolną CRC-16 treści migawki.
+quint16 snapshotChecksum(const QByteArray& body)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return qChecksum(QByteArrayView(body));
+#else
+    return qChecksum(body.constData(), uint(body.size()));
+#endif
+}
+}
+
+/**
+ * @brief Tworzy pustą migawkę.
+ */
+SessionSnapshot::SessionSnapshot()
+    : stationId(0), sensorId(0)
+{
+}
+
+/**
+ * @brief Wczytuje migawkę z pliku.
+ * @param path Ścieżka pliku migawki.
+ * @return True, jeśli plik istnieje, ma poprawny nagłówek, sumę kontrolną i treść.
+ */
+bool SessionSnapshot::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Brak migawki sesji:" << path;
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    const QByteArray body = data.mid(SNAPSHOT_HEADER_SIZE);
+    if (data.size() < SNAPSHOT_HEADER_SIZE
+        || qFromBigEndian<quint32>(data.constData()) != SNAPSHOT_MAGIC
+        || qFromBigEndian<quint16>(data.constData() + 4) != SNAPSHOT_VERSION
+        || qFromBigEndian<quint16>(data.constData() + 6) != snapshotChecksum(body)) {
+        qDebug() << "Nieprawidłowa migawka sesji:" << path;
+        return false;
+    }
+
+    QDataStream in(body);
+    in.setVersion(QDataStream::Qt_5_12);
+    QByteArray stationsCbor;
+    QByteArray sensorsCbor;
+    qint32 savedStationId = 0;
+    qint32 savedSensorId = 0;
+    qint64 savedAtMs = 0;
+    QString key;
+    QVector<qint64> timestamps;
+    QVector<float> values;
+    QVector<quint64> nulls;
+    in >> savedAtMs >> stationsCbor >> savedStationId >> sensorsCbor >> savedSensorId;
+    in >> key >> timestamps >> values >> nulls;
+    if (in.status() != QDataStream::Ok || timestamps.size() != values.size()
+        || nulls.size() != (timestamps.size() + 63) / 64) {
+        qDebug() << "Niekompletna migawka sesji:" << path;
+        return false;
+    }
+
+    stations = QCborValue::fromCbor(stationsCbor).toArray().toJsonArray();
+    sensors = QCborValue::fromCbor(sensorsCbor).toArray().toJsonArray();
+    stationId = savedStationId;
+    sensorId = savedSensorId;
+    savedAt = QDateTime::fromMSecsSinceEpoch(savedAtMs);
+    series.clear();
+    series.setKey(key);
+    series.reserve(timestamps.size());
+    for (int i = 0; i < timestamps.size(); ++i) {
+        if ((nulls[i >> 6] >> (i & 63)) & 1) {
+            series.appendNull(timestamps[i]);
+        } else {
+            series.append(timestamps[i], values[i]);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Zapisuje migawkę do pliku (atomowo, przez QSaveFile).
+ * @param path Ścieżka pliku migawki.
+ * @return True, jeśli zapis się powiódł.
+ */
+bool SessionSnapshot::save(const QString& path) const
+{
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << qint64(savedAt.toMSecsSinceEpoch())
+        << QCborArray::fromJsonArray(stations).toCborValue().toCbor() << qint32(stationId)
+        << QCborArray::fromJsonArray(sensors).toCborValue().toCbor() << qint32(sensorId);
+    out << series.key() << series.timestamps() << series.values() << series.nulls();
+
+    QByteArray header(SNAPSHOT_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(SNAPSHOT_MAGIC, header.data());
+    qToBigEndian<quint16>(SNAPSHOT_VERSION, header.data() + 4);
+    qToBigEndian<quint16>(snapshotChecksum(body), header.data() + 6);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Błąd zapisu migawki sesji:" << file.errorString();
+        return false;
+    }
+    file.write(header);
+    file.write(body);
+    if (!file.commit()) {
+        qDebug() << "Błąd zapisu migawki sesji:" << file.errorString();
+        return false;
+    }
+    return true;
+}
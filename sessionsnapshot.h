@@ -0,0 +1,43 @@
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+/**
+ * @file sessionsnapshot.h
+ * @brief Plik nagłówkowy dla klasy SessionSnapshot, binarnej migawki stanu aplikacji do szybkiego startu.
+ */
+
+#include <QString>
+#include <QJsonArray>          ///< Do listy stacji i czujników.
+#include <QDateTime>           ///< Do czasu zapisu migawki.
+#include "measurementseries.h" ///< Do szeregu pomiarów ostatniego czujnika.
+
+/**
+ * @class SessionSnapshot
+ * @brief Ostatnia poprawna lista stacji, wybrana stacja i czujnik oraz jego pomiary w zwartym pliku binarnym.
+ *
+ * Plik: magic, wersja, CRC-16 treści i treść QDataStream. Listy stacji i czujników są zapisane w CBOR,
+ * a szereg pomiarów kolumnowo (znaczniki czasu, wartości, mapa braków), więc odczyt nie parsuje tekstu
+ * i trwa kilka milisekund. Migawka służy wyłącznie do szybkiego startu; dane są potem odświeżane z API.
+ */
+class SessionSnapshot
+{
+public:
+    /// Tworzy pustą migawkę.
+    SessionSnapshot();
+
+    /// Wczytuje migawkę z pliku; false, jeśli plik nie istnieje lub jest uszkodzony.
+    bool load(const QString& path);
+    /// Zapisuje migawkę do pliku (atomowo).
+    bool save(const QString& path) const;
+    /// Informuje, czy migawka nie zawiera listy stacji.
+    bool isEmpty() const { return stations.isEmpty(); }
+
+    QJsonArray stations;        ///< Lista stacji w formacie API.
+    int stationId;              ///< ID ostatnio wybranej stacji (0, jeśli brak).
+    QJsonArray sensors;         ///< Czujniki wybranej stacji w formacie API.
+    int sensorId;               ///< ID ostatnio wybranego czujnika (0, jeśli brak).
+    MeasurementSeries series;   ///< Pomiary wybranego czujnika.
+    QDateTime savedAt;          ///< Czas zapisu migawki.
+};
+
+#endif // SESSIONSNAPSHOT_H
@@ -0,0 +1,213 @@
+#include "stationaggregator.h"
+#include <QVariantList>       ///< Biblioteka do listy stacji dla QML.
+#include <QtConcurrent>       ///< Biblioteka do uruchamiania redukcji w puli wątków.
+#include <algorithm>          ///< Biblioteka do sortowania.
+#include <limits>             ///< Biblioteka do wartości granicznych typów.
+
+/**
+ * @file stationaggregator.cpp
+ * @brief Implementacja klasy StationAggregator, zestawień jednego zanieczyszczenia dla wielu stacji.
+ */
+
+/**
+ * @brief Sprawdza, czy stacja leży w regionie.
+ * @param station Dane stacji w formacie API.
+ * @param field Pole regionu: "city", "commune", "district" lub "province".
+ * @param value Nazwa regionu (wielkość liter nie ma znaczenia); pusta oznacza brak filtra.
+ * @return True, jeśli stacja spełnia filtr.
+ */
+bool StationAggregator::matchesRegion(const QJsonObject& station, const QString& field, const QString& value)
+{
+    if (value.isEmpty()) {
+        return true;
+    }
+    const QJsonObject city = station["city"].toObject();
+    const QJsonObject commune = city["commune"].toObject();
+    QString name;
+    if (field == "city") {
+        name = city["name"].toString();
+    } else if (field == "commune") {
+        name = commune["communeName"].toString();
+    } else if (field == "district") {
+        name = commune["districtName"].toString();
+    } else if (field == "province") {
+        name = commune["provinceName"].toString();
+    }
+    return name.compare(value, Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * @brief Zwraca kod parametru czujnika.
+ * @param sensor Dane czujnika w formacie API.
+ * @return Kod parametru lub pusty napis.
+ */
+QString StationAggregator::paramCode(const QJsonObject& sensor)
+{
+    return sensor["param"].toObject()["paramCode"].toString();
+}
+
+/**
+ * @brief Zwraca stację i parametr z danych czujnika.
+ * ID stacji może być liczbą (API) lub tekstem (sensorInfo z importu XML); bez obiektu param kod parametru
+ * jest brany z pola paramCode.
+ * @param sensor Dane czujnika.
+ * @return Stacja i parametr (puste, jeśli ich brak).
+ */
+StationAggregator::SensorInfo StationAggregator::sensorInfo(const QJsonObject& sensor)
+{
+    SensorInfo info;
+    info.stationId = sensor["stationId"].toVariant().toInt();
+    info.paramCode = paramCode(sensor);
+    if (info.paramCode.isEmpty()) {
+        info.paramCode = sensor["paramCode"].toString();
+    }
+    return info;
+}
+
+/**
+ * @brief Wyciąga stację i parametr czujnika z rekordu historii.
+ * Jeśli sensorInfo rekordu nie zawiera parametru (import XML i CSV), kodem parametru jest klucz szeregu.
+ * @param payload Treść rekordu (SeriesCodec lub zwarty JSON w formacie autozapisu).
+ * @return Stacja i parametr (puste, jeśli rekordu nie da się odczytać).
+ */
+StationAggregator::SensorInfo StationAggregator::sensorInfoFromPayload(const QByteArray& payload)
+{
+    MeasurementSeries series;
+    QJsonObject metadata;
+    if (!SeriesCodec::decodeRecordSeries(payload, &series, &metadata)) {
+        return SensorInfo();
+    }
+    SensorInfo info = sensorInfo(metadata["sensorInfo"].toObject());
+    if (info.paramCode.isEmpty()) {
+        info.paramCode = series.key();
+    }
+    return info;
+}
+
+/**
+ * @brief Wykonuje zapytanie: rozpoznaje nieznane czujniki, wybiera pasujące i redukuje je.
+ * Czujnik znany z listy czujników stacji (po ID) ma pierwszeństwo przed danymi z rekordu historii.
+ * @param query Zapytanie z kopiami danych wątku głównego.
+ * @return Wynik dla QML i stacje oraz parametry odczytane z rekordów.
+ */
+StationAggregator::Answer StationAggregator::run(const Query& query)
+{
+    Answer answer;
+    const QVector<SensorInfo> infos = QtConcurrent::blockingMapped<QVector<SensorInfo>>(query.unknown,
+        [](const QPair<int, QByteArray>& record) { return sensorInfoFromPayload(record.second); });
+    for (int i = 0; i < query.unknown.size(); ++i) {
+        answer.resolved.insert(query.unknown[i].first, infos[i]);
+    }
+
+    QVector<Target> targets;
+    for (int sensorId : query.sensorIds) {
+        const SensorInfo info = query.known.contains(sensorId) ? query.known.value(sensorId) : answer.resolved.value(sensorId);
+        if (info.paramCode.compare(query.paramCode, Qt::CaseInsensitive) != 0
+            || (!query.regionValue.isEmpty() && !query.stations.contains(info.stationId))
+            || !matchesRegion(query.stations.value(info.stationId), query.regionField, query.regionValue)) {
+            continue;
+        }
+        Target target;
+        target.sensorId = sensorId;
+        target.stationId = info.stationId;
+        targets.append(target);
+    }
+    const QVector<Result> results = aggregate(query.rollups, targets, query.fromMs, query.toMs);
+    answer.summary = toVariantMap(results, query.stations);
+    answer.targetCount = targets.size();
+    answer.resultCount = results.size();
+    return answer;
+}
+
+/**
+ * @brief Redukuje godzinowe agregaty każdego czujnika w puli wątków.
+ * @param rollups Agregaty magazynu historii (tylko odczyt).
+ * @param targets Czujniki objęte zapytaniem.
+ * @param fromMs Początek przedziału (ms od epoki).
+ * @param toMs Koniec przedziału (ms od epoki).
+ * @return Wyniki czujników z co najmniej jedną wartością w przedziale.
+ */
+QVector<StationAggregator::Result> StationAggregator::aggregate(const HistoryRollups& rollups, const QVector<Target>& targets,
+                                                                qint64 fromMs, qint64 toMs)
+{
+    const HistoryRollups* source = &rollups;
+    const QVector<Result> reduced = QtConcurrent::blockingMapped<QVector<Result>>(targets,
+        [source, fromMs, toMs](const Target& target) -> Result {
+            Result result;
+            result.sensorId = target.sensorId;
+            result.stationId = target.stationId;
+            result.min = std::numeric_limits<float>::max();
+            result.max = std::numeric_limits<float>::lowest();
+            const QVector<HistoryRollups::Bucket> hours = source->buckets(target.sensorId, HistoryRollups::Hourly, fromMs, toMs);
+            for (const HistoryRollups::Bucket& hour : hours) {
+                result.count += hour.count;
+                result.sum += hour.sum;
+                result.min = std::min(result.min, hour.min);
+                if (hour.max > result.max) {
+                    result.max = hour.max;
+                    result.maxTime = hour.start;
+                }
+            }
+            return result;
+        });
+    QVector<Result> results;
+    for (const Result& result : reduced) {
+        if (result.count > 0) {
+            results.append(result);
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Składa wynik dla QML.
+ * @param results Wyniki czujników.
+ * @param stations Mapa ID stacji na dane (nazwa i położenie administracyjne).
+ * @return Mapa {stations: [{stationId, stationName, city, commune, district, province, sensorId, count,
+ * mean, min, max, maxTime}], stationCount, count, mean, min, max}; stacje posortowane malejąco według średniej.
+ */
+QVariantMap StationAggregator::toVariantMap(const QVector<Result>& results, const QMap<int, QJsonObject>& stations)
+{
+    QVector<Result> sorted = results;
+    std::sort(sorted.begin(), sorted.end(), [](const Result& a, const Result& b) {
+        return a.sum / a.count > b.sum / b.count;
+    });
+    QVariantList rows;
+    qint64 count = 0;
+    double sum = 0.0;
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+    for (const Result& result : sorted) {
+        const QJsonObject station = stations.value(result.stationId);
+        const QJsonObject city = station["city"].toObject();
+        const QJsonObject commune = city["commune"].toObject();
+        QVariantMap row;
+        row["stationId"] = result.stationId;
+        row["stationName"] = station["stationName"].toString();
+        row["city"] = city["name"].toString();
+        row["commune"] = commune["communeName"].toString();
+        row["district"] = commune["districtName"].toString();
+        row["province"] = commune["provinceName"].toString();
+        row["sensorId"] = result.sensorId;
+        row["count"] = result.count;
+        row["mean"] = result.sum / result.count;
+        row["min"] = result.min;
+        row["max"] = result.max;
+        row["maxTime"] = double(result.maxTime);
+        rows.append(row);
+        count += result.count;
+        sum += result.sum;
+        min = std::min(min, result.min);
+        max = std::max(max, result.max);
+    }
+    QVariantMap summary;
+    summary["stations"] = rows;
+    summary["stationCount"] = rows.size();
+    summary["count"] = count;
+    if (count > 0) {
+        summary["mean"] = sum / count;
+        summary["min"] = min;
+        summary["max"] = max;
+    }
+    return summary;
+}
@@ -0,0 +1,94 @@
+#ifndef STATIONAGGREGATOR_H
+#define STATIONAGGREGATOR_H
+
+/**
+ * @file stationaggregator.h
+ * @brief Plik nagłówkowy dla klasy StationAggregator, zestawień jednego zanieczyszczenia dla wielu stacji.
+ */
+
+#include <QJsonObject>         ///< Do danych stacji i czujników.
+#include <QHash>               ///< Do stacji i parametrów czujników według ID.
+#include <QMap>                ///< Do mapy ID stacji na dane.
+#include <QPair>               ///< Do rekordów czujników nieznanych z listy czujników.
+#include <QVariantMap>         ///< Do przekazywania wyników do QML.
+#include <QVector>             ///< Do listy czujników i wyników.
+#include "historystore.h"      ///< Do agregatów zapisanej historii.
+
+/**
+ * @class StationAggregator
+ * @brief Liczy średnią, minimum i maksimum zanieczyszczenia w przedziale czasu dla wielu czujników naraz.
+ *
+ * Każdy czujnik jest redukowany niezależnie w puli wątków QtConcurrent z godzinowych agregatów magazynu
+ * historii (HistoryRollups), więc koszt nie zależy od liczby zapisanych rekordów, a punkty z nakładających
+ * się rekordów autozapisu nie są liczone wielokrotnie. Zapytanie (run) działa w całości w puli wątków na
+ * kopii agregatów i rekordach skopiowanych w wątku głównym, więc magazyn może być w tym czasie zmieniany.
+ *
+ * Stacja i parametr czujnika pochodzą z list czujników stacji (po ID czujnika), a dla czujników spoza nich
+ * z najnowszego rekordu historii; rekordy importowane z XML i CSV mają w sensorInfo tylko ID lub pola
+ * tekstowe, więc parametr jest wtedy brany z klucza szeregu.
+ */
+class StationAggregator
+{
+public:
+    /// Czujnik objęty zapytaniem.
+    struct Target {
+        int sensorId = 0;   ///< ID czujnika.
+        int stationId = 0;  ///< ID stacji czujnika.
+    };
+
+    /// Stacja i parametr czujnika.
+    struct SensorInfo {
+        int stationId = 0;  ///< ID stacji (0, jeśli nieznane).
+        QString paramCode;  ///< Kod parametru (np. "PM2.5").
+    };
+
+    /// Zapytanie przekazywane do puli wątków.
+    struct Query {
+        QString paramCode;                            ///< Kod parametru.
+        QString regionField;                          ///< Pole regionu.
+        QString regionValue;                          ///< Nazwa regionu (pusta = wszystkie stacje).
+        qint64 fromMs = 0;                            ///< Początek przedziału (ms od epoki).
+        qint64 toMs = 0;                              ///< Koniec przedziału (ms od epoki).
+        QList<int> sensorIds;                         ///< Czujniki z zapisaną historią.
+        QHash<int, SensorInfo> known;                 ///< Czujniki znane z list czujników stacji.
+        QVector<QPair<int, QByteArray>> unknown;      ///< Najnowsze rekordy pozostałych czujników.
+        QMap<int, QJsonObject> stations;              ///< Dane stacji według ID.
+        HistoryRollups rollups;                       ///< Kopia agregatów magazynu.
+    };
+
+    /// Wynik zapytania.
+    struct Answer {
+        QVariantMap summary;                          ///< Wynik dla QML (toVariantMap).
+        QHash<int, SensorInfo> resolved;              ///< Stacje i parametry odczytane z rekordów.
+        int targetCount = 0;                          ///< Liczba czujników objętych zapytaniem.
+        int resultCount = 0;                          ///< Liczba czujników z danymi w przedziale.
+    };
+
+    /// Wynik redukcji jednego czujnika.
+    struct Result {
+        int sensorId = 0;   ///< ID czujnika.
+        int stationId = 0;  ///< ID stacji czujnika.
+        int count = 0;      ///< Liczba wartości w przedziale.
+        double sum = 0.0;   ///< Suma wartości.
+        float min = 0.0f;   ///< Najmniejsza wartość.
+        float max = 0.0f;   ///< Największa wartość.
+        qint64 maxTime = 0; ///< Początek godziny z największą wartością (ms od epoki).
+    };
+
+    /// Informuje, czy stacja leży w regionie (pole: city, commune, district, province; pusty filtr = każda).
+    static bool matchesRegion(const QJsonObject& station, const QString& field, const QString& value);
+    /// Zwraca kod parametru czujnika (np. "PM2.5").
+    static QString paramCode(const QJsonObject& sensor);
+    /// Zwraca stację i parametr z danych czujnika (format API lub pola tekstowe importu).
+    static SensorInfo sensorInfo(const QJsonObject& sensor);
+    /// Wyciąga stację i parametr czujnika z rekordu historii (wywoływane w puli wątków).
+    static SensorInfo sensorInfoFromPayload(const QByteArray& payload);
+    /// Wykonuje zapytanie w puli wątków: rozpoznaje czujniki, wybiera pasujące i redukuje je.
+    static Answer run(const Query& query);
+    /// Redukuje czujniki w puli wątków; pomija czujniki bez danych w przedziale.
+    static QVector<Result> aggregate(const HistoryRollups& rollups, const QVector<Target>& targets, qint64 fromMs, qint64 toMs);
+    /// Zwraca wynik dla QML: lista stacji oraz łączne count, mean, min, max.
+    static QVariantMap toVariantMap(const QVector<Result>& results, const QMap<int, QJsonObject>& stations);
+};
+
+#endif // STATIONAGGREGATOR_H
@@ -0,0 +1,199 @@
+#include "stationcollector.h"
+#include "replyparser.h"       ///< Do parsowania odpowiedzi w puli wątków.
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+
+/**
+ * @file stationcollector.cpp
+ * @brief Implementacja klasy StationCollector, cyklicznego zbierania pomiarów wszystkich stacji bez GUI.
+ */
+
+/**
+ * @brief Konstruktor klasy StationCollector.
+ * @param historyDirectory Katalog magazynu historii (ten sam, którego używa aplikacja z GUI).
+ * @param maxConcurrent Limit równoległych połączeń dla czujników stacji i dla pomiarów.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+StationCollector::StationCollector(const QString& historyDirectory, int maxConcurrent, QObject *parent)
+    : QObject(parent), concurrencyLimit(qMax(1, maxConcurrent)), stationRequestsInFlight(0), collecting(false),
+      stationCount(0), sensorCount(0), savedCount(0), failedCount(0)
+{
+    dispatcher = new ApiDispatcher(API_BASE_URL, this);
+    prefetcher = new MeasurementPrefetcher(dispatcher, concurrencyLimit, this);
+    connect(prefetcher, &MeasurementPrefetcher::measurementsFetched, this, &StationCollector::onMeasurementsFetched);
+    connect(prefetcher, &MeasurementPrefetcher::fetchFailed, this, &StationCollector::onMeasurementsFetchFailed);
+    historyStore = new HistoryStore(historyDirectory, this);
+    historyWriter = DeltaHistoryWriter(historyStore);
+    pollTimer = new QTimer(this);
+    connect(pollTimer, &QTimer::timeout, this, &StationCollector::collect);
+}
+
+/**
+ * @brief Ustawia kodowanie rekordów zapisywanych w magazynie historii.
+ * @param options Ustawienia SeriesCodec.
+ */
+void StationCollector::setCodecOptions(const SeriesCodec::Options& options)
+{
+    historyStore->setCodecOptions(options);
+}
+
+/**
+ * @brief Otwiera magazyn historii i uruchamia zbieranie.
+ * @param intervalMinutes Odstęp między cyklami (minuty); 0 oznacza jeden cykl.
+ * @return False, jeśli nie udało się otworzyć magazynu historii.
+ */
+bool StationCollector::start(int intervalMinutes)
+{
+    if (!historyStore->open()) {
+        qDebug() << "Błąd otwarcia magazynu historii:" << historyStore->errorString();
+        return false;
+    }
+    qDebug() << "Zbieranie danych do:" << historyStore->directory() << "co" << intervalMinutes << "min,"
+             << concurrencyLimit << "równoległych połączeń";
+    if (intervalMinutes > 0) {
+        pollTimer->start(intervalMinutes * 60000);
+    }
+    collect();
+    return true;
+}
+
+/**
+ * @brief Rozpoczyna cykl: pobiera listę stacji (czujniki i pomiary są pobierane kolejno po niej).
+ */
+void StationCollector::collect()
+{
+    if (collecting) {
+        qDebug() << "Poprzedni cykl zbierania jeszcze trwa, pominięto";
+        return;
+    }
+    collecting = true;
+    stationCount = 0;
+    sensorCount = 0;
+    savedCount = 0;
+    failedCount = 0;
+    cycleTimer.start();
+    dispatcher->get(ApiEndpoint::Stations, 0, this, [this](const ApiReply& reply) {
+        onStationsReceived(reply);
+    });
+}
+
+/**
+ * @brief Kolejkuje pobieranie czujników wszystkich stacji.
+ * @param reply Odpowiedź station/findAll.
+ */
+void StationCollector::onStationsReceived(const ApiReply& reply)
+{
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania stacji:" << reply.errorString;
+        ++failedCount;
+        finishCycleIfDone();
+        return;
+    }
+    ReplyParser::run(this, &ReplyParser::parseStations, reply.body, [this](const StationsParseResult& result) {
+        if (!result.ok) {
+            qDebug() << "Nieprawidłowa odpowiedź JSON dla listy stacji";
+            ++failedCount;
+            finishCycleIfDone();
+            return;
+        }
+        stationQueue = result.stationsMap.keys();
+        stationCount = stationQueue.size();
+        fetchQueuedSensors();
+        finishCycleIfDone();
+    });
+}
+
+/**
+ * @brief Wysyła żądania czujników stacji z kolejki, nie więcej niż concurrencyLimit naraz.
+ */
+void StationCollector::fetchQueuedSensors()
+{
+    while (!stationQueue.isEmpty() && stationRequestsInFlight < concurrencyLimit) {
+        ++stationRequestsInFlight;
+        dispatcher->get(ApiEndpoint::Sensors, stationQueue.takeFirst(), this, [this](const ApiReply& reply) {
+            onSensorsReceived(reply);
+        });
+    }
+}
+
+/**
+ * @brief Kolejkuje pobieranie pomiarów czujników stacji.
+ * Miejsce w limicie jest zwalniane po sparsowaniu odpowiedzi.
+ * @param reply Odpowiedź station/sensors (ID stacji w metadanych żądania).
+ */
+void StationCollector::onSensorsReceived(const ApiReply& reply)
+{
+    if (!reply.ok()) {
+        qDebug() << "Błąd pobierania czujników stacji ID:" << reply.request.id << ":" << reply.errorString;
+        ++failedCount;
+        --stationRequestsInFlight;
+        fetchQueuedSensors();
+        finishCycleIfDone();
+        return;
+    }
+    ReplyParser::run(this, &ReplyParser::parseSensors, reply.body, [this](const SensorsParseResult& result) {
+        --stationRequestsInFlight;
+        if (result.ok) {
+            for (auto it = result.sensorsMap.constBegin(); it != result.sensorsMap.constEnd(); ++it) {
+                sensorInfo.insert(it.key(), it.value());
+            }
+            sensorCount += result.sensorsMap.size();
+            prefetcher->enqueue(result.sensorsMap.keys());
+        } else {
+            ++failedCount;
+        }
+        fetchQueuedSensors();
+        finishCycleIfDone();
+    });
+}
+
+/**
+ * @brief Zapisuje nowe lub zmienione punkty czujnika.
+ * Rekord ma ten sam format co autozapis w aplikacji z GUI.
+ * @param sensorId ID czujnika.
+ * @param series Pobrane pomiary.
+ */
+void StationCollector::onMeasurementsFetched(int sensorId, const MeasurementSeries& series)
+{
+    const DeltaHistoryWriter::Outcome outcome = historyWriter.save(sensorId, series, sensorInfo.value(sensorId));
+    if (outcome == DeltaHistoryWriter::Saved) {
+        ++savedCount;
+    } else if (outcome == DeltaHistoryWriter::Failed) {
+        ++failedCount;
+    }
+    finishCycleIfDone();
+}
+
+/**
+ * @brief Liczy błąd pobierania pomiarów.
+ * @param sensorId ID czujnika.
+ * @param error Komunikat błędu.
+ */
+void StationCollector::onMeasurementsFetchFailed(int sensorId, const QString& error)
+{
+    qDebug() << "Pominięto czujnik ID:" << sensorId << ":" << error;
+    ++failedCount;
+    finishCycleIfDone();
+}
+
+/**
+ * @brief Kończy cykl, gdy nie ma stacji ani czujników w kolejce lub w toku.
+ * Po cyklu zapisuje indeks i agregaty magazynu (usługa może zostać zatrzymana bez zamknięcia magazynu)
+ * i uruchamia kompaktowanie, jeśli jest potrzebne.
+ */
+void StationCollector::finishCycleIfDone()
+{
+    if (!collecting || !stationQueue.isEmpty() || stationRequestsInFlight > 0 || prefetcher->pendingCount() > 0
+        || dispatcher->isInFlight(ApiEndpoint::Stations, 0)) {
+        return;
+    }
+    collecting = false;
+    qDebug() << "Cykl zbierania zakończony w" << cycleTimer.elapsed() << "ms:" << stationCount << "stacji,"
+             << sensorCount << "czujników," << savedCount << "zapisanych," << failedCount << "błędów";
+    if (!historyStore->flush()) {
+        qDebug() << "Błąd zapisu indeksu lub agregatów historii:" << historyStore->directory();
+    }
+    if (historyStore->needsCompaction()) {
+        historyStore->compactInBackground();
+    }
+    emit cycleFinished(stationCount, sensorCount, savedCount, failedCount);
+}
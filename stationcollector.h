@@ -0,0 +1,96 @@
+#ifndef STATIONCOLLECTOR_H
+#define STATIONCOLLECTOR_H
+
+/**
+ * @file stationcollector.h
+ * @brief Plik nagłówkowy dla klasy StationCollector, cyklicznego zbierania pomiarów wszystkich stacji bez GUI.
+ */
+
+#include <QObject>
+#include <QTimer>                  ///< Do cyklicznego uruchamiania zbierania.
+#include <QHash>                   ///< Do danych czujników.
+#include <QList>                   ///< Do kolejki stacji.
+#include <QElapsedTimer>           ///< Do pomiaru czasu cyklu.
+#include "apidispatcher.h"         ///< Do wysyłania żądań do API GIOŚ.
+#include "measurementprefetcher.h" ///< Do pobierania pomiarów z limitem równoległości.
+#include "historystore.h"          ///< Do zapisu pomiarów w magazynie historii.
+#include "deltahistorywriter.h"    ///< Do zapisu tylko nowych pomiarów.
+
+/**
+ * @class StationCollector
+ * @brief Tryb bez interfejsu: co interwał pobiera listę stacji, czujniki każdej stacji i pomiary każdego czujnika.
+ *
+ * Korzysta z tych samych elementów co MainWindow: ApiDispatcher, ReplyParser (parsowanie w puli wątków),
+ * MeasurementPrefetcher (limit równoległych połączeń) i HistoryStore (rekordy w tym samym formacie co autozapis).
+ * Do historii trafiają tylko nowe lub zmienione punkty czujnika (DeltaHistoryWriter), jak przy autozapisie.
+ */
+class StationCollector : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Konstruktor, przyjmuje katalog magazynu historii i limit równoległych połączeń.
+    StationCollector(const QString& historyDirectory, int maxConcurrent, QObject *parent = nullptr);
+
+    /// Otwiera magazyn historii i uruchamia pierwszy cykl; kolejne co intervalMinutes (0 = jeden cykl).
+    bool start(int intervalMinutes);
+    /// Uruchamia cykl zbierania, jeśli poprzedni się zakończył.
+    void collect();
+    /// Informuje, czy cykl jest w toku.
+    bool isCollecting() const { return collecting; }
+    /// Ustawia kodowanie rekordów zapisywanych w magazynie historii.
+    void setCodecOptions(const SeriesCodec::Options& options);
+
+signals:
+    /// Informuje o zakończeniu cyklu (stacje, czujniki, zapisane szeregi, błędy).
+    void cycleFinished(int stations, int sensors, int saved, int failed);
+
+private:
+    /// Obsługuje listę stacji i kolejkuje pobieranie ich czujników.
+    void onStationsReceived(const ApiReply& reply);
+    /// Wysyła żądania czujników stacji z kolejki do osiągnięcia limitu.
+    void fetchQueuedSensors();
+    /// Obsługuje listę czujników stacji i kolejkuje pobieranie ich pomiarów.
+    void onSensorsReceived(const ApiReply& reply);
+    /// Zapisuje pobrane pomiary czujnika w magazynie historii.
+    void onMeasurementsFetched(int sensorId, const MeasurementSeries& series);
+    /// Liczy błąd pobierania pomiarów czujnika.
+    void onMeasurementsFetchFailed(int sensorId, const QString& error);
+    /// Kończy cykl, jeśli nie ma już żądań w toku.
+    void finishCycleIfDone();
+
+    /// Dyspozytor żądań API.
+    ApiDispatcher* dispatcher;
+    /// Kolejka pobierania pomiarów z limitem równoległości.
+    MeasurementPrefetcher* prefetcher;
+    /// Magazyn historii.
+    HistoryStore* historyStore;
+    /// Timer kolejnych cykli.
+    QTimer* pollTimer;
+    /// Limit równoległych żądań czujników stacji.
+    int concurrencyLimit;
+    /// Stacje czekające na pobranie czujników.
+    QList<int> stationQueue;
+    /// Liczba żądań czujników stacji w toku.
+    int stationRequestsInFlight;
+    /// Dane czujników (zapisywane razem z pomiarami jako sensorInfo).
+    QHash<int, QJsonObject> sensorInfo;
+    /// Zapis do historii tylko nowych i zmienionych pomiarów.
+    DeltaHistoryWriter historyWriter;
+    /// Czy cykl jest w toku.
+    bool collecting;
+    /// Liczba stacji w bieżącym cyklu.
+    int stationCount;
+    /// Liczba czujników w bieżącym cyklu.
+    int sensorCount;
+    /// Liczba szeregów zapisanych w bieżącym cyklu.
+    int savedCount;
+    /// Liczba błędów w bieżącym cyklu.
+    int failedCount;
+    /// Czas trwania bieżącego cyklu.
+    QElapsedTimer cycleTimer;
+    /// Bazowy adres API GIOS.
+    const QString API_BASE_URL = "https://api.gios.gov.pl/pjp-api/rest/";
+};
+
+#endif // STATIONCOLLECTOR_H
@@ -0,0 +1,282 @@
+#include "stationlistmodel.h"
+#include <QJsonObject>        ///< Biblioteka do obiektów JSON.
+#include "stationsearchindex.h" ///< Biblioteka do normalizacji tekstu filtra.
+#include <algorithm>          ///< Biblioteka do wyszukiwania binarnego.
+
+/**
+ * @file stationlistmodel.cpp
+ * @brief Implementacja klasy StationListModel, modelu listy stacji dla QML.
+ */
+
+/**
+ * @brief Konstruktor klasy StationListModel.
+ * @param parent Wskaźnik na obiekt nadrzędny.
+ */
+StationListModel::StationListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+/**
+ * @brief Zwraca liczbę widocznych stacji.
+ * @param parent Indeks rodzica (model jest płaską listą).
+ * @return Liczba wierszy.
+ */
+int StationListModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+/**
+ * @brief Zwraca dane stacji dla roli.
+ * @param index Indeks wiersza.
+ * @param role Rola danych.
+ * @return Wartość roli lub pusty QVariant.
+ */
+QVariant StationListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= rows.size()) {
+        return QVariant();
+    }
+    const Station& station = stations[rows[index.row()]];
+    switch (role) {
+    case StationIdRole:
+        return station.id;
+    case Qt::DisplayRole:
+    case NameRole:
+        return station.name;
+    case CityRole:
+        return station.city;
+    default:
+        return QVariant();
+    }
+}
+
+/**
+ * @brief Zwraca nazwy ról używane w delegacie QML.
+ * @return Mapa roli na nazwę.
+ */
+QHash<int, QByteArray> StationListModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[StationIdRole] = "stationId";
+    roles[NameRole] = "name";
+    roles[CityRole] = "city";
+    return roles;
+}
+
+/**
+ * @brief Wczytuje pełną listę stacji i pokazuje wszystkie (przy aktywnym filtrze: pasujące do niego).
+ * Jeśli lista zawiera te same stacje w tej samej kolejności (np. wczytane już strumieniowo),
+ * wiersze zostają, a odświeżane są tylko dane.
+ * @param stationsArray Tablica stacji w formacie JSON.
+ */
+void StationListModel::setStations(const QJsonArray& stationsArray)
+{
+    QVector<Station> items;
+    items.reserve(stationsArray.size());
+    bool sameIds = stationsArray.size() == stations.size();
+    for (const QJsonValue& value : stationsArray) {
+        items.append(stationFromJson(value.toObject()));
+        sameIds = sameIds && items.last().id == stations[items.size() - 1].id;
+    }
+    if (sameIds) {
+        stations = items;
+        if (!rows.isEmpty()) {
+            emit dataChanged(index(0), index(rows.size() - 1));
+        }
+        return;
+    }
+
+    beginResetModel();
+    stations = items;
+    indexById.clear();
+    rows.clear();
+    rows.reserve(stations.size());
+    for (int i = 0; i < stations.size(); ++i) {
+        indexById.insert(stations[i].id, i);
+        if (matchesFilter(stations[i])) {
+            rows.append(i);
+        }
+    }
+    endResetModel();
+    emit countChanged();
+}
+
+/**
+ * @brief Dopisuje stacje na końcu listy; na końcu widocznych wierszy pojawiają się te, które pasują do filtra.
+ * @param stationsArray Tablica kolejnych stacji w formacie JSON.
+ */
+void StationListModel::appendStations(const QJsonArray& stationsArray)
+{
+    QVector<int> visible;
+    for (const QJsonValue& value : stationsArray) {
+        const Station station = stationFromJson(value.toObject());
+        indexById.insert(station.id, stations.size());
+        if (matchesFilter(station)) {
+            visible.append(stations.size());
+        }
+        stations.append(station);
+    }
+    if (visible.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + visible.size() - 1);
+    rows += visible;
+    endInsertRows();
+    emit countChanged();
+}
+
+/**
+ * @brief Pokazuje podane stacje w podanej kolejności.
+ * Najpierw usuwa zakresy wierszy spoza wspólnego podciągu, potem wstawia brakujące zakresy.
+ * @param stationIds ID stacji do pokazania (nieznane i powtórzone są pomijane).
+ */
+void StationListModel::showStations(const QVector<int>& stationIds)
+{
+    QVector<int> target;
+    QHash<int, int> targetPosition;
+    target.reserve(stationIds.size());
+    for (int id : stationIds) {
+        auto it = indexById.constFind(id);
+        if (it != indexById.constEnd() && !targetPosition.contains(it.value())) {
+            targetPosition.insert(it.value(), target.size());
+            target.append(it.value());
+        }
+    }
+
+    const int oldCount = rows.size();
+    QVector<int> positions;
+    positions.reserve(rows.size());
+    for (int row : rows) {
+        positions.append(targetPosition.value(row, -1));
+    }
+    const QVector<bool> kept = keptRows(positions);
+
+    for (int last = rows.size() - 1; last >= 0; --last) {
+        if (kept[last]) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !kept[first - 1]) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        rows.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    /// Pozostałe wiersze są podciągiem docelowej listy, więc wystarczy wstawić brakujące fragmenty.
+    int i = 0;
+    while (i < target.size()) {
+        if (i < rows.size() && rows[i] == target[i]) {
+            ++i;
+            continue;
+        }
+        const int first = i;
+        while (i < target.size() && (first >= rows.size() || rows[first] != target[i])) {
+            ++i;
+        }
+        beginInsertRows(QModelIndex(), first, i - 1);
+        rows.insert(first, i - first, 0);
+        std::copy(target.begin() + first, target.begin() + i, rows.begin() + first);
+        endInsertRows();
+    }
+
+    if (rows.size() != oldCount) {
+        emit countChanged();
+    }
+}
+
+/**
+ * @brief Pokazuje wszystkie stacje w kolejności z API i czyści tekst filtra.
+ */
+void StationListModel::showAll()
+{
+    activeFilter.clear();
+    QVector<int> ids;
+    ids.reserve(stations.size());
+    for (const Station& station : stations) {
+        ids.append(station.id);
+    }
+    showStations(ids);
+}
+
+/**
+ * @brief Zapamiętuje tekst aktywnego filtra.
+ * Wiersze się nie zmieniają; pokazuje je showStations z wynikiem wyszukiwania.
+ * @param text Tekst wyszukiwania (pusty wyłącza filtr).
+ */
+void StationListModel::setFilterText(const QString& text)
+{
+    activeFilter = StationSearchIndex::fold(text.trimmed());
+}
+
+/**
+ * @brief Zwraca ID stacji w podanym wierszu.
+ * @param row Numer wiersza.
+ * @return ID stacji lub -1, jeśli wiersz nie istnieje.
+ */
+int StationListModel::stationIdAt(int row) const
+{
+    return (row >= 0 && row < rows.size()) ? stations[rows[row]].id : -1;
+}
+
+/**
+ * @brief Odczytuje dane stacji potrzebne do wyświetlenia.
+ * @param station Obiekt stacji z API.
+ * @return ID, nazwa stacji i nazwa miasta.
+ */
+StationListModel::Station StationListModel::stationFromJson(const QJsonObject& station)
+{
+    Station item;
+    item.id = station["id"].toInt();
+    item.name = station["stationName"].toString();
+    item.city = station["city"].toObject()["name"].toString();
+    return item;
+}
+
+/**
+ * @brief Sprawdza, czy nazwa stacji lub miasta zawiera tekst aktywnego filtra.
+ * @param station Dane stacji.
+ * @return True, jeśli filtra nie ma lub stacja do niego pasuje.
+ */
+bool StationListModel::matchesFilter(const Station& station) const
+{
+    return activeFilter.isEmpty() || StationSearchIndex::fold(station.name).contains(activeFilter)
+           || StationSearchIndex::fold(station.city).contains(activeFilter);
+}
+
+/**
+ * @brief Wyznacza wiersze, które mogą zostać na miejscu.
+ * Najdłuższy rosnący podciąg pozycji docelowych (O(n log n)); wiersze spoza listy docelowej (-1) są usuwane.
+ * @param targetPositions Pozycja każdego obecnego wiersza w liście docelowej lub -1.
+ * @return Dla każdego wiersza: czy zostaje.
+ */
+QVector<bool> StationListModel::keptRows(const QVector<int>& targetPositions)
+{
+    QVector<int> tailRow;       ///< Ostatni wiersz najlepszego podciągu o danej długości.
+    QVector<int> tailPosition;  ///< Pozycja docelowa tego wiersza.
+    QVector<int> previous(targetPositions.size(), -1);
+    for (int row = 0; row < targetPositions.size(); ++row) {
+        const int position = targetPositions[row];
+        if (position < 0) {
+            continue;
+        }
+        const int length = int(std::lower_bound(tailPosition.begin(), tailPosition.end(), position) - tailPosition.begin());
+        previous[row] = length > 0 ? tailRow[length - 1] : -1;
+        if (length == tailPosition.size()) {
+            tailPosition.append(position);
+            tailRow.append(row);
+        } else {
+            tailPosition[length] = position;
+            tailRow[length] = row;
+        }
+    }
+    QVector<bool> kept(targetPositions.size(), false);
+    for (int row = tailRow.isEmpty() ? -1 : tailRow.last(); row >= 0; row = previous[row]) {
+        kept[row] = true;
+    }
+    return kept;
+}
@@ -0,0 +1,96 @@
+#ifndef STATIONLISTMODEL_H
+#define STATIONLISTMODEL_H
+
+/**
+ * @file stationlistmodel.h
+ * @brief Plik nagłówkowy dla klasy StationListModel, modelu listy stacji dla QML.
+ */
+
+#include <QAbstractListModel>
+#include <QVector>             ///< Do przechowywania stacji i widocznych wierszy.
+#include <QHash>               ///< Do odnajdywania stacji po ID.
+#include <QJsonArray>          ///< Do listy stacji z API.
+#include <QJsonObject>         ///< Do danych pojedynczej stacji.
+
+/**
+ * @class StationListModel
+ * @brief Model listy stacji (role: stationId, name, city) aktualizowany minimalnymi zmianami wierszy.
+ *
+ * Pełna lista stacji jest wczytywana raz. Filtrowanie przekazuje tylko ID stacji do pokazania; model
+ * zachowuje najdłuższy podciąg obecnych wierszy w niezmienionej kolejności, a pozostałe usuwa i wstawia
+ * spójnymi zakresami, więc ListView odtwarza jedynie delegaty faktycznie zmienionych wierszy.
+ *
+ * Model pamięta tekst aktywnego filtra: stacje dopisywane ze strumienia i wczytana od nowa lista pokazują
+ * tylko stacje, których nazwa lub miasto zawiera ten tekst (bez polskich znaków), aż wyszukiwanie
+ * (StationSearchIndex) poda dokładną listę.
+ */
+class StationListModel : public QAbstractListModel
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged) ///< Liczba widocznych stacji (dla QML).
+
+public:
+    /// Role danych dostępne w delegacie QML.
+    enum Roles {
+        StationIdRole = Qt::UserRole + 1, ///< ID stacji.
+        NameRole,                         ///< Nazwa stacji.
+        CityRole                          ///< Nazwa miasta.
+    };
+
+    /// Konstruktor, tworzy pusty model.
+    explicit StationListModel(QObject *parent = nullptr);
+
+    /// Zwraca liczbę widocznych stacji.
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    /// Zwraca dane wiersza dla roli.
+    QVariant data(const QModelIndex& index, int role) const override;
+    /// Zwraca nazwy ról używane w QML.
+    QHash<int, QByteArray> roleNames() const override;
+
+    /// Wczytuje pełną listę stacji z API i pokazuje wszystkie.
+    void setStations(const QJsonArray& stations);
+    /// Dopisuje stacje na końcu listy i pokazuje je (wczytywanie listy w miarę nadchodzenia danych).
+    void appendStations(const QJsonArray& stations);
+    /// Zwraca liczbę wszystkich wczytanych stacji (niezależnie od filtra).
+    int stationCount() const { return stations.size(); }
+    /// Pokazuje podane stacje w podanej kolejności (minimalne zmiany wierszy).
+    void showStations(const QVector<int>& stationIds);
+    /// Pokazuje wszystkie stacje w kolejności z API i czyści tekst filtra.
+    void showAll();
+    /// Zapamiętuje tekst aktywnego filtra (przed showStations z wynikiem wyszukiwania).
+    void setFilterText(const QString& text);
+    /// Zwraca znormalizowany tekst aktywnego filtra (pusty, jeśli filtra nie ma).
+    QString filterText() const { return activeFilter; }
+    /// Zwraca ID stacji w podanym wierszu lub -1.
+    Q_INVOKABLE int stationIdAt(int row) const;
+
+signals:
+    /// Informuje o zmianie liczby widocznych stacji.
+    void countChanged();
+
+private:
+    /// Dane stacji potrzebne do wyświetlenia.
+    struct Station {
+        int id;        ///< ID stacji.
+        QString name;  ///< Nazwa stacji.
+        QString city;  ///< Nazwa miasta.
+    };
+
+    /// Odczytuje dane stacji z obiektu JSON z API.
+    static Station stationFromJson(const QJsonObject& station);
+    /// Informuje, czy stacja pasuje do tekstu aktywnego filtra.
+    bool matchesFilter(const Station& station) const;
+    /// Zwraca pozycje wierszy, które można zostawić bez zmian (najdłuższy rosnący podciąg).
+    static QVector<bool> keptRows(const QVector<int>& targetPositions);
+
+    /// Wszystkie stacje w kolejności z API.
+    QVector<Station> stations;
+    /// Indeks stacji w tablicy stations według ID.
+    QHash<int, int> indexById;
+    /// Widoczne wiersze (indeksy w tablicy stations).
+    QVector<int> rows;
+    /// Znormalizowany tekst aktywnego filtra.
+    QString activeFilter;
+};
+
+#endif // STATIONLISTMODEL_H
@@ -0,0 +1,208 @@
+#include "stationsearchindex.h"
+#include <QJsonObject>        ///< Biblioteka do obiektów JSON.
+#include <algorithm>          ///< Biblioteka do sortowania i przecięć list.
+#include <iterator>           ///< Biblioteka do std::back_inserter.
+
+/**
+ * @file stationsearchindex.cpp
+ * @brief Implementacja klasy StationSearchIndex, trigramowego indeksu wyszukiwania stacji.
+ */
+
+/**
+ * @brief Buduje indeks ze stacji pobranych z API.
+ * @param stations Tablica stacji w formacie JSON.
+ */
+void StationSearchIndex::build(const QJsonArray& stations)
+{
+    documents.clear();
+    postings.clear();
+    lastQuery.clear();
+    lastMatches.clear();
+    documents.reserve(stations.size());
+    for (int i = 0; i < stations.size(); ++i) {
+        const QJsonObject station = stations[i].toObject();
+        const QJsonObject city = station["city"].toObject();
+        const QJsonObject commune = city["commune"].toObject();
+        Document document;
+        document.name = fold(station["stationName"].toString());
+        document.city = fold(city["name"].toString());
+        document.commune = fold(commune["communeName"].toString());
+        document.province = fold(commune["provinceName"].toString());
+        document.all = document.name + "|" + document.city + "|" + document.commune + "|" + document.province;
+        for (const QString& trigram : trigrams(document.all)) {
+            postings[trigram].append(i);
+        }
+        documents.append(document);
+    }
+}
+
+/**
+ * @brief Wyszukuje stacje pasujące do tekstu.
+ * @param text Tekst wpisany przez użytkownika.
+ * @return Indeksy stacji posortowane według trafności.
+ */
+QVector<int> StationSearchIndex::search(const QString& text)
+{
+    const QString query = fold(text).trimmed();
+    QVector<int> result;
+    if (query.isEmpty()) {
+        lastQuery.clear();
+        lastMatches.clear();
+        result.reserve(documents.size());
+        for (int i = 0; i < documents.size(); ++i) {
+            result.append(i);
+        }
+        return result;
+    }
+
+    const QVector<QString> queryTrigrams = trigrams(query);
+    /// Każda stacja zawierająca nowe zapytanie zawiera też poprzednie, więc wystarczy zawęzić wynik.
+    QVector<int> candidates;
+    if (!lastQuery.isEmpty() && query.contains(lastQuery)) {
+        candidates = lastMatches;
+    } else if (!queryTrigrams.isEmpty()) {
+        QVector<const QVector<int>*> lists;
+        for (const QString& trigram : queryTrigrams) {
+            auto it = postings.constFind(trigram);
+            if (it == postings.constEnd()) {
+                lists.clear();
+                break;
+            }
+            lists.append(&it.value());
+        }
+        if (!lists.isEmpty()) {
+            std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+                return a->size() < b->size();
+            });
+            candidates = *lists.first();
+            for (int l = 1; l < lists.size() && !candidates.isEmpty(); ++l) {
+                QVector<int> intersection;
+                std::set_intersection(candidates.begin(), candidates.end(), lists[l]->begin(), lists[l]->end(),
+                                      std::back_inserter(intersection));
+                candidates = intersection;
+            }
+        }
+    } else {
+        for (int i = 0; i < documents.size(); ++i) {
+            candidates.append(i);
+        }
+    }
+
+    QVector<QPair<int, int>> ranked;
+    QVector<int> exact;
+    for (int i : candidates) {
+        if (documents[i].all.contains(query)) {
+            exact.append(i);
+            ranked.append(qMakePair(score(documents[i], query), i));
+        }
+    }
+    lastQuery = query;
+    lastMatches = exact;
+
+    /// Dopasowania przybliżone: stacje z większością trygramów zapytania (np. literówki).
+    if (exact.size() < FUZZY_MIN_RESULTS && queryTrigrams.size() >= 2) {
+        QHash<int, int> hits;
+        for (const QString& trigram : queryTrigrams) {
+            for (int i : postings.value(trigram)) {
+                ++hits[i];
+            }
+        }
+        for (auto it = hits.constBegin(); it != hits.constEnd(); ++it) {
+            const double ratio = double(it.value()) / queryTrigrams.size();
+            if (ratio >= FUZZY_MIN_RATIO && !std::binary_search(exact.begin(), exact.end(), it.key())) {
+                ranked.append(qMakePair(int(40 * ratio), it.key()));
+            }
+        }
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [this](const QPair<int, int>& a, const QPair<int, int>& b) {
+        if (a.first != b.first) {
+            return a.first > b.first;
+        }
+        return documents[a.second].name < documents[b.second].name;
+    });
+    result.reserve(ranked.size());
+    for (const QPair<int, int>& item : ranked) {
+        result.append(item.second);
+    }
+    return result;
+}
+
+/**
+ * @brief Zamienia tekst na małe litery i usuwa znaki diakrytyczne.
+ * Polskie litery są mapowane jawnie (ł nie ma rozkładu Unicode), pozostałe przez rozkład kanoniczny.
+ * @param text Tekst wejściowy.
+ * @return Tekst znormalizowany.
+ */
+QString StationSearchIndex::fold(const QString& text)
+{
+    const QString lower = text.toLower();
+    QString folded;
+    folded.reserve(lower.size());
+    for (const QChar c : lower) {
+        switch (c.unicode()) {
+        case 0x0105: folded.append('a'); break; // ą
+        case 0x0107: folded.append('c'); break; // ć
+        case 0x0119: folded.append('e'); break; // ę
+        case 0x0142: folded.append('l'); break; // ł
+        case 0x0144: folded.append('n'); break; // ń
+        case 0x00F3: folded.append('o'); break; // ó
+        case 0x015B: folded.append('s'); break; // ś
+        case 0x017A: folded.append('z'); break; // ź
+        case 0x017C: folded.append('z'); break; // ż
+        default:
+            if (c.unicode() >= 0x80 && c.decompositionTag() == QChar::Canonical) {
+                folded.append(c.decomposition().at(0));
+            } else {
+                folded.append(c);
+            }
+        }
+    }
+    return folded;
+}
+
+/**
+ * @brief Zwraca unikalne trygramy tekstu, z pominięciem tych, które przecinają granicę pól.
+ * @param text Tekst znormalizowany.
+ * @return Lista trygramów.
+ */
+QVector<QString> StationSearchIndex::trigrams(const QString& text)
+{
+    QVector<QString> result;
+    for (int i = 0; i + 3 <= text.size(); ++i) {
+        const QString trigram = text.mid(i, 3);
+        if (!trigram.contains('|') && !result.contains(trigram)) {
+            result.append(trigram);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Ocenia dopasowanie zapytania do stacji.
+ * Pełna zgodność pola > początek słowa > fragment; nazwa i miasto ważą więcej niż gmina i województwo.
+ * @param document Znormalizowana stacja.
+ * @param query Znormalizowane zapytanie.
+ * @return Ocena dopasowania.
+ */
+int StationSearchIndex::score(const Document& document, const QString& query)
+{
+    const QString* fields[] = { &document.city, &document.name, &document.commune, &document.province };
+    const int fieldPenalty[] = { 0, 0, 10, 20 };
+    int best = 0;
+    for (int f = 0; f < 4; ++f) {
+        const QString& field = *fields[f];
+        const int position = field.indexOf(query);
+        if (position < 0) {
+            continue;
+        }
+        int value = 60;
+        if (field.size() == query.size()) {
+            value = 100;
+        } else if (position == 0 || !field.at(position - 1).isLetterOrNumber()) {
+            value = 80;
+        }
+        best = std::max(best, value - fieldPenalty[f]);
+    }
+    return best;
+}
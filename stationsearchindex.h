@@ -0,0 +1,65 @@
+#ifndef STATIONSEARCHINDEX_H
+#define STATIONSEARCHINDEX_H
+
+/**
+ * @file stationsearchindex.h
+ * @brief Plik nagłówkowy dla klasy StationSearchIndex, indeksu wyszukiwania stacji.
+ */
+
+#include <QString>
+#include <QVector>             ///< Do list dopasowanych stacji.
+#include <QHash>               ///< Do list stacji według trigramów.
+#include <QJsonArray>          ///< Do listy stacji z API.
+
+/**
+ * @class StationSearchIndex
+ * @brief Indeks trigramowy nazw stacji, miast, gmin i województw z usuniętymi polskimi znakami.
+ *
+ * Budowany raz po pobraniu listy stacji. Zapytanie będące rozszerzeniem poprzedniego zawęża
+ * poprzedni wynik; w przeciwnym razie kandydaci pochodzą z przecięcia list trigramów. Przy małej
+ * liczbie trafień dokładnych dołączane są dopasowania przybliżone (wspólne trygramy).
+ */
+class StationSearchIndex
+{
+public:
+    /// Buduje indeks z tablicy stacji (kolejność jak w tablicy).
+    void build(const QJsonArray& stations);
+    /// Zwraca indeksy pasujących stacji, od najlepiej dopasowanej.
+    QVector<int> search(const QString& text);
+    /// Zwraca liczbę zaindeksowanych stacji.
+    int size() const { return documents.size(); }
+
+    /// Zamienia tekst na małe litery bez znaków diakrytycznych (np. "Łódź" -> "lodz").
+    static QString fold(const QString& text);
+
+private:
+    /// Znormalizowane pola jednej stacji.
+    struct Document {
+        QString name;      ///< Nazwa stacji.
+        QString city;      ///< Nazwa miasta.
+        QString commune;   ///< Nazwa gminy.
+        QString province;  ///< Nazwa województwa.
+        QString all;       ///< Wszystkie pola rozdzielone znakiem '|'.
+    };
+
+    /// Minimalna liczba trafień dokładnych, poniżej której dołączane są dopasowania przybliżone.
+    static constexpr int FUZZY_MIN_RESULTS = 5;
+    /// Minimalny udział wspólnych trygramów zapytania dla dopasowania przybliżonego.
+    static constexpr double FUZZY_MIN_RATIO = 0.6;
+
+    /// Zwraca unikalne trygramy tekstu.
+    static QVector<QString> trigrams(const QString& text);
+    /// Ocenia dopasowanie zapytania do stacji (wyżej = lepiej).
+    static int score(const Document& document, const QString& query);
+
+    /// Znormalizowane stacje.
+    QVector<Document> documents;
+    /// Lista stacji (rosnąco) dla każdego trygramu.
+    QHash<QString, QVector<int>> postings;
+    /// Ostatnie zapytanie (znormalizowane).
+    QString lastQuery;
+    /// Stacje zawierające ostatnie zapytanie, używane do zawężania.
+    QVector<int> lastMatches;
+};
+
+#endif // STATIONSEARCHINDEX_H
@@ -0,0 +1,251 @@
+#include "stationspatialindex.h"
+#include <QtMath>             ///< Biblioteka do stałej M_PI (również w MSVC).
+#include <algorithm>          ///< Biblioteka do sortowania i kopców.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+
+/**
+ * @file stationspatialindex.cpp
+ * @brief Implementacja klasy StationSpatialIndex, drzewa k-d współrzędnych stacji.
+ */
+
+namespace {
+/// Średni promień Ziemi (km).
+const double EARTH_RADIUS_KM = 6371.0088;
+/// Przelicznik stopni na radiany.
+const double DEG_TO_RAD = M_PI / 180.0;
+}
+
+/**
+ * @brief Buduje drzewo k-d ze stacji.
+ * @param stations Mapa ID stacji na dane stacji.
+ */
+void StationSpatialIndex::build(const QMap<int, QJsonObject>& stations)
+{
+    points.clear();
+    byLatitude.clear();
+    points.reserve(stations.size());
+    for (auto it = stations.constBegin(); it != stations.constEnd(); ++it) {
+        const double lat = coordinate(it.value()["gegrLat"]);
+        const double lon = coordinate(it.value()["gegrLon"]);
+        if (std::isnan(lat) || std::isnan(lon) || (lat == 0.0 && lon == 0.0)) {
+            continue;
+        }
+        Point point;
+        point.lat = lat;
+        point.lon = lon;
+        point.stationId = it.key();
+        toUnitVector(lat, lon, point.xyz);
+        points.append(point);
+    }
+    buildRange(0, points.size(), 0);
+
+    byLatitude.reserve(points.size());
+    for (int i = 0; i < points.size(); ++i) {
+        byLatitude.append(i);
+    }
+    std::sort(byLatitude.begin(), byLatitude.end(), [this](int a, int b) {
+        return points[a].lat < points[b].lat;
+    });
+}
+
+/**
+ * @brief Zwraca k najbliższych stacji.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param k Liczba stacji.
+ * @return Stacje posortowane od najbliższej.
+ */
+QVector<StationSpatialIndex::Hit> StationSpatialIndex::nearest(double lat, double lon, int k) const
+{
+    QVector<Hit> result;
+    if (k <= 0 || points.isEmpty()) {
+        return result;
+    }
+    double query[3];
+    toUnitVector(lat, lon, query);
+    QVector<QPair<double, int>> heap;
+    heap.reserve(k);
+    nearestRange(0, points.size(), 0, query, k, heap);
+    std::sort_heap(heap.begin(), heap.end());
+    for (const QPair<double, int>& item : heap) {
+        Hit hit;
+        hit.stationId = points[item.second].stationId;
+        hit.distanceKm = chordSqToKm(item.first);
+        result.append(hit);
+    }
+    return result;
+}
+
+/**
+ * @brief Zwraca stacje w zadanym promieniu.
+ * @param lat Szerokość geograficzna punktu.
+ * @param lon Długość geograficzna punktu.
+ * @param radiusKm Promień w km.
+ * @return Stacje posortowane od najbliższej.
+ */
+QVector<StationSpatialIndex::Hit> StationSpatialIndex::withinRadius(double lat, double lon, double radiusKm) const
+{
+    QVector<Hit> result;
+    if (radiusKm <= 0.0 || points.isEmpty()) {
+        return result;
+    }
+    double query[3];
+    toUnitVector(lat, lon, query);
+    const double angle = std::min(radiusKm / EARTH_RADIUS_KM, M_PI);
+    const double chord = 2.0 * std::sin(angle / 2.0);
+    QVector<QPair<double, int>> hits;
+    radiusRange(0, points.size(), 0, query, chord * chord, hits);
+    std::sort(hits.begin(), hits.end());
+    for (const QPair<double, int>& item : hits) {
+        Hit hit;
+        hit.stationId = points[item.second].stationId;
+        hit.distanceKm = chordSqToKm(item.first);
+        result.append(hit);
+    }
+    return result;
+}
+
+/**
+ * @brief Zwraca stacje wewnątrz prostokąta współrzędnych.
+ * @param minLat Minimalna szerokość.
+ * @param minLon Minimalna długość.
+ * @param maxLat Maksymalna szerokość.
+ * @param maxLon Maksymalna długość.
+ * @return ID stacji (rosnąco według szerokości).
+ */
+QVector<int> StationSpatialIndex::inBoundingBox(double minLat, double minLon, double maxLat, double maxLon) const
+{
+    QVector<int> result;
+    auto first = std::lower_bound(byLatitude.begin(), byLatitude.end(), minLat, [this](int i, double value) {
+        return points[i].lat < value;
+    });
+    for (auto it = first; it != byLatitude.end() && points[*it].lat <= maxLat; ++it) {
+        const Point& point = points[*it];
+        if (point.lon >= minLon && point.lon <= maxLon) {
+            result.append(point.stationId);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Odczytuje współrzędną zapisaną jako liczba lub tekst (API zwraca tekst).
+ * @param value Wartość JSON.
+ * @return Współrzędna lub NaN, jeśli nie da się jej odczytać.
+ */
+double StationSpatialIndex::coordinate(const QJsonValue& value)
+{
+    if (value.isDouble()) {
+        return value.toDouble();
+    }
+    bool ok = false;
+    const double result = value.toString().toDouble(&ok);
+    return ok ? result : std::nan("");
+}
+
+/**
+ * @brief Układa punkty zakresu w niejawne drzewo k-d.
+ * Węzeł to mediana zakresu względem osi depth % 3; lewe poddrzewo leży przed nim, prawe za nim.
+ */
+void StationSpatialIndex::buildRange(int begin, int end, int depth)
+{
+    if (end - begin <= 1) {
+        return;
+    }
+    const int axis = depth % 3;
+    const int mid = (begin + end) / 2;
+    std::nth_element(points.begin() + begin, points.begin() + mid, points.begin() + end,
+                     [axis](const Point& a, const Point& b) { return a.xyz[axis] < b.xyz[axis]; });
+    buildRange(begin, mid, depth + 1);
+    buildRange(mid + 1, end, depth + 1);
+}
+
+/**
+ * @brief Przeszukuje poddrzewo, utrzymując kopiec maksymalny k najbliższych punktów.
+ */
+void StationSpatialIndex::nearestRange(int begin, int end, int depth, const double query[3], int k, QVector<QPair<double, int>>& heap) const
+{
+    if (begin >= end) {
+        return;
+    }
+    const int axis = depth % 3;
+    const int mid = (begin + end) / 2;
+    const double d = distanceSq(points[mid].xyz, query);
+    if (heap.size() < k) {
+        heap.append(qMakePair(d, mid));
+        std::push_heap(heap.begin(), heap.end());
+    } else if (d < heap.front().first) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = qMakePair(d, mid);
+        std::push_heap(heap.begin(), heap.end());
+    }
+    const double diff = query[axis] - points[mid].xyz[axis];
+    const bool leftFirst = diff < 0;
+    if (leftFirst) {
+        nearestRange(begin, mid, depth + 1, query, k, heap);
+    } else {
+        nearestRange(mid + 1, end, depth + 1, query, k, heap);
+    }
+    if (heap.size() < k || diff * diff < heap.front().first) {
+        if (leftFirst) {
+            nearestRange(mid + 1, end, depth + 1, query, k, heap);
+        } else {
+            nearestRange(begin, mid, depth + 1, query, k, heap);
+        }
+    }
+}
+
+/**
+ * @brief Zbiera punkty poddrzewa w zadanym kwadracie odległości cięciwy.
+ */
+void StationSpatialIndex::radiusRange(int begin, int end, int depth, const double query[3], double maxChordSq, QVector<QPair<double, int>>& hits) const
+{
+    if (begin >= end) {
+        return;
+    }
+    const int axis = depth % 3;
+    const int mid = (begin + end) / 2;
+    const double d = distanceSq(points[mid].xyz, query);
+    if (d <= maxChordSq) {
+        hits.append(qMakePair(d, mid));
+    }
+    const double diff = query[axis] - points[mid].xyz[axis];
+    if (diff < 0 || diff * diff <= maxChordSq) {
+        radiusRange(begin, mid, depth + 1, query, maxChordSq, hits);
+    }
+    if (diff >= 0 || diff * diff <= maxChordSq) {
+        radiusRange(mid + 1, end, depth + 1, query, maxChordSq, hits);
+    }
+}
+
+/**
+ * @brief Zamienia współrzędne geograficzne na punkt na sferze jednostkowej.
+ */
+void StationSpatialIndex::toUnitVector(double lat, double lon, double xyz[3])
+{
+    const double phi = lat * DEG_TO_RAD;
+    const double lambda = lon * DEG_TO_RAD;
+    xyz[0] = std::cos(phi) * std::cos(lambda);
+    xyz[1] = std::cos(phi) * std::sin(lambda);
+    xyz[2] = std::sin(phi);
+}
+
+/**
+ * @brief Zwraca kwadrat odległości euklidesowej między punktami.
+ */
+double StationSpatialIndex::distanceSq(const double a[3], const double b[3])
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+/**
+ * @brief Zamienia kwadrat cięciwy sfery jednostkowej na odległość po powierzchni Ziemi.
+ */
+double StationSpatialIndex::chordSqToKm(double chordSq)
+{
+    const double half = std::min(std::sqrt(chordSq) / 2.0, 1.0);
+    return 2.0 * std::asin(half) * EARTH_RADIUS_KM;
+}
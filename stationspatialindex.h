@@ -0,0 +1,72 @@
+#ifndef STATIONSPATIALINDEX_H
+#define STATIONSPATIALINDEX_H
+
+/**
+ * @file stationspatialindex.h
+ * @brief Plik nagłówkowy dla klasy StationSpatialIndex, indeksu przestrzennego stacji.
+ */
+
+#include <QVector>             ///< Do przechowywania punktów i wyników.
+#include <QMap>                ///< Do mapy stacji.
+#include <QJsonObject>         ///< Do danych stacji.
+
+/**
+ * @class StationSpatialIndex
+ * @brief Drzewo k-d współrzędnych stacji (gegrLat/gegrLon) do zapytań o sąsiedztwo.
+ *
+ * Punkty są rzutowane na sferę jednostkową (x, y, z), więc odległość euklidesowa (cięciwa) rośnie
+ * razem z odległością po powierzchni Ziemi i drzewo k-d zwraca dokładnych najbliższych sąsiadów.
+ * Zapytania prostokątne korzystają z listy posortowanej według szerokości geograficznej.
+ */
+class StationSpatialIndex
+{
+public:
+    /// Wynik zapytania: stacja i jej odległość od punktu zapytania.
+    struct Hit {
+        int stationId = 0;       ///< ID stacji.
+        double distanceKm = 0.0; ///< Odległość po powierzchni Ziemi (km).
+    };
+
+    /// Buduje indeks z mapy stacji (pomija stacje bez poprawnych współrzędnych).
+    void build(const QMap<int, QJsonObject>& stations);
+    /// Zwraca k najbliższych stacji, od najbliższej.
+    QVector<Hit> nearest(double lat, double lon, int k) const;
+    /// Zwraca stacje w promieniu (km), od najbliższej.
+    QVector<Hit> withinRadius(double lat, double lon, double radiusKm) const;
+    /// Zwraca ID stacji wewnątrz prostokąta współrzędnych.
+    QVector<int> inBoundingBox(double minLat, double minLon, double maxLat, double maxLon) const;
+    /// Zwraca liczbę zaindeksowanych stacji.
+    int size() const { return points.size(); }
+
+    /// Odczytuje współrzędną zapisaną w JSON jako liczba lub tekst.
+    static double coordinate(const QJsonValue& value);
+
+private:
+    /// Punkt drzewa.
+    struct Point {
+        double xyz[3];      ///< Położenie na sferze jednostkowej.
+        double lat;         ///< Szerokość geograficzna.
+        double lon;         ///< Długość geograficzna.
+        int stationId;      ///< ID stacji.
+    };
+
+    /// Układa punkty z zakresu w niejawne drzewo k-d (mediana w środku zakresu).
+    void buildRange(int begin, int end, int depth);
+    /// Przeszukuje poddrzewo w poszukiwaniu k najbliższych punktów.
+    void nearestRange(int begin, int end, int depth, const double query[3], int k, QVector<QPair<double, int>>& heap) const;
+    /// Zbiera punkty poddrzewa w zadanej odległości cięciwy.
+    void radiusRange(int begin, int end, int depth, const double query[3], double maxChordSq, QVector<QPair<double, int>>& hits) const;
+    /// Zamienia współrzędne geograficzne na punkt na sferze jednostkowej.
+    static void toUnitVector(double lat, double lon, double xyz[3]);
+    /// Zwraca kwadrat odległości euklidesowej.
+    static double distanceSq(const double a[3], const double b[3]);
+    /// Zamienia kwadrat cięciwy na odległość w km.
+    static double chordSqToKm(double chordSq);
+
+    /// Punkty ułożone jako niejawne drzewo k-d.
+    QVector<Point> points;
+    /// Indeksy punktów posortowane według szerokości geograficznej.
+    QVector<int> byLatitude;
+};
+
+#endif // STATIONSPATIALINDEX_H
@@ -0,0 +1,285 @@
+#include "statskernels.h"
+#include <QtAlgorithms>       ///< Biblioteka do zliczania ustawionych bitów (qPopulationCount).
+#include <algorithm>          ///< Biblioteka do min/max.
+#include <cmath>              ///< Biblioteka do operacji matematycznych.
+#include <limits>             ///< Biblioteka do wartości granicznych typów.
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) \
+    || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STATS_KERNELS_X86 1
+#include <immintrin.h>        ///< Biblioteka do instrukcji SSE2/AVX2.
+#if defined(_MSC_VER)
+#include <intrin.h>           ///< Biblioteka do odczytu CPUID.
+#endif
+#endif
+
+#if defined(STATS_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+/// Kompiluje funkcję z AVX2 bez włączania AVX2 dla całego programu.
+#define STATS_KERNELS_AVX2 __attribute__((target("avx2")))
+#else
+#define STATS_KERNELS_AVX2
+#endif
+
+/**
+ * @file statskernels.cpp
+ * @brief Implementacja klasy StatsKernels, wektorowych obliczeń statystyk na kolumnach wartości.
+ */
+
+namespace {
+/// Zwraca bity braków dla `lanes` punktów od indeksu i (bloki nie przekraczają granicy słowa mapy).
+inline quint32 nullBits(const quint64* nullMask, int i, int lanes)
+{
+    return nullMask ? quint32((nullMask[i >> 6] >> (i & 63)) & ((quint64(1) << lanes) - 1)) : 0u;
+}
+
+/// Informuje, czy punkt i jest brakiem.
+inline bool isNull(const quint64* nullMask, int i)
+{
+    return nullMask && ((nullMask[i >> 6] >> (i & 63)) & 1);
+}
+
+/// Dolicza punkty [from, to) pętlą skalarną.
+void accumulateScalar(const float* values, const quint64* nullMask, int from, int to, float threshold,
+                      StatsKernels::Summary* summary)
+{
+    for (int i = from; i < to; ++i) {
+        const float value = values[i];
+        if (isNull(nullMask, i) || !std::isfinite(value)) {
+            continue;
+        }
+        const double delta = double(value) - summary->shift;
+        ++summary->count;
+        summary->min = std::min(summary->min, value);
+        summary->max = std::max(summary->max, value);
+        summary->sum += delta;
+        summary->sumSquares += delta * delta;
+        summary->exceedances += value > threshold ? 1 : 0;
+    }
+}
+
+#ifdef STATS_KERNELS_X86
+/// Dolicza pełne bloki po 4 wartości (SSE2); zwraca indeks pierwszego nieprzetworzonego punktu.
+int accumulateSse2(const float* values, const quint64* nullMask, int size, float threshold,
+                   StatsKernels::Summary* summary)
+{
+    const __m128i bitSelect = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 positiveInf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    const __m128 negativeInf = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+    const __m128 thresholdV = _mm_set1_ps(threshold);
+    const __m128 shiftF = _mm_set1_ps(float(summary->shift));
+    const __m128d shiftD = _mm_set1_pd(double(float(summary->shift)));
+    __m128 minV = positiveInf;
+    __m128 maxV = negativeInf;
+    __m128d sumLo = _mm_setzero_pd(), sumHi = _mm_setzero_pd();
+    __m128d squaresLo = _mm_setzero_pd(), squaresHi = _mm_setzero_pd();
+    int count = 0;
+    int exceedances = 0;
+    int i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m128 x = _mm_loadu_ps(values + i);
+        const __m128i bits = _mm_set1_epi32(int(nullBits(nullMask, i, 4)));
+        const __m128 notNull = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(bits, bitSelect), _mm_setzero_si128()));
+        /// x - x daje 0 tylko dla liczb skończonych (NaN i inf dają NaN).
+        const __m128 valid = _mm_and_ps(notNull, _mm_cmpeq_ps(_mm_sub_ps(x, x), zero));
+        count += qPopulationCount(quint32(_mm_movemask_ps(valid)));
+        exceedances += qPopulationCount(quint32(_mm_movemask_ps(_mm_and_ps(valid, _mm_cmpgt_ps(x, thresholdV)))));
+        minV = _mm_min_ps(minV, _mm_or_ps(_mm_and_ps(valid, x), _mm_andnot_ps(valid, positiveInf)));
+        maxV = _mm_max_ps(maxV, _mm_or_ps(_mm_and_ps(valid, x), _mm_andnot_ps(valid, negativeInf)));
+        /// Nieważne punkty są zastępowane przesunięciem, więc wnoszą 0 do sum.
+        const __m128 shifted = _mm_or_ps(_mm_and_ps(valid, x), _mm_andnot_ps(valid, shiftF));
+        const __m128d lo = _mm_sub_pd(_mm_cvtps_pd(shifted), shiftD);
+        const __m128d hi = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(shifted, shifted)), shiftD);
+        sumLo = _mm_add_pd(sumLo, lo);
+        sumHi = _mm_add_pd(sumHi, hi);
+        squaresLo = _mm_add_pd(squaresLo, _mm_mul_pd(lo, lo));
+        squaresHi = _mm_add_pd(squaresHi, _mm_mul_pd(hi, hi));
+    }
+    float mins[4], maxs[4];
+    double sums[2], squares[2];
+    _mm_storeu_ps(mins, minV);
+    _mm_storeu_ps(maxs, maxV);
+    _mm_storeu_pd(sums, _mm_add_pd(sumLo, sumHi));
+    _mm_storeu_pd(squares, _mm_add_pd(squaresLo, squaresHi));
+    for (int lane = 0; lane < 4; ++lane) {
+        summary->min = std::min(summary->min, mins[lane]);
+        summary->max = std::max(summary->max, maxs[lane]);
+    }
+    summary->count += count;
+    summary->exceedances += exceedances;
+    summary->sum += sums[0] + sums[1];
+    summary->sumSquares += squares[0] + squares[1];
+    return i;
+}
+
+/// Dolicza pełne bloki po 8 wartości (AVX2); zwraca indeks pierwszego nieprzetworzonego punktu.
+STATS_KERNELS_AVX2
+int accumulateAvx2(const float* values, const quint64* nullMask, int size, float threshold,
+                   StatsKernels::Summary* summary)
+{
+    const __m256i bitSelect = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 positiveInf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    const __m256 negativeInf = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    const __m256 thresholdV = _mm256_set1_ps(threshold);
+    const __m256 shiftF = _mm256_set1_ps(float(summary->shift));
+    const __m256d shiftD = _mm256_set1_pd(double(float(summary->shift)));
+    __m256 minV = positiveInf;
+    __m256 maxV = negativeInf;
+    __m256d sumLo = _mm256_setzero_pd(), sumHi = _mm256_setzero_pd();
+    __m256d squaresLo = _mm256_setzero_pd(), squaresHi = _mm256_setzero_pd();
+    int count = 0;
+    int exceedances = 0;
+    int i = 0;
+    for (; i + 8 <= size; i += 8) {
+        const __m256 x = _mm256_loadu_ps(values + i);
+        const __m256i bits = _mm256_set1_epi32(int(nullBits(nullMask, i, 8)));
+        const __m256 notNull = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_and_si256(bits, bitSelect), _mm256_setzero_si256()));
+        const __m256 valid = _mm256_and_ps(notNull, _mm256_cmp_ps(_mm256_sub_ps(x, x), zero, _CMP_EQ_OQ));
+        count += qPopulationCount(quint32(_mm256_movemask_ps(valid)));
+        exceedances += qPopulationCount(quint32(_mm256_movemask_ps(
+            _mm256_and_ps(valid, _mm256_cmp_ps(x, thresholdV, _CMP_GT_OQ)))));
+        minV = _mm256_min_ps(minV, _mm256_blendv_ps(positiveInf, x, valid));
+        maxV = _mm256_max_ps(maxV, _mm256_blendv_ps(negativeInf, x, valid));
+        const __m256 shifted = _mm256_blendv_ps(shiftF, x, valid);
+        const __m256d lo = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(shifted)), shiftD);
+        const __m256d hi = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(shifted, 1)), shiftD);
+        sumLo = _mm256_add_pd(sumLo, lo);
+        sumHi = _mm256_add_pd(sumHi, hi);
+        squaresLo = _mm256_add_pd(squaresLo, _mm256_mul_pd(lo, lo));
+        squaresHi = _mm256_add_pd(squaresHi, _mm256_mul_pd(hi, hi));
+    }
+    float mins[8], maxs[8];
+    double sums[4], squares[4];
+    _mm256_storeu_ps(mins, minV);
+    _mm256_storeu_ps(maxs, maxV);
+    _mm256_storeu_pd(sums, _mm256_add_pd(sumLo, sumHi));
+    _mm256_storeu_pd(squares, _mm256_add_pd(squaresLo, squaresHi));
+    for (int lane = 0; lane < 8; ++lane) {
+        summary->min = std::min(summary->min, mins[lane]);
+        summary->max = std::max(summary->max, maxs[lane]);
+    }
+    for (int lane = 0; lane < 4; ++lane) {
+        summary->sum += sums[lane];
+        summary->sumSquares += squares[lane];
+    }
+    summary->count += count;
+    summary->exceedances += exceedances;
+    return i;
+}
+
+/// Sprawdza, czy procesor i system obsługują AVX2.
+bool cpuSupportsAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+}
+
+/**
+ * @brief Zwraca wariancję populacyjną z sum względem przesunięcia.
+ * @return Wariancja (0 dla mniej niż dwóch wartości).
+ */
+double StatsKernels::Summary::variance() const
+{
+    if (count < 2) {
+        return 0.0;
+    }
+    const double meanDelta = sum / count;
+    return std::max(0.0, sumSquares / count - meanDelta * meanDelta);
+}
+
+/**
+ * @brief Podsumowuje kolumnę wartości jednym przebiegiem.
+ * @param values Wartości.
+ * @param nullMask Mapa braków (bit 1 = brak, 64 punkty na słowo) lub nullptr.
+ * @param size Liczba punktów.
+ * @param threshold Próg przekroczeń (np. norma dobowa).
+ * @param implementation Wariant implementacji (Auto wybiera najlepszy dostępny).
+ * @return Podsumowanie; min i max równe 0, jeśli nie ma ważnych wartości.
+ */
+StatsKernels::Summary StatsKernels::summarize(const float* values, const quint64* nullMask, int size, float threshold,
+                                              Implementation implementation)
+{
+    Summary summary;
+    summary.min = std::numeric_limits<float>::infinity();
+    summary.max = -std::numeric_limits<float>::infinity();
+    /// Przesunięcie: pierwsza ważna wartość (zwykle indeks 0).
+    for (int i = 0; i < size; ++i) {
+        if (!isNull(nullMask, i) && std::isfinite(values[i])) {
+            summary.shift = values[i];
+            break;
+        }
+    }
+    if (implementation == Implementation::Auto) {
+        implementation = bestImplementation();
+    }
+    int done = 0;
+#ifdef STATS_KERNELS_X86
+    if (implementation == Implementation::Avx2) {
+        done = accumulateAvx2(values, nullMask, size, threshold, &summary);
+    } else if (implementation == Implementation::Sse2) {
+        done = accumulateSse2(values, nullMask, size, threshold, &summary);
+    }
+#endif
+    accumulateScalar(values, nullMask, done, size, threshold, &summary);
+    if (summary.count == 0) {
+        summary.min = 0.0f;
+        summary.max = 0.0f;
+    }
+    return summary;
+}
+
+/**
+ * @brief Zwraca najlepszy wariant dla tego procesora (sprawdzany raz).
+ * @return Avx2, Sse2 lub Scalar.
+ */
+StatsKernels::Implementation StatsKernels::bestImplementation()
+{
+#ifdef STATS_KERNELS_X86
+    static const Implementation best = cpuSupportsAvx2() ? Implementation::Avx2 : Implementation::Sse2;
+    return best;
+#else
+    return Implementation::Scalar;
+#endif
+}
+
+/**
+ * @brief Zwraca nazwę wariantu.
+ * @param implementation Wariant implementacji.
+ * @return Nazwa do logów.
+ */
+const char* StatsKernels::implementationName(Implementation implementation)
+{
+    switch (implementation) {
+    case Implementation::Auto:
+        return implementationName(bestImplementation());
+    case Implementation::Scalar:
+        return "skalarny";
+    case Implementation::Sse2:
+        return "SSE2";
+    case Implementation::Avx2:
+        return "AVX2";
+    }
+    return "";
+}
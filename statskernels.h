@@ -0,0 +1,57 @@
+#ifndef STATSKERNELS_H
+#define STATSKERNELS_H
+
+/**
+ * @file statskernels.h
+ * @brief Plik nagłówkowy dla klasy StatsKernels, wektorowych obliczeń statystyk na kolumnach wartości.
+ */
+
+#include <QtGlobal>            ///< Do typów całkowitych Qt.
+
+/**
+ * @class StatsKernels
+ * @brief Jednoprzebiegowe podsumowanie kolumny float z mapą braków: liczba, min, max, suma, suma kwadratów
+ * i liczba przekroczeń progu.
+ *
+ * Implementacja jest wybierana raz, przy pierwszym wywołaniu: AVX2 (8 wartości naraz), SSE2 (4 wartości)
+ * lub pętla skalarna. Braki (bit 1 w mapie, 64 punkty na słowo) oraz wartości NaN/inf są pomijane
+ * bez rozgałęzień. Sumy liczone są w double względem pierwszej ważnej wartości (przesunięcie), co chroni
+ * wariancję przed utratą dokładności przy dużej średniej.
+ */
+class StatsKernels
+{
+public:
+    /// Wariant implementacji.
+    enum class Implementation {
+        Auto,    ///< Najlepszy dostępny na tym procesorze.
+        Scalar,  ///< Pętla skalarna.
+        Sse2,    ///< SSE2 (4 wartości naraz).
+        Avx2     ///< AVX2 (8 wartości naraz).
+    };
+
+    /// Wynik podsumowania kolumny.
+    struct Summary {
+        int count = 0;              ///< Liczba ważnych wartości.
+        float min = 0.0f;           ///< Najmniejsza wartość.
+        float max = 0.0f;           ///< Największa wartość.
+        double shift = 0.0;         ///< Przesunięcie, względem którego liczone są sumy.
+        double sum = 0.0;           ///< Suma (wartość - shift).
+        double sumSquares = 0.0;    ///< Suma (wartość - shift)^2.
+        int exceedances = 0;        ///< Liczba wartości większych od progu.
+
+        /// Zwraca średnią.
+        double mean() const { return count > 0 ? shift + sum / count : 0.0; }
+        /// Zwraca wariancję populacyjną.
+        double variance() const;
+    };
+
+    /// Podsumowuje kolumnę wartości (nullMask może być nullptr, jeśli braków nie ma).
+    static Summary summarize(const float* values, const quint64* nullMask, int size, float threshold,
+                             Implementation implementation = Implementation::Auto);
+    /// Zwraca wariant wybierany dla Implementation::Auto.
+    static Implementation bestImplementation();
+    /// Zwraca nazwę wariantu (do logów).
+    static const char* implementationName(Implementation implementation);
+};
+
+#endif // STATSKERNELS_H
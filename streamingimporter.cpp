@@ -0,0 +1,511 @@
+#include "streamingimporter.h"
+#include <QDebug>              ///< Biblioteka do logowania komunikatów debugowania.
+#include <QDateTime>           ///< Biblioteka do obsługi dat i czasu.
+#include <QFile>               ///< Biblioteka do odczytu pliku.
+#include <QFileInfo>           ///< Biblioteka do informacji o plikach.
+#include <QHash>               ///< Biblioteka do paczek według czujnika.
+#include <QXmlStreamReader>    ///< Biblioteka do strumieniowego odczytu XML.
+#include <QtConcurrent>        ///< Biblioteka do odczytu w puli wątków.
+#include <cmath>               ///< Biblioteka do operacji matematycznych.
+
+/**
+ * @file streamingimporter.cpp
+ * @brief Implementacja klasy StreamingImporter, strumieniowego importu dużych plików XML i CSV.
+ */
+
+namespace {
+/// Format klucza daty rekordu historii.
+const QString DATE_KEY_FORMAT = "yyyyMMdd_HHmmss";
+
+/// Kolumny pliku CSV (-1 = brak kolumny).
+struct CsvColumns {
+    int sensor = -1;
+    int date = -1;
+    int value = -1;
+    int key = -1;
+};
+
+/// Dzieli wiersz CSV na pola: separator w cudzysłowie nie dzieli pola, a "" oznacza znak cudzysłowu.
+/// Cudzysłowy są usuwane, a spacje wokół pól obcinane.
+QList<QByteArray> splitFields(const QByteArray& line, char delimiter)
+{
+    QList<QByteArray> fields;
+    QByteArray field;
+    bool quoted = false;
+    for (int i = 0; i < line.size(); ++i) {
+        const char c = line[i];
+        if (quoted) {
+            if (c != '"') {
+                field.append(c);
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                field.append('"');
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            fields.append(field.trimmed());
+            field.clear();
+        } else {
+            field.append(c);
+        }
+    }
+    fields.append(field.trimmed());
+    return fields;
+}
+
+/// Wykrywa separator pierwszego wiersza (';', tabulator lub ','), pomijając znaki w cudzysłowie.
+char detectDelimiter(const QByteArray& line)
+{
+    int semicolons = 0;
+    int tabs = 0;
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (!quoted && c == ';') {
+            ++semicolons;
+        } else if (!quoted && c == '\t') {
+            ++tabs;
+        }
+    }
+    return semicolons > 0 ? ';' : (tabs > 0 ? '\t' : ',');
+}
+
+/// Rozpoznaje nagłówek CSV po nazwach kolumn; false, jeśli pierwszy wiersz zawiera dane.
+bool headerColumns(const QList<QByteArray>& fields, CsvColumns* columns)
+{
+    static const QStringList DATE_NAMES = {"date", "data", "czas", "datetime", "timestamp"};
+    static const QStringList VALUE_NAMES = {"value", "wartosc", "wartość", "stezenie", "stężenie"};
+    static const QStringList SENSOR_NAMES = {"sensorid", "sensor_id", "sensor", "id", "czujnik", "id czujnika"};
+    static const QStringList KEY_NAMES = {"key", "param", "paramcode", "parametr", "kod"};
+    bool header = false;
+    for (int i = 0; i < fields.size(); ++i) {
+        const QString name = QString::fromUtf8(fields[i]).toLower();
+        if (DATE_NAMES.contains(name)) {
+            columns->date = i;
+        } else if (VALUE_NAMES.contains(name)) {
+            columns->value = i;
+        } else if (SENSOR_NAMES.contains(name)) {
+            columns->sensor = i;
+        } else if (KEY_NAMES.contains(name)) {
+            columns->key = i;
+        } else {
+            continue;
+        }
+        header = true;
+    }
+    return header;
+}
+
+/// Odczytuje datę pomiaru (format API, ISO 8601 lub zapisy spotykane w arkuszach).
+bool parseCsvDate(const QByteArray& field, qint64* timestampMs)
+{
+    const QString text = QString::fromUtf8(field);
+    if (MeasurementSeries::parseDate(text, timestampMs)) {
+        return true;
+    }
+    static const QStringList FORMATS = {"yyyy-MM-dd HH:mm", "dd.MM.yyyy HH:mm:ss", "dd.MM.yyyy HH:mm", "yyyy/MM/dd HH:mm:ss"};
+    for (const QString& format : FORMATS) {
+        const QDateTime dateTime = QDateTime::fromString(text, format);
+        if (dateTime.isValid()) {
+            *timestampMs = dateTime.toMSecsSinceEpoch();
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Odczytuje wartość pomiaru (także z przecinkiem dziesiętnym); isNull oznacza brak pomiaru.
+/// False dla nieprawidłowej wartości.
+bool parseValue(QByteArray field, float* value, bool* isNull)
+{
+    const QByteArray lower = field.toLower();
+    if (field.isEmpty() || lower == "null" || lower == "nan" || field == "-" || lower == "brak") {
+        *isNull = true;
+        return true;
+    }
+    /// Przecinek w polu to przecinek dziesiętny (przy separatorze ',' pole musiało być w cudzysłowie).
+    if (field.contains(',') && !field.contains('.')) {
+        field.replace(',', '.');
+    }
+    bool ok = false;
+    const double number = field.toDouble(&ok);
+    if (!ok || std::isinf(number)) {
+        return false;
+    }
+    *isNull = false;
+    *value = float(number);
+    return true;
+}
+
+/// Dodaje punkt do szeregu paczki.
+void appendPoint(MeasurementSeries* series, qint64 timestampMs, float value, bool isNull)
+{
+    if (isNull) {
+        series->appendNull(timestampMs);
+    } else {
+        series->append(timestampMs, value);
+    }
+}
+
+/// Zwraca kod parametru z danych czujnika (klucz szeregu).
+QString sensorParamCode(const QJsonObject& sensorInfo)
+{
+    return sensorInfo["param"].toObject()["paramCode"].toString();
+}
+}
+
+/**
+ * @brief Konstruktor klasy StreamingImporter.
+ * @param store Magazyn historii, do którego trafiają paczki.
+ * @param parent Opcjonalny rodzic obiektu.
+ */
+StreamingImporter::StreamingImporter(HistoryStore* store, QObject *parent)
+    : QObject(parent), store(store), pendingSlots(MAX_PENDING_CHUNKS), fileSize(0), skippedCount(0),
+      pointCount(0), recordCount(0)
+{
+    watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, &StreamingImporter::finish);
+}
+
+/**
+ * @brief Destruktor klasy StreamingImporter.
+ * Przerywa odczyt, odblokowuje wątek roboczy czekający na miejsce w kolejce i czeka na jego zakończenie.
+ */
+StreamingImporter::~StreamingImporter()
+{
+    watcher->disconnect(this);
+    stopRequested.storeRelease(1);
+    pendingSlots.release(MAX_PENDING_CHUNKS);
+    watcher->waitForFinished();
+}
+
+/**
+ * @brief Uruchamia odczyt pliku w wątku roboczym.
+ * @param path Ścieżka pliku .xml lub .csv.
+ * @param defaultSensorId Czujnik dla plików bez ID czujnika (0 = brak).
+ * @param defaultSensorInfo Dane czujnika domyślnego zapisywane w rekordach.
+ * @return True, jeśli import wystartował.
+ */
+bool StreamingImporter::start(const QString& path, int defaultSensorId, const QJsonObject& defaultSensorInfo)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (isRunning() || !store->isOpen() || (suffix != "csv" && suffix != "xml")) {
+        return false;
+    }
+    fileSize = QFileInfo(path).size();
+    skippedCount = 0;
+    pointCount = 0;
+    recordCount = 0;
+    writeError.clear();
+    stopRequested.storeRelease(0);
+    emit progress(0, fileSize);
+    watcher->setFuture(QtConcurrent::run([this, path, suffix, defaultSensorId, defaultSensorInfo]() -> QString {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return "Błąd odczytu pliku: " + file.errorString();
+        }
+        const ChunkSink sink = [this](const Chunk& chunk) {
+            /// Czeka, aż wątek główny zapisze wcześniejsze paczki (ogranicza zużycie pamięci).
+            pendingSlots.acquire();
+            if (stopRequested.loadAcquire()) {
+                pendingSlots.release();
+                return false;
+            }
+            QMetaObject::invokeMethod(this, [this, chunk]() { writeChunk(chunk); }, Qt::QueuedConnection);
+            return true;
+        };
+        int skipped = 0;
+        const QString error = suffix == "csv"
+            ? readCsv(&file, CHUNK_POINTS, defaultSensorId, defaultSensorInfo, sink, &skipped)
+            : readXml(&file, CHUNK_POINTS, defaultSensorId, defaultSensorInfo, sink, &skipped);
+        skippedCount = skipped;
+        return error;
+    }));
+    return true;
+}
+
+/**
+ * @brief Anuluje import; paczki czekające na zapis są pomijane.
+ */
+void StreamingImporter::cancel()
+{
+    stopRequested.storeRelease(1);
+}
+
+/**
+ * @brief Informuje, czy import jest w toku.
+ * @return True, jeśli plik jest jeszcze czytany.
+ */
+bool StreamingImporter::isRunning() const
+{
+    return watcher->isRunning();
+}
+
+/**
+ * @brief Czyta plik CSV wiersz po wierszu.
+ * @param device Otwarte urządzenie z danymi.
+ * @param chunkSize Liczba punktów w paczce.
+ * @param defaultSensorId Czujnik dla pliku bez kolumny czujnika.
+ * @param defaultSensorInfo Dane czujnika domyślnego.
+ * @param sink Odbiorca paczek; false przerywa odczyt.
+ * @param skippedLines Liczba pominiętych wierszy.
+ * @return Opis błędu lub pusty napis.
+ */
+QString StreamingImporter::readCsv(QIODevice* device, int chunkSize, int defaultSensorId, const QJsonObject& defaultSensorInfo,
+                                   const ChunkSink& sink, int* skippedLines)
+{
+    *skippedLines = 0;
+    QHash<int, Chunk> chunks;
+    CsvColumns columns;
+    char delimiter = 0;
+    int requiredFields = 0;
+    bool firstLine = true;
+    while (!device->atEnd()) {
+        QByteArray line = device->readLine();
+        if (firstLine && line.startsWith("\xEF\xBB\xBF")) {
+            line.remove(0, 3);
+        }
+        firstLine = false;
+        line = line.trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        if (delimiter == 0) {
+            delimiter = detectDelimiter(line);
+            if (headerColumns(splitFields(line, delimiter), &columns)) {
+                if (columns.date < 0 || columns.value < 0) {
+                    return "Nagłówek CSV nie zawiera kolumn daty i wartości";
+                }
+                if (columns.sensor < 0 && defaultSensorId <= 0) {
+                    return "Plik CSV nie ma kolumny ID czujnika, a nie wybrano czujnika";
+                }
+                requiredFields = qMax(qMax(columns.date, columns.value), qMax(columns.sensor, columns.key)) + 1;
+                continue;
+            }
+            const int count = splitFields(line, delimiter).size();
+            columns.sensor = count >= 3 ? 0 : -1;
+            columns.date = count >= 3 ? 1 : 0;
+            columns.value = columns.date + 1;
+            if (columns.sensor < 0 && defaultSensorId <= 0) {
+                return "Plik CSV nie ma kolumny ID czujnika, a nie wybrano czujnika";
+            }
+            requiredFields = columns.value + 1;
+        }
+        const QList<QByteArray> fields = splitFields(line, delimiter);
+        int sensorId = defaultSensorId;
+        if (fields.size() >= requiredFields && columns.sensor >= 0) {
+            sensorId = fields[columns.sensor].toInt();
+        }
+        qint64 timestampMs = 0;
+        float value = 0.0f;
+        bool isNull = false;
+        if (fields.size() < requiredFields || sensorId <= 0 || !parseCsvDate(fields[columns.date], &timestampMs)
+            || !parseValue(fields[columns.value], &value, &isNull)) {
+            ++*skippedLines;
+            continue;
+        }
+        auto it = chunks.find(sensorId);
+        if (it == chunks.end()) {
+            Chunk chunk;
+            chunk.sensorId = sensorId;
+            chunk.sensorInfo = sensorId == defaultSensorId ? defaultSensorInfo : QJsonObject{{"id", sensorId}};
+            chunk.series.setKey(columns.key >= 0 ? QString::fromUtf8(fields[columns.key]) : sensorParamCode(chunk.sensorInfo));
+            chunk.series.reserve(chunkSize);
+            it = chunks.insert(sensorId, chunk);
+        }
+        appendPoint(&it->series, timestampMs, value, isNull);
+        if (it->series.size() >= chunkSize) {
+            it->position = device->pos();
+            if (!sink(*it)) {
+                return QString();
+            }
+            const QString key = it->series.key();
+            it->series = MeasurementSeries();
+            it->series.setKey(key);
+            it->series.reserve(chunkSize);
+        }
+    }
+    for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+        if (!it->series.isEmpty()) {
+            it->position = device->pos();
+            if (!sink(*it)) {
+                return QString();
+            }
+        }
+    }
+    return QString();
+}
+
+/**
+ * @brief Czyta plik XML w formacie eksportu (Key, SensorInfo, Values/Measurement) element po elemencie.
+ * Punkty przed elementem SensorInfo trafiają do czujnika domyślnego; SensorInfo wskazujący inny czujnik
+ * po zapisaniu pierwszej paczki jest błędem.
+ * @param device Otwarte urządzenie z danymi.
+ * @param chunkSize Liczba punktów w paczce.
+ * @param defaultSensorId Czujnik dla pliku bez SensorInfo przed pomiarami.
+ * @param defaultSensorInfo Dane czujnika domyślnego.
+ * @param sink Odbiorca paczek; false przerywa odczyt.
+ * @param skippedLines Liczba pominiętych pomiarów.
+ * @return Opis błędu lub pusty napis.
+ */
+QString StreamingImporter::readXml(QIODevice* device, int chunkSize, int defaultSensorId, const QJsonObject& defaultSensorInfo,
+                                   const ChunkSink& sink, int* skippedLines)
+{
+    *skippedLines = 0;
+    QXmlStreamReader reader(device);
+    Chunk chunk;
+    chunk.sensorId = defaultSensorId;
+    chunk.sensorInfo = defaultSensorInfo;
+    chunk.series.setKey(sensorParamCode(defaultSensorInfo));
+    chunk.series.reserve(chunkSize);
+    bool sent = false;
+    QString error;
+    /// Przekazuje zebraną paczkę; false przy błędzie lub przerwaniu.
+    auto flush = [&]() -> bool {
+        if (chunk.series.isEmpty()) {
+            return true;
+        }
+        if (chunk.sensorId <= 0) {
+            error = "Brak ID czujnika: element SensorInfo musi poprzedzać Values (lub wybierz czujnik)";
+            return false;
+        }
+        chunk.position = device->pos();
+        if (!sink(chunk)) {
+            return false;
+        }
+        sent = true;
+        const QString key = chunk.series.key();
+        chunk.series = MeasurementSeries();
+        chunk.series.setKey(key);
+        chunk.series.reserve(chunkSize);
+        return true;
+    };
+    while (!reader.atEnd()) {
+        if (!reader.readNextStartElement()) {
+            continue;
+        }
+        if (reader.name() == "Key") {
+            chunk.series.setKey(reader.readElementText());
+        } else if (reader.name() == "SensorInfo") {
+            QJsonObject sensorInfo;
+            while (reader.readNextStartElement()) {
+                sensorInfo[reader.name().toString()] = reader.readElementText();
+            }
+            const int sensorId = sensorInfo["id"].toString().toInt();
+            if (sent && sensorId != chunk.sensorId) {
+                return "Element SensorInfo wskazuje inny czujnik niż zapisane już pomiary";
+            }
+            if (sensorId > 0) {
+                chunk.sensorId = sensorId;
+                chunk.sensorInfo = sensorInfo;
+            }
+        } else if (reader.name() == "Values") {
+            while (reader.readNextStartElement()) {
+                if (reader.name() != "Measurement") {
+                    reader.skipCurrentElement();
+                    continue;
+                }
+                QString date;
+                QString valueText;
+                while (reader.readNextStartElement()) {
+                    if (reader.name() == "Date") {
+                        date = reader.readElementText();
+                    } else if (reader.name() == "Value") {
+                        valueText = reader.readElementText();
+                    } else {
+                        reader.skipCurrentElement();
+                    }
+                }
+                qint64 timestampMs = 0;
+                float value = 0.0f;
+                bool isNull = false;
+                if (!MeasurementSeries::parseDate(date, &timestampMs)
+                    || !parseValue(valueText.toUtf8(), &value, &isNull)) {
+                    ++*skippedLines;
+                    continue;
+                }
+                appendPoint(&chunk.series, timestampMs, value, isNull);
+                if (chunk.series.size() >= chunkSize && !flush()) {
+                    return error;
+                }
+            }
+        } else {
+            reader.skipCurrentElement();
+        }
+    }
+    /// Pomiary sprzed błędu składni są zapisywane, jak przy wcześniejszym imporcie XML.
+    if (!flush()) {
+        return error;
+    }
+    if (reader.hasError()) {
+        return "Błąd parsowania XML: " + reader.errorString();
+    }
+    return QString();
+}
+
+/**
+ * @brief Zapisuje paczkę jako rekord historii i zwalnia miejsce w kolejce.
+ * @param chunk Paczka punktów.
+ */
+void StreamingImporter::writeChunk(const Chunk& chunk)
+{
+    if (!stopRequested.loadAcquire()) {
+        QJsonObject metadata;
+        metadata["sensorInfo"] = chunk.sensorInfo;
+        metadata["saveDate"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        metadata["delta"] = true;
+        if (store->putSeries(chunk.sensorId, chunkDateKey(chunk), chunk.series, metadata)) {
+            pointCount += chunk.series.size();
+            ++recordCount;
+            emit progress(chunk.position, fileSize);
+        } else {
+            writeError = store->errorString();
+            stopRequested.storeRelease(1);
+        }
+    }
+    pendingSlots.release();
+}
+
+/**
+ * @brief Kończy import po zakończeniu odczytu i zgłasza wynik.
+ * Paczki wysłane przez wątek roboczy są już zapisane (zdarzenia trafiły do kolejki przed zakończeniem).
+ */
+void StreamingImporter::finish()
+{
+    QString error = watcher->result();
+    if (!writeError.isEmpty()) {
+        error = "Błąd zapisu: " + writeError;
+    } else if (error.isEmpty() && stopRequested.loadAcquire()) {
+        error = "Import anulowany";
+    } else if (error.isEmpty() && recordCount == 0) {
+        error = "Brak poprawnych pomiarów w pliku";
+    }
+    qDebug() << "Import strumieniowy: zapisano" << pointCount << "punktów w" << recordCount << "rekordach, pominięto"
+             << skippedCount << (error.isEmpty() ? QString() : error);
+    emit progress(fileSize, fileSize);
+    emit finished(pointCount, recordCount, skippedCount, error);
+}
+
+/**
+ * @brief Zwraca klucz daty rekordu paczki: czas najnowszego punktu, przesunięty o sekundę, jeśli jest zajęty.
+ * @param chunk Paczka punktów.
+ * @return Klucz daty niewystępujący jeszcze dla czujnika.
+ */
+QString StreamingImporter::chunkDateKey(const Chunk& chunk) const
+{
+    qint64 newest = chunk.series.timestamp(0);
+    for (qint64 timestamp : chunk.series.timestamps()) {
+        newest = qMax(newest, timestamp);
+    }
+    QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(newest);
+    QString dateKey = dateTime.toString(DATE_KEY_FORMAT);
+    while (store->contains(chunk.sensorId, dateKey)) {
+        dateTime = dateTime.addSecs(1);
+        dateKey = dateTime.toString(DATE_KEY_FORMAT);
+    }
+    return dateKey;
+}
@@ -0,0 +1,111 @@
+#ifndef STREAMINGIMPORTER_H
+#define STREAMINGIMPORTER_H
+
+/**
+ * @file streamingimporter.h
+ * @brief Plik nagłówkowy dla klasy StreamingImporter, strumieniowego importu dużych plików XML i CSV.
+ */
+
+#include <QObject>
+#include <QAtomicInt>          ///< Do flagi anulowania widocznej w wątku roboczym.
+#include <QFutureWatcher>      ///< Do odbioru zakończenia parsowania w wątku głównym.
+#include <QIODevice>           ///< Do czytanego pliku.
+#include <QJsonObject>         ///< Do danych czujnika.
+#include <QSemaphore>          ///< Do ograniczenia liczby paczek czekających na zapis.
+#include <functional>          ///< Do odbiorcy paczek punktów.
+#include "historystore.h"      ///< Do zapisu paczek w magazynie historii.
+#include "measurementseries.h" ///< Do paczek punktów.
+
+/**
+ * @class StreamingImporter
+ * @brief Importuje pliki XML (format eksportu) i CSV bez wczytywania całego pliku do pamięci.
+ *
+ * Plik jest czytany w wątku roboczym element po elemencie (QXmlStreamReader) lub wiersz po wierszu,
+ * a punkty (data, wartość) trafiają wprost do szeregu paczki; po zebraniu CHUNK_POINTS punktów paczka
+ * jest zapisywana w magazynie jako osobny rekord (HistoryStore::putSeries) w wątku głównym. Semafor
+ * ogranicza liczbę paczek czekających na zapis, więc zużycie pamięci nie zależy od rozmiaru pliku.
+ *
+ * CSV: separator ';', ',' lub tabulator (wykrywany z pierwszego wiersza), opcjonalny nagłówek
+ * z kolumnami daty, wartości, ID czujnika i kodu parametru. Bez nagłówka dwie kolumny to data i wartość,
+ * a trzy: ID czujnika, data i wartość. Pola mogą być ujęte w cudzysłów (separator w cudzysłowie nie dzieli
+ * pola, "" to znak cudzysłowu), a wartości mogą mieć przecinek dziesiętny (przy separatorze ',' w cudzysłowie,
+ * np. "12,5"); pusta wartość, "null", "NaN" lub "-" oznacza brak pomiaru. Wiersze z nieprawidłową datą lub
+ * wartością są pomijane i liczone.
+ *
+ * Kluczem daty rekordu jest czas najnowszego punktu paczki (przesunięty o sekundę, jeśli jest zajęty),
+ * a rekordy czujnika są składane według znacznika czasu jak przy autozapisie.
+ */
+class StreamingImporter : public QObject
+{
+    Q_OBJECT ///< Umożliwia korzystanie z sygnałów i slotów Qt.
+
+public:
+    /// Paczka punktów jednego czujnika.
+    struct Chunk {
+        int sensorId = 0;          ///< ID czujnika.
+        QJsonObject sensorInfo;    ///< Dane czujnika zapisywane w rekordzie.
+        MeasurementSeries series;  ///< Punkty paczki.
+        qint64 position = 0;       ///< Pozycja w pliku po odczycie paczki (bajty).
+    };
+    /// Odbiorca paczek; false przerywa odczyt.
+    using ChunkSink = std::function<bool(const Chunk&)>;
+
+    /// Konstruktor, przyjmuje magazyn historii.
+    explicit StreamingImporter(HistoryStore* store, QObject *parent = nullptr);
+    /// Destruktor, anuluje i czeka na zakończenie odczytu.
+    ~StreamingImporter();
+
+    /// Uruchamia import pliku .xml lub .csv; domyślny czujnik dotyczy plików bez ID czujnika.
+    bool start(const QString& path, int defaultSensorId, const QJsonObject& defaultSensorInfo);
+    /// Anuluje import w toku (paczki zapisane wcześniej zostają w magazynie).
+    void cancel();
+    /// Informuje, czy import jest w toku.
+    bool isRunning() const;
+
+    /// Czyta plik CSV i przekazuje paczki po chunkSize punktów; zwraca opis błędu (pusty przy sukcesie).
+    static QString readCsv(QIODevice* device, int chunkSize, int defaultSensorId, const QJsonObject& defaultSensorInfo,
+                           const ChunkSink& sink, int* skippedLines);
+    /// Czyta plik XML w formacie eksportu i przekazuje paczki po chunkSize punktów; zwraca opis błędu.
+    static QString readXml(QIODevice* device, int chunkSize, int defaultSensorId, const QJsonObject& defaultSensorInfo,
+                           const ChunkSink& sink, int* skippedLines);
+
+signals:
+    /// Informuje o postępie (bajty przeczytane i rozmiar pliku).
+    void progress(qint64 bytesRead, qint64 totalBytes);
+    /// Informuje o zakończeniu importu (zapisane punkty i rekordy, pominięte wiersze, opis błędu).
+    void finished(int points, int records, int skippedLines, const QString& error);
+
+private:
+    /// Zapisuje paczkę w magazynie (wątek główny) i zwalnia miejsce w kolejce.
+    void writeChunk(const Chunk& chunk);
+    /// Kończy import i zgłasza wynik.
+    void finish();
+    /// Zwraca wolny klucz daty dla czasu najnowszego punktu paczki.
+    QString chunkDateKey(const Chunk& chunk) const;
+
+    /// Liczba punktów w paczce.
+    static constexpr int CHUNK_POINTS = 4096;
+    /// Maksymalna liczba paczek czekających na zapis.
+    static constexpr int MAX_PENDING_CHUNKS = 4;
+
+    /// Magazyn historii.
+    HistoryStore* store;
+    /// Obserwator odczytu w wątku roboczym (wynik: opis błędu).
+    QFutureWatcher<QString>* watcher;
+    /// Wolne miejsca w kolejce paczek do zapisu.
+    QSemaphore pendingSlots;
+    /// Czy odczyt ma zostać przerwany (anulowanie lub błąd zapisu).
+    QAtomicInt stopRequested;
+    /// Rozmiar importowanego pliku (bajty).
+    qint64 fileSize;
+    /// Liczba pominiętych wierszy (ustawiana przez wątek roboczy przed zakończeniem).
+    int skippedCount;
+    /// Liczba zapisanych punktów.
+    int pointCount;
+    /// Liczba zapisanych rekordów.
+    int recordCount;
+    /// Opis błędu zapisu.
+    QString writeError;
+};
+
+#endif // STREAMINGIMPORTER_H